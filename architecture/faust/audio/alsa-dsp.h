@@ -45,6 +45,7 @@
 
 #include <alsa/asoundlib.h>
 #include "faust/audio/audio.h"
+#include "faust/audio/sample-format.h"
 #include "faust/dsp/dsp.h"
 
 /**
@@ -339,6 +340,21 @@ struct AudioInterface : public AudioParam
 	void close()
 	{}
 
+	/**
+	 * Sample format of the audio card buffers, used by the conversion functions
+	 */
+	sample_format cardSampleFormat()
+	{
+		if (fSampleFormat == SND_PCM_FORMAT_S16) {
+			return kSampleS16;
+		} else if (fSampleFormat == SND_PCM_FORMAT_S32) {
+			return kSampleS32;
+		} else {
+			printf("unrecognized sample format : %u\n", fSampleFormat);
+			exit(1);
+		}
+	}
+
 	/**
 	 * Read audio samples from the audio card. Convert samples to floats and take
 	 * care of interleaved buffers
@@ -354,28 +370,7 @@ struct AudioInterface : public AudioParam
 				 //check_error_msg(err, "preparing input stream");
 			}
 
-			if (fSampleFormat == SND_PCM_FORMAT_S16) {
-
-				short* buffer16b = (short*)fInputCardBuffer;
-				for (unsigned int s = 0; s < fBuffering; s++) {
-					for (unsigned int c = 0; c < fCardInputs; c++) {
-						fInputSoftChannels[c][s] = float(buffer16b[c + s*fCardInputs])*(1.0/float(SHRT_MAX));
-					}
-				}
-
-			} else if (fSampleFormat == SND_PCM_FORMAT_S32) {
-
-				int32* buffer32b = (int32*)fInputCardBuffer;
-				for (unsigned int s = 0; s < fBuffering; s++) {
-					for (unsigned int c = 0; c < fCardInputs; c++) {
-						fInputSoftChannels[c][s] = float(buffer32b[c + s*fCardInputs])*(1.0/float(INT_MAX));
-					}
-				}
-			} else {
-
-				printf("unrecognized input sample format : %u\n", fSampleFormat);
-				exit(1);
-			}
+			readSamples(cardSampleFormat(), fInputCardBuffer, fCardInputs, fBuffering, fInputSoftChannels);
 
 		} else if (fSampleAccess == SND_PCM_ACCESS_RW_NONINTERLEAVED) {
 
@@ -386,26 +381,8 @@ struct AudioInterface : public AudioParam
 				 //check_error_msg(err, "preparing input stream");
 			}
 
-			if (fSampleFormat == SND_PCM_FORMAT_S16) {
-
-				for (unsigned int c = 0; c < fCardInputs; c++) {
-					short* chan16b = (short*)fInputCardChannels[c];
-					for (unsigned int s = 0; s < fBuffering; s++) {
-						fInputSoftChannels[c][s] = float(chan16b[s])*(1.0/float(SHRT_MAX));
-					}
-				}
-
-			} else if (fSampleFormat == SND_PCM_FORMAT_S32) {
-
-				for (unsigned int c = 0; c < fCardInputs; c++) {
-					int32* chan32b = (int32*)fInputCardChannels[c];
-					for (unsigned int s = 0; s < fBuffering; s++) {
-						fInputSoftChannels[c][s] = float(chan32b[s])*(1.0/float(INT_MAX));
-					}
-				}
-			} else {
-				printf("unrecognized input sample format : %u\n", fSampleFormat);
-				exit(1);
+			for (unsigned int c = 0; c < fCardInputs; c++) {
+				readSamples(cardSampleFormat(), fInputCardChannels[c], fBuffering, fInputSoftChannels[c]);
 			}
 
 		} else {
@@ -423,30 +400,7 @@ struct AudioInterface : public AudioParam
 
 		if (fSampleAccess == SND_PCM_ACCESS_RW_INTERLEAVED) {
 
-			if (fSampleFormat == SND_PCM_FORMAT_S16) {
-
-				short* buffer16b = (short*)fOutputCardBuffer;
-				for (unsigned int f = 0; f < fBuffering; f++) {
-					for (unsigned int c = 0; c < fCardOutputs; c++) {
-						float x = fOutputSoftChannels[c][f];
-						buffer16b[c + f*fCardOutputs] = short( max(min(x,1.0f),-1.0f) * float(SHRT_MAX) ) ;
-					}
-				}
-
-			} else if (fSampleFormat == SND_PCM_FORMAT_S32)  {
-
-				int32* buffer32b = (int32*)fOutputCardBuffer;
-				for (unsigned int f = 0; f < fBuffering; f++) {
-					for (unsigned int c = 0; c < fCardOutputs; c++) {
-						float x = fOutputSoftChannels[c][f];
-						buffer32b[c + f*fCardOutputs] = int( max(min(x,1.0f),-1.0f) * float(INT_MAX) ) ;
-					}
-				}
-			} else {
-
-				printf("unrecognized output sample format : %u\n", fSampleFormat);
-				exit(1);
-			}
+			writeSamples(cardSampleFormat(), fOutputSoftChannels, fCardOutputs, fBuffering, fOutputCardBuffer);
 
 			int count = snd_pcm_writei(fOutputDevice, fOutputCardBuffer, fBuffering);
 			if (count<0) {
@@ -459,30 +413,8 @@ struct AudioInterface : public AudioParam
 
 		} else if (fSampleAccess == SND_PCM_ACCESS_RW_NONINTERLEAVED) {
 
-			if (fSampleFormat == SND_PCM_FORMAT_S16) {
-
-				for (unsigned int c = 0; c < fCardOutputs; c++) {
-					short* chan16b = (short*) fOutputCardChannels[c];
-					for (unsigned int f = 0; f < fBuffering; f++) {
-						float x = fOutputSoftChannels[c][f];
-						chan16b[f] = short( max(min(x,1.0f),-1.0f) * float(SHRT_MAX) ) ;
-					}
-				}
-
-			} else if (fSampleFormat == SND_PCM_FORMAT_S32) {
-
-				for (unsigned int c = 0; c < fCardOutputs; c++) {
-					int32* chan32b = (int32*) fOutputCardChannels[c];
-					for (unsigned int f = 0; f < fBuffering; f++) {
-						float x = fOutputSoftChannels[c][f];
-						chan32b[f] = int( max(min(x,1.0f),-1.0f) * float(INT_MAX) ) ;
-					}
-				}
-
-			} else {
-
-				printf("unrecognized output sample format : %u\n", fSampleFormat);
-				exit(1);
+			for (unsigned int c = 0; c < fCardOutputs; c++) {
+				writeSamples(cardSampleFormat(), fOutputSoftChannels[c], fBuffering, fOutputCardChannels[c]);
 			}
 
 			int count = snd_pcm_writen(fOutputDevice, fOutputCardChannels, fBuffering);
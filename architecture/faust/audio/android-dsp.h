@@ -33,9 +33,7 @@
 #include <time.h>
 
 #include "faust/audio/audio.h"
-
-#define CONV16BIT 32767.f
-#define CONVMYFLT (1.f/32767.f)
+#include "faust/audio/sample-format.h"
 
 #define NUM_INPUTS 2
 #define NUM_OUTPUTS 2
@@ -122,12 +120,7 @@ class androidaudio : public audio {
        
             // Converting short input to float
             if (fNumInChans > 0) {
-                short* input = fOpenSLInputs.getReadPtr();
-                for (int chan = 0; chan < NUM_INPUTS; chan++) {
-                    for (int i  = 0; i < fBufferSize; i++) {
-                        fInputs[chan][i] = float(input[i * NUM_INPUTS + chan] * CONVMYFLT);
-                    }
-                }
+                readSamples(kSampleS16, fOpenSLInputs.getReadPtr(), NUM_INPUTS, fBufferSize, fInputs);
                 fOpenSLInputs.moveReadPtr(fBufferSize);
             }
             
@@ -136,12 +129,7 @@ class androidaudio : public audio {
             
             // Converting float to short output
             if (fNumOutChans > 0) {
-                short* output = fOpenSLOutputs.getWritePtr();
-                for (int chan = 0; chan < NUM_OUTPUTS; chan++) {
-                    for (int i = 0; i < fBufferSize; i++) {
-                        output[i * NUM_OUTPUTS + chan] = short(min(1.f, max(-1.f, fOutputs[chan][i])) * CONV16BIT);
-                    }
-                }
+                writeSamples(kSampleS16, fOutputs, NUM_OUTPUTS, fBufferSize, fOpenSLOutputs.getWritePtr());
                 fOpenSLOutputs.moveWritePtr(fBufferSize);
             }
             
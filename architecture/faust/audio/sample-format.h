@@ -0,0 +1,484 @@
+/************************************************************************
+ FAUST Architecture File
+ Copyright (C) 2016 GRAME, Centre National de Creation Musicale
+ ---------------------------------------------------------------------
+ This Architecture section is free software; you can redistribute it
+ and/or modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 3 of
+ the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; If not, see <http://www.gnu.org/licenses/>.
+
+ EXCEPTION : As a special exception, you may create a larger work
+ that contains this FAUST architecture section and distribute
+ that work under terms of your choice, so long as this FAUST
+ architecture section is not modified.
+
+ ************************************************************************
+ ************************************************************************/
+
+#ifndef __sample_format__
+#define __sample_format__
+
+#include <string.h>
+
+#if !defined(SAMPLE_FORMAT_SCALAR) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define SAMPLE_FORMAT_SSE2
+#include <emmintrin.h>
+#endif
+
+/*
+    Sample format conversion and (de)interleaving shared by the audio drivers.
+
+    Audio cards and sound files deliver interleaved or planar integer samples
+    (S16, S24, S32) or floats, while the DSP computes on separated float channels.
+    All conversions are done here by small blocks of 4 frames x 4 channels
+    (4x4 transpose in registers) so that the cost stays negligible compared to
+    the DSP even with a large number of channels.
+
+    - integer to float : v * (1/max)
+    - float to integer : clipped to [-1..1], scaled by max and truncated,
+      with an optional TPDF dither of +/- 1 LSB (see 'sample_dither')
+
+    SSE2 is used when available, other targets (or SAMPLE_FORMAT_SCALAR defined)
+    use the scalar version, which gives exactly the same samples.
+*/
+
+enum sample_format {
+    kSampleFloat32,     // 32 bits float
+    kSampleS16,         // 16 bits signed integer
+    kSampleS24,         // 24 bits signed integer in the low bits of a 32 bits word (ALSA S24_LE)
+    kSampleS24Packed,   // 24 bits signed integer packed in 3 bytes, little endian
+    kSampleS32          // 32 bits signed integer
+};
+
+/**
+ * Returns the size in bytes of one sample in the given format.
+ */
+inline int sampleFormatSize(sample_format format)
+{
+    switch (format) {
+        case kSampleS16:        return 2;
+        case kSampleS24Packed:  return 3;
+        default:                return 4;
+    }
+}
+
+/**
+ * Triangular (TPDF) dither noise, in LSB units in [-1..1].
+ */
+class sample_dither {
+
+    private:
+
+        unsigned int fSeed;
+
+        inline float uniform()
+        {
+            fSeed = fSeed * 1664525 + 1013904223;
+            return float(fSeed >> 8) * (1.f/16777216.f);
+        }
+
+    public:
+
+        sample_dither(unsigned int seed = 12345):fSeed(seed) {}
+
+        inline float next() { return uniform() - uniform(); }
+};
+
+/*
+    Sample format descriptions : conversion of one sample, and of 4
+    consecutive samples with SSE2 (except for packed 24 bits samples).
+*/
+
+struct sample_f32 {
+
+    typedef float type;
+    static inline float lsb() { return 0.f; }
+    static inline float toFloat(type v) { return v; }
+    static inline type fromFloat(float x) { return x; }
+
+#ifdef SAMPLE_FORMAT_SSE2
+    static inline __m128 load4(const type* p) { return _mm_loadu_ps(p); }
+    static inline void store4(type* p, __m128 x) { _mm_storeu_ps(p, x); }
+#endif
+};
+
+struct sample_s16 {
+
+    typedef short type;
+    static inline float lsb() { return 1.f/32767.f; }
+    static inline float toFloat(type v) { return float(v) * (1.f/32767.f); }
+    static inline type fromFloat(float x)
+    {
+        x = (x > 1.f) ? 1.f : ((x < -1.f) ? -1.f : x);
+        return type(x * 32767.f);
+    }
+
+#ifdef SAMPLE_FORMAT_SSE2
+    static inline __m128 load4(const type* p)
+    {
+        __m128i v = _mm_loadl_epi64((const __m128i*)p);
+        return _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16)), _mm_set1_ps(1.f/32767.f));
+    }
+    static inline void store4(type* p, __m128 x)
+    {
+        x = _mm_max_ps(_mm_min_ps(x, _mm_set1_ps(1.f)), _mm_set1_ps(-1.f));
+        __m128i v = _mm_cvttps_epi32(_mm_mul_ps(x, _mm_set1_ps(32767.f)));
+        _mm_storel_epi64((__m128i*)p, _mm_packs_epi32(v, v));
+    }
+#endif
+};
+
+struct sample_s24 {
+
+    typedef int type;
+    static inline float lsb() { return 1.f/8388607.f; }
+    static inline float toFloat(type v) { return float((v << 8) >> 8) * (1.f/8388607.f); }
+    static inline type fromFloat(float x)
+    {
+        x = (x > 1.f) ? 1.f : ((x < -1.f) ? -1.f : x);
+        return type(x * 8388607.f);
+    }
+
+#ifdef SAMPLE_FORMAT_SSE2
+    static inline __m128 load4(const type* p)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i*)p);
+        return _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_slli_epi32(v, 8), 8)), _mm_set1_ps(1.f/8388607.f));
+    }
+    static inline void store4(type* p, __m128 x)
+    {
+        x = _mm_max_ps(_mm_min_ps(x, _mm_set1_ps(1.f)), _mm_set1_ps(-1.f));
+        _mm_storeu_si128((__m128i*)p, _mm_cvttps_epi32(_mm_mul_ps(x, _mm_set1_ps(8388607.f))));
+    }
+#endif
+};
+
+struct sample_s24_packed {
+
+    struct type { unsigned char b[3]; };
+    static inline float lsb() { return 1.f/8388607.f; }
+    static inline float toFloat(type v)
+    {
+        int i = (v.b[0] << 8) | (v.b[1] << 16) | (v.b[2] << 24);
+        return float(i >> 8) * (1.f/8388607.f);
+    }
+    static inline type fromFloat(float x)
+    {
+        x = (x > 1.f) ? 1.f : ((x < -1.f) ? -1.f : x);
+        int i = int(x * 8388607.f);
+        type v = { { (unsigned char)i, (unsigned char)(i >> 8), (unsigned char)(i >> 16) } };
+        return v;
+    }
+};
+
+struct sample_s32 {
+
+    typedef int type;
+    static inline float lsb() { return 1.f/2147483647.f; }
+    static inline float toFloat(type v) { return float(v) * (1.f/2147483647.f); }
+    static inline type fromFloat(float x)
+    {
+        // 2147483647.f rounds to 2^31, so the upper bound is the biggest float under 2^31
+        x = (x > 1.f) ? 1.f : ((x < -1.f) ? -1.f : x);
+        x = x * 2147483647.f;
+        return type((x > 2147483520.f) ? 2147483520.f : x);
+    }
+
+#ifdef SAMPLE_FORMAT_SSE2
+    static inline __m128 load4(const type* p)
+    {
+        return _mm_mul_ps(_mm_cvtepi32_ps(_mm_loadu_si128((const __m128i*)p)), _mm_set1_ps(1.f/2147483647.f));
+    }
+    static inline void store4(type* p, __m128 x)
+    {
+        x = _mm_max_ps(_mm_min_ps(x, _mm_set1_ps(1.f)), _mm_set1_ps(-1.f));
+        x = _mm_min_ps(_mm_mul_ps(x, _mm_set1_ps(2147483647.f)), _mm_set1_ps(2147483520.f));
+        _mm_storeu_si128((__m128i*)p, _mm_cvttps_epi32(x));
+    }
+#endif
+};
+
+/*
+    Conversion kernels for a given sample format. 'channels' is the number
+    of interleaved channels in the card/file buffer (1 for planar buffers).
+*/
+
+template <class FORMAT>
+struct sample_converter_scalar {
+
+    typedef typename FORMAT::type type;
+
+    // channels [first..channels[ are converted
+    static void read(const type* src, int channels, int frames, float** dst, int first = 0)
+    {
+        for (int c = first; c < channels; c++) {
+            float* d = dst[c];
+            const type* s = src + c;
+            for (int f = 0; f < frames; f++) {
+                d[f] = FORMAT::toFloat(s[f * channels]);
+            }
+        }
+    }
+
+    static void write(float** src, int channels, int frames, type* dst, sample_dither* dither, int first = 0)
+    {
+        if (dither && FORMAT::lsb() != 0.f) {
+            float lsb = FORMAT::lsb();
+            for (int f = 0; f < frames; f++) {
+                for (int c = 0; c < channels; c++) {
+                    dst[f * channels + c] = FORMAT::fromFloat(src[c][f] + dither->next() * lsb);
+                }
+            }
+            return;
+        }
+        for (int c = first; c < channels; c++) {
+            float* s = src[c];
+            type* d = dst + c;
+            for (int f = 0; f < frames; f++) {
+                d[f * channels] = FORMAT::fromFloat(s[f]);
+            }
+        }
+    }
+};
+
+#ifndef SAMPLE_FORMAT_SSE2
+
+template <class FORMAT>
+struct sample_converter : public sample_converter_scalar<FORMAT> {};
+
+#else
+
+template <class FORMAT>
+struct sample_converter {
+
+    typedef typename FORMAT::type type;
+
+    // interleaved (or planar when channels == 1) samples to separated float channels
+    static void read(const type* src, int channels, int frames, float** dst)
+    {
+        if (channels == 1) {
+            float* d = dst[0];
+            int f = 0;
+            for (; f + 4 <= frames; f += 4) {
+                _mm_storeu_ps(d + f, FORMAT::load4(src + f));
+            }
+            for (; f < frames; f++) {
+                d[f] = FORMAT::toFloat(src[f]);
+            }
+        } else if (channels == 2) {
+            float* d0 = dst[0]; float* d1 = dst[1];
+            int f = 0;
+            for (; f + 4 <= frames; f += 4) {
+                __m128 a = FORMAT::load4(src + 2 * f);
+                __m128 b = FORMAT::load4(src + 2 * f + 4);
+                _mm_storeu_ps(d0 + f, _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+                _mm_storeu_ps(d1 + f, _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+            }
+            for (; f < frames; f++) {
+                d0[f] = FORMAT::toFloat(src[2 * f]);
+                d1[f] = FORMAT::toFloat(src[2 * f + 1]);
+            }
+        } else {
+            int c = 0;
+            for (; c + 4 <= channels; c += 4) {
+                float* d0 = dst[c]; float* d1 = dst[c+1]; float* d2 = dst[c+2]; float* d3 = dst[c+3];
+                int f = 0;
+                for (; f + 4 <= frames; f += 4) {
+                    const type* s = src + f * channels + c;
+                    __m128 r0 = FORMAT::load4(s);
+                    __m128 r1 = FORMAT::load4(s + channels);
+                    __m128 r2 = FORMAT::load4(s + 2 * channels);
+                    __m128 r3 = FORMAT::load4(s + 3 * channels);
+                    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+                    _mm_storeu_ps(d0 + f, r0);
+                    _mm_storeu_ps(d1 + f, r1);
+                    _mm_storeu_ps(d2 + f, r2);
+                    _mm_storeu_ps(d3 + f, r3);
+                }
+                for (; f < frames; f++) {
+                    const type* s = src + f * channels + c;
+                    d0[f] = FORMAT::toFloat(s[0]);
+                    d1[f] = FORMAT::toFloat(s[1]);
+                    d2[f] = FORMAT::toFloat(s[2]);
+                    d3[f] = FORMAT::toFloat(s[3]);
+                }
+            }
+            // remaining channels
+            sample_converter_scalar<FORMAT>::read(src, channels, frames, dst, c);
+        }
+    }
+
+    // separated float channels to interleaved (or planar when channels == 1) samples
+    static void write(float** src, int channels, int frames, type* dst, sample_dither* dither)
+    {
+        if (dither && FORMAT::lsb() != 0.f) {
+            sample_converter_scalar<FORMAT>::write(src, channels, frames, dst, dither);
+        } else if (channels == 1) {
+            float* s = src[0];
+            int f = 0;
+            for (; f + 4 <= frames; f += 4) {
+                FORMAT::store4(dst + f, _mm_loadu_ps(s + f));
+            }
+            for (; f < frames; f++) {
+                dst[f] = FORMAT::fromFloat(s[f]);
+            }
+        } else if (channels == 2) {
+            float* s0 = src[0]; float* s1 = src[1];
+            int f = 0;
+            for (; f + 4 <= frames; f += 4) {
+                __m128 r0 = _mm_loadu_ps(s0 + f);
+                __m128 r1 = _mm_loadu_ps(s1 + f);
+                FORMAT::store4(dst + 2 * f, _mm_unpacklo_ps(r0, r1));
+                FORMAT::store4(dst + 2 * f + 4, _mm_unpackhi_ps(r0, r1));
+            }
+            for (; f < frames; f++) {
+                dst[2 * f] = FORMAT::fromFloat(s0[f]);
+                dst[2 * f + 1] = FORMAT::fromFloat(s1[f]);
+            }
+        } else {
+            int c = 0;
+            for (; c + 4 <= channels; c += 4) {
+                float* s0 = src[c]; float* s1 = src[c+1]; float* s2 = src[c+2]; float* s3 = src[c+3];
+                int f = 0;
+                for (; f + 4 <= frames; f += 4) {
+                    __m128 r0 = _mm_loadu_ps(s0 + f);
+                    __m128 r1 = _mm_loadu_ps(s1 + f);
+                    __m128 r2 = _mm_loadu_ps(s2 + f);
+                    __m128 r3 = _mm_loadu_ps(s3 + f);
+                    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+                    type* d = dst + f * channels + c;
+                    FORMAT::store4(d, r0);
+                    FORMAT::store4(d + channels, r1);
+                    FORMAT::store4(d + 2 * channels, r2);
+                    FORMAT::store4(d + 3 * channels, r3);
+                }
+                for (; f < frames; f++) {
+                    type* d = dst + f * channels + c;
+                    d[0] = FORMAT::fromFloat(s0[f]);
+                    d[1] = FORMAT::fromFloat(s1[f]);
+                    d[2] = FORMAT::fromFloat(s2[f]);
+                    d[3] = FORMAT::fromFloat(s3[f]);
+                }
+            }
+            // remaining channels
+            sample_converter_scalar<FORMAT>::write(src, channels, frames, dst, 0, c);
+        }
+    }
+};
+
+// 3 bytes samples cannot be loaded in registers efficiently
+template <>
+struct sample_converter<sample_s24_packed> : public sample_converter_scalar<sample_s24_packed> {};
+
+#endif
+
+/**
+ * Converts 'frames' frames of interleaved samples (with 'channels' channels) to
+ * separated float channels. With 'channels' = 1, converts a planar buffer.
+ */
+inline void readSamples(sample_format format, const void* src, int channels, int frames, float** dst)
+{
+    switch (format) {
+        case kSampleFloat32:
+            sample_converter<sample_f32>::read((const float*)src, channels, frames, dst);
+            break;
+        case kSampleS16:
+            sample_converter<sample_s16>::read((const short*)src, channels, frames, dst);
+            break;
+        case kSampleS24:
+            sample_converter<sample_s24>::read((const int*)src, channels, frames, dst);
+            break;
+        case kSampleS24Packed:
+            sample_converter<sample_s24_packed>::read((const sample_s24_packed::type*)src, channels, frames, dst);
+            break;
+        case kSampleS32:
+            sample_converter<sample_s32>::read((const int*)src, channels, frames, dst);
+            break;
+    }
+}
+
+/**
+ * Converts 'frames' frames of separated float channels to interleaved samples
+ * (with 'channels' channels), with an optional dither for integer formats.
+ * With 'channels' = 1, converts to a planar buffer.
+ */
+inline void writeSamples(sample_format format, float** src, int channels, int frames, void* dst, sample_dither* dither = 0)
+{
+    switch (format) {
+        case kSampleFloat32:
+            sample_converter<sample_f32>::write(src, channels, frames, (float*)dst, dither);
+            break;
+        case kSampleS16:
+            sample_converter<sample_s16>::write(src, channels, frames, (short*)dst, dither);
+            break;
+        case kSampleS24:
+            sample_converter<sample_s24>::write(src, channels, frames, (int*)dst, dither);
+            break;
+        case kSampleS24Packed:
+            sample_converter<sample_s24_packed>::write(src, channels, frames, (sample_s24_packed::type*)dst, dither);
+            break;
+        case kSampleS32:
+            sample_converter<sample_s32>::write(src, channels, frames, (int*)dst, dither);
+            break;
+    }
+}
+
+/**
+ * Converts one planar channel of samples to floats.
+ */
+inline void readSamples(sample_format format, const void* src, int frames, float* dst)
+{
+    readSamples(format, src, 1, frames, &dst);
+}
+
+/**
+ * Converts one float channel to a planar channel of samples.
+ */
+inline void writeSamples(sample_format format, float* src, int frames, void* dst, sample_dither* dither = 0)
+{
+    writeSamples(format, &src, 1, frames, dst, dither);
+}
+
+/**
+ * Float (or double) interleaving and deinterleaving, used when FAUSTFLOAT is
+ * not float or when no conversion is needed (sound files).
+ */
+template <typename REAL>
+inline void deinterleaveSamples(const REAL* src, int channels, int frames, REAL** dst)
+{
+    for (int c = 0; c < channels; c++) {
+        for (int f = 0; f < frames; f++) {
+            dst[c][f] = src[c + f * channels];
+        }
+    }
+}
+
+inline void deinterleaveSamples(const float* src, int channels, int frames, float** dst)
+{
+    sample_converter<sample_f32>::read(src, channels, frames, dst);
+}
+
+template <typename REAL>
+inline void interleaveSamples(REAL** src, int channels, int frames, REAL* dst)
+{
+    for (int c = 0; c < channels; c++) {
+        for (int f = 0; f < frames; f++) {
+            dst[c + f * channels] = src[c][f];
+        }
+    }
+}
+
+inline void interleaveSamples(float** src, int channels, int frames, float* dst)
+{
+    sample_converter<sample_f32>::write(src, channels, frames, dst, 0);
+}
+
+#endif
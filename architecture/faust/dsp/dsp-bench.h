@@ -26,6 +26,7 @@
 #define __dsp_bench__
 
 #include <limits.h>
+#include <string.h>
 #include <sys/time.h>
 #include <iostream>
 #include <fstream>
@@ -280,7 +281,7 @@ class measure_dsp : public decorator_dsp {
             :decorator_dsp(dsp), fBufferSize(buffer_size)
         {
             init();
-            fBench = new time_bench(count, 10);
+            fBench = new time_bench(count, skip);
         }
     
         measure_dsp(dsp* dsp, int buffer_size, double duration_in_sec)
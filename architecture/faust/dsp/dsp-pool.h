@@ -0,0 +1,155 @@
+/************************************************************************
+    FAUST Architecture File
+    Copyright (C) 2003-2017 GRAME, Centre National de Creation Musicale
+    ---------------------------------------------------------------------
+    This Architecture section is free software; you can redistribute it
+    and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3 of
+    the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; If not, see <http://www.gnu.org/licenses/>.
+
+    EXCEPTION : As a special exception, you may create a larger work
+    that contains this FAUST architecture section and distribute
+    that work under terms of your choice, so long as this FAUST
+    architecture section is not modified.
+
+ ************************************************************************
+ ************************************************************************/
+
+#ifndef __dsp_pool__
+#define __dsp_pool__
+
+#include <vector>
+
+#include "faust/dsp/dsp.h"
+#include "faust/gui/UI.h"
+
+/**
+ * Pool of DSP instances : instances are created as copies of an initialized
+ * prototype with 'cloneState', and set back to the current prototype state with
+ * 'copyState' each time they are acquired. When 'copyState' is not supported, the
+ * instances are initialized and only get the prototype control values (the state
+ * of the delay lines is not copied). The pool is not thread safe, and 'acquire'
+ * allocates a new instance when the pool is empty, so it should not be used
+ * from the audio thread unless enough instances have been reserved.
+ */
+
+class dsp_pool {
+
+    protected:
+
+        // Collects the zones of the controls, in the 'buildUserInterface' order
+        struct zones_ui : public UI {
+
+            std::vector<FAUSTFLOAT*> fZones;
+
+            void openTabBox(const char* label) {}
+            void openHorizontalBox(const char* label) {}
+            void openVerticalBox(const char* label) {}
+            void closeBox() {}
+
+            void addButton(const char* label, FAUSTFLOAT* zone) { fZones.push_back(zone); }
+            void addCheckButton(const char* label, FAUSTFLOAT* zone) { fZones.push_back(zone); }
+            void addVerticalSlider(const char* label, FAUSTFLOAT* zone, FAUSTFLOAT init, FAUSTFLOAT min, FAUSTFLOAT max, FAUSTFLOAT step) { fZones.push_back(zone); }
+            void addHorizontalSlider(const char* label, FAUSTFLOAT* zone, FAUSTFLOAT init, FAUSTFLOAT min, FAUSTFLOAT max, FAUSTFLOAT step) { fZones.push_back(zone); }
+            void addNumEntry(const char* label, FAUSTFLOAT* zone, FAUSTFLOAT init, FAUSTFLOAT min, FAUSTFLOAT max, FAUSTFLOAT step) { fZones.push_back(zone); }
+
+            void addHorizontalBargraph(const char* label, FAUSTFLOAT* zone, FAUSTFLOAT min, FAUSTFLOAT max) { fZones.push_back(zone); }
+            void addVerticalBargraph(const char* label, FAUSTFLOAT* zone, FAUSTFLOAT min, FAUSTFLOAT max) { fZones.push_back(zone); }
+
+        };
+
+        dsp* fPrototype;
+        std::vector<dsp*> fFree;
+        int fSampleRate;
+
+        // Set the control values of an initialized instance to the prototype ones
+        void copyControls(dsp* dsp)
+        {
+            zones_ui src, dst;
+            fPrototype->buildUserInterface(&src);
+            dsp->buildUserInterface(&dst);
+            for (size_t i = 0; i < src.fZones.size() && i < dst.fZones.size(); i++) {
+                *dst.fZones[i] = *src.fZones[i];
+            }
+        }
+
+        dsp* cloneState()
+        {
+            dsp* dsp = fPrototype->clone();
+            if (!dsp->copyState(fPrototype)) {
+                dsp->init(fSampleRate);
+                copyControls(dsp);
+            }
+            return dsp;
+        }
+
+    public:
+
+        /**
+         * Constructor.
+         *
+         * @param prototype - the dsp to be copied, initialized at 'sample_rate'. Beware : dsp_pool will finally delete the pointer.
+         * @param sample_rate - the sample rate
+         * @param size - the number of instances initially allocated
+         */
+        dsp_pool(dsp* prototype, int sample_rate, int size = 0):fPrototype(prototype), fSampleRate(sample_rate)
+        {
+            fPrototype->init(sample_rate);
+            reserve(size);
+        }
+
+        virtual ~dsp_pool()
+        {
+            for (size_t i = 0; i < fFree.size(); i++) {
+                delete fFree[i];
+            }
+            delete fPrototype;
+        }
+
+        // The prototype, whose controls can be changed before instances are acquired
+        dsp* getPrototype() { return fPrototype; }
+
+        int getNumFree() { return int(fFree.size()); }
+
+        // Make sure that at least 'size' instances are available
+        void reserve(int size)
+        {
+            fFree.reserve(size);
+            while (int(fFree.size()) < size) {
+                fFree.push_back(cloneState());
+            }
+        }
+
+        // Get an instance in the current prototype state
+        dsp* acquire()
+        {
+            if (fFree.size() > 0) {
+                dsp* dsp = fFree.back();
+                fFree.pop_back();
+                if (!dsp->copyState(fPrototype)) {
+                    dsp->instanceInit(fSampleRate);
+                    copyControls(dsp);
+                }
+                return dsp;
+            } else {
+                return cloneState();
+            }
+        }
+
+        // Give back an instance acquired from the pool
+        void release(dsp* dsp)
+        {
+            fFree.push_back(dsp);
+        }
+
+};
+
+#endif
@@ -0,0 +1,383 @@
+/************************************************************************
+    FAUST Architecture File
+    Copyright (C) 2003-2017 GRAME, Centre National de Creation Musicale
+    ---------------------------------------------------------------------
+    This Architecture section is free software; you can redistribute it
+    and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3 of
+    the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; If not, see <http://www.gnu.org/licenses/>.
+
+    EXCEPTION : As a special exception, you may create a larger work
+    that contains this FAUST architecture section and distribute
+    that work under terms of your choice, so long as this FAUST
+    architecture section is not modified.
+
+ ************************************************************************
+ ************************************************************************/
+
+#ifndef __dsp_resampler__
+#define __dsp_resampler__
+
+#include <string.h>
+#include <math.h>
+#include <vector>
+#include <algorithm>
+
+#include "faust/dsp/dsp.h"
+
+#if !defined(RESAMPLER_SCALAR) && (defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1))
+#define RESAMPLER_SSE
+#include <xmmintrin.h>
+#endif
+
+/*
+    Rational sample rate conversion by 'up' / 'down' with a polyphase FIR filter.
+
+    The prototype low-pass filter (Kaiser windowed sinc, 'taps' x 'up' coefficients
+    at the 'up' times oversampled rate) is split in 'up' phases of 'taps' coefficients,
+    stored reversed so that each output sample is a dot product of one phase with
+    'taps' contiguous input samples. The dot product uses SSE for float samples when
+    available (RESAMPLER_SCALAR defined forces the scalar version).
+
+    Each channel keeps its last 'taps - 1' input samples in front of the block to
+    process, so that blocks of any size (up to 'max_input') give the same stream.
+*/
+
+class polyphase_resampler {
+
+    private:
+
+        int fUp;
+        int fDown;
+        int fTaps;
+        int fMaxInput;
+        int fPos;   // position of the next output sample in the oversampled domain, relative to the block start
+
+        std::vector<FAUSTFLOAT> fCoefs;                     // 'fUp' phases of 'fTaps' coefficients
+        std::vector<std::vector<FAUSTFLOAT> > fHistory;     // 'fTaps - 1' previous samples, then the block
+
+        static double bessel0(double x)
+        {
+            double sum = 1, term = 1;
+            for (int k = 1; k < 32; k++) {
+                term *= (x / (2 * k)) * (x / (2 * k));
+                sum += term;
+            }
+            return sum;
+        }
+
+        void makeFilter(double rolloff, double beta)
+        {
+            int size = fUp * fTaps;
+            double cutoff = rolloff * 0.5 / std::max(fUp, fDown);
+            double center = (size - 1) * 0.5;
+            // M_PI is not defined by MSVC without _USE_MATH_DEFINES
+            const double pi = 3.14159265358979323846;
+            fCoefs.resize(size);
+            for (int phase = 0; phase < fUp; phase++) {
+                for (int k = 0; k < fTaps; k++) {
+                    int i = phase + (fTaps - 1 - k) * fUp;
+                    double t = i - center;
+                    double sinc = (t == 0) ? 1 : sin(2 * pi * cutoff * t) / (2 * pi * cutoff * t);
+                    double r = t / (center + 1);
+                    double window = bessel0(beta * sqrt(1 - r * r)) / bessel0(beta);
+                    fCoefs[phase * fTaps + k] = FAUSTFLOAT(fUp * 2 * cutoff * sinc * window);
+                }
+            }
+        }
+
+        static inline FAUSTFLOAT dot(const double* coefs, const double* samples, int size)
+        {
+            double sum = 0;
+            for (int i = 0; i < size; i++) {
+                sum += coefs[i] * samples[i];
+            }
+            return sum;
+        }
+
+        static inline FAUSTFLOAT dot(const float* coefs, const float* samples, int size)
+        {
+        #ifdef RESAMPLER_SSE
+            // 'size' is a multiple of 4
+            __m128 sum = _mm_setzero_ps();
+            for (int i = 0; i < size; i += 4) {
+                sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(coefs + i), _mm_loadu_ps(samples + i)));
+            }
+            sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+            sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+            return _mm_cvtss_f32(sum);
+        #else
+            float sum = 0;
+            for (int i = 0; i < size; i++) {
+                sum += coefs[i] * samples[i];
+            }
+            return sum;
+        #endif
+        }
+
+    public:
+
+        /**
+         * Constructor.
+         *
+         * @param channels - the number of channels
+         * @param up, down - the conversion ratio (output rate / input rate = up / down), reduced here
+         * @param max_input - the maximum number of input samples given to 'process'
+         * @param taps - the number of coefficients per phase (rounded to a multiple of 4)
+         * @param rolloff - the filter cutoff, relative to the lowest Nyquist frequency
+         * @param beta - the Kaiser window parameter (8 gives about 80 dB of stopband attenuation)
+         */
+        polyphase_resampler(int channels, int up, int down, int max_input, int taps = 32, double rolloff = 0.9, double beta = 8)
+        {
+            int a = up, b = down;
+            while (b != 0) { int t = a % b; a = b; b = t; }
+            fUp = up / a;
+            fDown = down / a;
+            fTaps = std::max(4, (taps + 3) & ~3);
+            fMaxInput = max_input;
+            fHistory.resize(channels, std::vector<FAUSTFLOAT>(fTaps - 1 + max_input));
+            makeFilter(rolloff, beta);
+            reset();
+        }
+
+        // 'offset' (in [0, up)) advances the output samples by 'offset' / 'up' input samples
+        void reset(int offset = 0)
+        {
+            fPos = offset;
+            for (size_t chan = 0; chan < fHistory.size(); chan++) {
+                std::fill(fHistory[chan].begin(), fHistory[chan].end(), FAUSTFLOAT(0));
+            }
+        }
+
+        int getUp() { return fUp; }
+        int getDown() { return fDown; }
+        int getTaps() { return fTaps; }
+
+        // Number of samples produced by the next 'process' of 'count' samples
+        int getOutputCount(int count)
+        {
+            int num = count * fUp - fPos;
+            return (num > 0) ? (num + fDown - 1) / fDown : 0;
+        }
+
+        // Maximum number of samples produced by 'process' of 'count' samples
+        int getMaxOutput(int count) { return (count * fUp + fDown - 1) / fDown; }
+
+
+        /**
+         * Convert 'count' samples (at most 'max_input') of each input channel.
+         * 'inputs' and 'outputs' may be the same buffers.
+         *
+         * @return the number of samples written in each output channel, as given by 'getOutputCount'
+         */
+        int process(int count, FAUSTFLOAT** inputs, FAUSTFLOAT** outputs)
+        {
+            int produced = getOutputCount(count);
+            int history = fTaps - 1;
+
+            for (size_t chan = 0; chan < fHistory.size(); chan++) {
+                FAUSTFLOAT* samples = &fHistory[chan][0];
+                memcpy(samples + history, inputs[chan], sizeof(FAUSTFLOAT) * count);
+                FAUSTFLOAT* out = outputs[chan];
+                int pos = fPos;
+                for (int n = 0; n < produced; n++, pos += fDown) {
+                    int index = pos / fUp;
+                    out[n] = dot(&fCoefs[(pos - index * fUp) * fTaps], samples + index, fTaps);
+                }
+                memmove(samples, samples + count, sizeof(FAUSTFLOAT) * history);
+            }
+
+            fPos += produced * fDown - count * fUp;
+            return produced;
+        }
+
+};
+
+/**
+ * DSP decorator running the decorated DSP at 'up' / 'down' times the audio rate,
+ * for instance 2 / 1 or 4 / 1 for oversampled non-linear processing, 1 / 4 for
+ * analysis at a reduced rate (and a reduced CPU cost), or 160 / 147 for a DSP
+ * which has to run at 48 kHz with a 44.1 kHz audio driver.
+ *
+ * Inputs are converted to the internal rate, and outputs back to the audio rate.
+ * The number of internal samples varies from block to block with fractional ratios:
+ * the converted outputs go through a FIFO holding at most 'down' / 'up' + 1 extra samples,
+ * so that the output stream does not depend on the block sizes. The total latency
+ * of both conversions is given by 'getLatency'.
+ */
+
+class dsp_resampler : public decorator_dsp {
+
+    private:
+
+        polyphase_resampler fInputResampler;
+        polyphase_resampler fOutputResampler;
+        int fMaxInput;
+        int fTaps;
+
+        std::vector<std::vector<FAUSTFLOAT> > fInnerInputs;
+        std::vector<std::vector<FAUSTFLOAT> > fInnerOutputs;
+        std::vector<std::vector<FAUSTFLOAT> > fFifo;
+        std::vector<FAUSTFLOAT*> fInnerInputsPtr;
+        std::vector<FAUSTFLOAT*> fInnerOutputsPtr;
+        std::vector<FAUSTFLOAT*> fFifoPtr;
+        std::vector<FAUSTFLOAT*> fSliceInputs;
+        std::vector<FAUSTFLOAT*> fSliceOutputs;
+        int fFifoSize;
+        int fSampleRate;
+
+        /*
+            The group delay of both filters is ((up + down) * taps - 2) / (2 * up) audio samples.
+            When it is not an integer, its fractional part is removed by starting the output
+            conversion 'offset' oversampled positions later, and one sample of delay is added
+            with the FIFO, so that the latency is always an integer number of samples.
+        */
+        int getOffset()
+        {
+            int delay = (getUp() + getDown()) * fInputResampler.getTaps() / 2 - 1;
+            return delay % getUp();
+        }
+
+        void reset()
+        {
+            int offset = getOffset();
+            fInputResampler.reset();
+            fOutputResampler.reset(offset);
+            fFifoSize = (offset > 0) ? 1 : 0;
+            for (size_t chan = 0; chan < fFifo.size(); chan++) {
+                fFifo[chan][0] = FAUSTFLOAT(0);
+            }
+        }
+
+        void computeSlice(int count, FAUSTFLOAT** inputs, FAUSTFLOAT** outputs)
+        {
+            int inner = fInputResampler.process(count, inputs, &fInnerInputsPtr[0]);
+            if (inner > 0) {
+                fDSP->compute(inner, &fInnerInputsPtr[0], &fInnerOutputsPtr[0]);
+            }
+
+            int outputs_num = int(fFifo.size());
+            for (int chan = 0; chan < outputs_num; chan++) {
+                fFifoPtr[chan] = &fFifo[chan][fFifoSize];
+            }
+            fFifoSize += fOutputResampler.process(inner, &fInnerOutputsPtr[0], &fFifoPtr[0]);
+
+            // The FIFO always holds at least 'count' samples : the output conversion of the
+            // 'ceil(count * up / down)' internal samples gives at least 'count' - 1 samples when
+            // started with an offset (see 'polyphase_resampler::getOutputCount' and 'reset')
+            for (int chan = 0; chan < outputs_num; chan++) {
+                FAUSTFLOAT* fifo = &fFifo[chan][0];
+                memcpy(outputs[chan], fifo, sizeof(FAUSTFLOAT) * count);
+                memmove(fifo, fifo + count, sizeof(FAUSTFLOAT) * (fFifoSize - count));
+            }
+            fFifoSize -= count;
+        }
+
+    public:
+
+        /**
+         * Constructor.
+         *
+         * @param dsp - the dsp to run at the internal rate. Beware : dsp_resampler will use and finally delete the pointer.
+         * @param up, down - the ratio of the internal rate to the audio rate
+         * @param buffer_size - the maximum audio buffer size (larger buffers are computed in several slices)
+         * @param taps - the number of coefficients per phase of the conversion filters
+         */
+        dsp_resampler(dsp* dsp, int up, int down, int buffer_size, int taps = 32)
+            :decorator_dsp(dsp),
+            fInputResampler(dsp->getNumInputs(), up, down, buffer_size, taps),
+            fOutputResampler(dsp->getNumOutputs(), down, up, fInputResampler.getMaxOutput(buffer_size), taps),
+            fMaxInput(buffer_size), fTaps(taps), fFifoSize(0), fSampleRate(0)
+        {
+            int inner = fInputResampler.getMaxOutput(buffer_size);
+            for (int chan = 0; chan < dsp->getNumInputs(); chan++) {
+                fInnerInputs.push_back(std::vector<FAUSTFLOAT>(inner));
+                fInnerInputsPtr.push_back(&fInnerInputs[chan][0]);
+            }
+            // Inner buffers are also used when there is no input or output
+            fInnerInputsPtr.push_back(0);
+            for (int chan = 0; chan < dsp->getNumOutputs(); chan++) {
+                fInnerOutputs.push_back(std::vector<FAUSTFLOAT>(inner));
+                fInnerOutputsPtr.push_back(&fInnerOutputs[chan][0]);
+                fFifo.push_back(std::vector<FAUSTFLOAT>(fOutputResampler.getMaxOutput(inner) + getDown() / getUp() + 2));
+                fFifoPtr.push_back(0);
+            }
+            fInnerOutputsPtr.push_back(0);
+            fFifoPtr.push_back(0);
+            fSliceInputs.resize(dsp->getNumInputs() + 1);
+            fSliceOutputs.resize(dsp->getNumOutputs() + 1);
+            reset();
+        }
+
+        int getUp() { return fInputResampler.getUp(); }
+        int getDown() { return fInputResampler.getDown(); }
+
+        // Latency of the sample rate conversions, in audio samples
+        int getLatency()
+        {
+            int delay = (getUp() + getDown()) * fInputResampler.getTaps() / 2 - 1;
+            return delay / getUp() + ((getOffset() > 0) ? 1 : 0);
+        }
+
+        virtual int getSampleRate() { return fSampleRate; }
+
+        virtual void init(int samplingRate)
+        {
+            fSampleRate = samplingRate;
+            fDSP->init(samplingRate * getUp() / getDown());
+            reset();
+        }
+
+        virtual void instanceInit(int samplingRate)
+        {
+            fSampleRate = samplingRate;
+            fDSP->instanceInit(samplingRate * getUp() / getDown());
+            reset();
+        }
+
+        virtual void instanceConstants(int samplingRate)
+        {
+            fSampleRate = samplingRate;
+            fDSP->instanceConstants(samplingRate * getUp() / getDown());
+        }
+
+        virtual void instanceClear()
+        {
+            fDSP->instanceClear();
+            reset();
+        }
+
+        virtual dsp_resampler* clone() { return new dsp_resampler(fDSP->clone(), getUp(), getDown(), fMaxInput, fTaps); }
+
+        virtual void compute(int count, FAUSTFLOAT** inputs, FAUSTFLOAT** outputs)
+        {
+            int inputs_num = getNumInputs();
+            int outputs_num = getNumOutputs();
+
+            for (int offset = 0; offset < count; offset += fMaxInput) {
+                for (int chan = 0; chan < inputs_num; chan++) {
+                    fSliceInputs[chan] = inputs[chan] + offset;
+                }
+                for (int chan = 0; chan < outputs_num; chan++) {
+                    fSliceOutputs[chan] = outputs[chan] + offset;
+                }
+                computeSlice(std::min(fMaxInput, count - offset), &fSliceInputs[0], &fSliceOutputs[0]);
+            }
+        }
+
+        virtual void compute(double date_usec, int count, FAUSTFLOAT** inputs, FAUSTFLOAT** outputs)
+        {
+            compute(count, inputs, outputs);
+        }
+
+};
+
+#endif
@@ -47,9 +47,27 @@
 #define FAUSTFLOAT float
 #endif
 
+#include <stddef.h>
+
 class UI;
 struct Meta;
 
+/**
+ * Memory manager used by the classes generated with the -mem option to
+ * allocate their big buffers (delay lines...). It can be set with the static
+ * 'fManager' field of the generated class before creating instances, so that
+ * pools, arenas or huge pages can be used. Default is malloc/free.
+ */
+
+struct dsp_memory_manager {
+
+    virtual ~dsp_memory_manager() {}
+
+    virtual void* allocate(size_t size) = 0;
+    virtual void destroy(void* ptr) = 0;
+
+};
+
 /**
 * Signal processor definition.
 */
@@ -111,6 +129,32 @@ class dsp {
          */
         virtual dsp* clone() = 0;
     
+        /**
+         * Copy the complete state (sample rate, constants, controls, delay lines...) of 'src',
+         * an initialized instance of the same class, without running 'init'.
+         * The compiler generates it with the '-cs' option.
+         *
+         * @param src - the instance to copy
+         * @return true on success, false if not supported or if 'src' is not an instance
+         * of the same class (the instance then has to be initialized)
+         */
+        virtual bool copyState(dsp* src) { return false; }
+    
+        /**
+         * Return a clone of the instance in the same state, much faster than 'clone' followed
+         * by 'init' when 'copyState' is supported (as in the classes generated with '-cs').
+         *
+         * @return a copy of the instance in the same state on success, otherwise a null pointer.
+         */
+        virtual dsp* cloneState()
+        {
+            dsp* copy = clone();
+            if (copy && !copy->copyState(this)) {
+                copy->init(getSampleRate());
+            }
+            return copy;
+        }
+    
         /**
          * Trigger the Meta* parameter with instance specific calls to 'declare' (key, value metadata).
          *
@@ -166,6 +210,11 @@ class decorator_dsp : public dsp {
         virtual void instanceResetUserInterface() { fDSP->instanceResetUserInterface(); }
         virtual void instanceClear() { fDSP->instanceClear(); }
         virtual decorator_dsp* clone() { return new decorator_dsp(fDSP->clone()); }
+        virtual bool copyState(dsp* src)
+        {
+            decorator_dsp* decorator = dynamic_cast<decorator_dsp*>(src);
+            return decorator && fDSP->copyState(decorator->fDSP);
+        }
         virtual void metadata(Meta* m) { return fDSP->metadata(m); }
         virtual void compute(int count, FAUSTFLOAT** inputs, FAUSTFLOAT** outputs) { fDSP->compute(count, inputs, outputs); }
         virtual void compute(double date_usec, int count, FAUSTFLOAT** inputs, FAUSTFLOAT** outputs) { fDSP->compute(date_usec, count, inputs, outputs); }
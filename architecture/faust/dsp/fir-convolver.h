@@ -0,0 +1,215 @@
+/************************************************************************
+    FAUST Architecture File
+    Copyright (C) 2003-2017 GRAME, Centre National de Creation Musicale
+    ---------------------------------------------------------------------
+    This Architecture section is free software; you can redistribute it
+    and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3 of
+    the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; If not, see <http://www.gnu.org/licenses/>.
+
+    EXCEPTION : As a special exception, you may create a larger work
+    that contains this FAUST architecture section and distribute
+    that work under terms of your choice, so long as this FAUST
+    architecture section is not modified.
+
+ ************************************************************************
+ ************************************************************************/
+
+#ifndef __fir_convolver__
+#define __fir_convolver__
+
+#include <math.h>
+#include <string.h>
+
+/**
+ * Convolution of a signal by a FIR filter of N constant taps, without latency.
+ * The compiler copies this file in the code generated for the long FIR filters
+ * (see the -mfs and -fbs options), which thus needs no external library.
+ *
+ * The first B taps are computed directly. The other ones are cut in P partitions
+ * of B taps, and computed by uniformly partitioned convolution : the input is cut
+ * in blocks of B samples, whose spectra (FFT of 2B points, overlap-save) are kept
+ * in a frequency domain delay line and multiplied by the spectra of the partitions.
+ * As the partitions only apply to the previous blocks, their contribution to a
+ * block is computed at the end of the previous one, and the result is exactly the
+ * convolution, for a cost in O(B + P + log(B)) per sample. B is a power of 2,
+ * lower than N. The larger B, the longer the computation done every B samples.
+ */
+
+template <typename REAL, int N, int B>
+class fir_convolver {
+
+    private:
+
+        enum { L = 2*B, P = (N-1)/B };
+
+        REAL fHead[B];              // the first B taps, reversed
+        REAL fHistory[2*B];         // the last B input samples, stored twice
+        REAL fInput[L];             // the previous and the current input blocks
+        REAL fTail[B];              // contribution of the partitions to the current block
+        int fPos;                   // position in the current block
+        int fNewest;                // spectrum of the last complete block in fSpectra
+
+        // the signals are real : only the first B+1 bins of the spectra are kept
+        REAL fFilterRe[P][B+1];     // spectra of the partitions, divided by L
+        REAL fFilterIm[P][B+1];
+        REAL fSpectraRe[P][B+1];    // spectra of the last P blocks (ring buffer)
+        REAL fSpectraIm[P][B+1];
+        REAL fSumRe[B+1];
+        REAL fSumIm[B+1];
+
+        REAL fRe[L];                // FFT of L points, in place
+        REAL fIm[L];
+        REAL fCos[L/2];
+        REAL fSin[L/2];
+        int fReverse[L];
+
+        // radix 2 FFT of fRe + i.fIm, not normalized : sign is -1 for the direct transform, 1 for the inverse one
+        void fft(REAL sign)
+        {
+            for (int i = 0; i < L; i++) {
+                int j = fReverse[i];
+                if (j > i) {
+                    REAL r = fRe[i]; fRe[i] = fRe[j]; fRe[j] = r;
+                    REAL m = fIm[i]; fIm[i] = fIm[j]; fIm[j] = m;
+                }
+            }
+            for (int size = 2; size <= L; size *= 2) {
+                int half = size/2;
+                int step = L/size;
+                for (int i = 0; i < L; i += size) {
+                    for (int j = 0; j < half; j++) {
+                        REAL wr = fCos[j*step];
+                        REAL wi = sign * fSin[j*step];
+                        int a = i + j;
+                        int b = a + half;
+                        REAL tr = wr * fRe[b] - wi * fIm[b];
+                        REAL ti = wr * fIm[b] + wi * fRe[b];
+                        fRe[b] = fRe[a] - tr;
+                        fIm[b] = fIm[a] - ti;
+                        fRe[a] += tr;
+                        fIm[a] += ti;
+                    }
+                }
+            }
+        }
+
+        // end of a block : computes the contribution of the partitions to the next one
+        void nextBlock()
+        {
+            // spectrum of the last two blocks
+            fNewest = (fNewest + 1) % P;
+            for (int i = 0; i < L; i++) {
+                fRe[i] = fInput[i];
+                fIm[i] = 0;
+            }
+            fft(-1);
+            memcpy(fSpectraRe[fNewest], fRe, sizeof(fSumRe));
+            memcpy(fSpectraIm[fNewest], fIm, sizeof(fSumIm));
+
+            // the partition p applies to the block p blocks before the last one
+            memset(fSumRe, 0, sizeof(fSumRe));
+            memset(fSumIm, 0, sizeof(fSumIm));
+            for (int p = 0; p < P; p++) {
+                int s = (fNewest + P - p) % P;
+                const REAL* xr = fSpectraRe[s];
+                const REAL* xi = fSpectraIm[s];
+                const REAL* hr = fFilterRe[p];
+                const REAL* hi = fFilterIm[p];
+                for (int k = 0; k <= B; k++) {
+                    fSumRe[k] += xr[k] * hr[k] - xi[k] * hi[k];
+                    fSumIm[k] += xr[k] * hi[k] + xi[k] * hr[k];
+                }
+            }
+
+            // back to the time domain : the last B samples are the convolution
+            for (int k = 0; k <= B; k++) {
+                fRe[k] = fSumRe[k];
+                fIm[k] = fSumIm[k];
+            }
+            for (int k = B+1; k < L; k++) {
+                fRe[k] = fSumRe[L-k];
+                fIm[k] = -fSumIm[L-k];
+            }
+            fft(1);
+            memcpy(fTail, &fRe[B], sizeof(fTail));
+            memcpy(fInput, &fInput[B], B * sizeof(REAL));
+        }
+
+    public:
+
+        // h : the N taps of the filter
+        void init(const REAL* h)
+        {
+            int bits = 0;
+            while ((1 << bits) < L) bits++;
+            for (int i = 0; i < L; i++) {
+                int r = 0;
+                for (int b = 0; b < bits; b++) {
+                    if (i & (1 << b)) r |= 1 << (bits - 1 - b);
+                }
+                fReverse[i] = r;
+            }
+            for (int k = 0; k < L/2; k++) {
+                fCos[k] = REAL(cos(2 * 3.14159265358979323846 * k / L));
+                fSin[k] = REAL(sin(2 * 3.14159265358979323846 * k / L));
+            }
+
+            for (int j = 0; j < B; j++) {
+                fHead[j] = h[B-1-j];
+            }
+            for (int p = 0; p < P; p++) {
+                for (int i = 0; i < L; i++) {
+                    int t = (p+1) * B + i;
+                    fRe[i] = (i < B && t < N) ? h[t] : 0;
+                    fIm[i] = 0;
+                }
+                fft(-1);
+                for (int k = 0; k <= B; k++) {
+                    fFilterRe[p][k] = fRe[k] / L;
+                    fFilterIm[p][k] = fIm[k] / L;
+                }
+            }
+            clear();
+        }
+
+        void clear()
+        {
+            memset(fHistory, 0, sizeof(fHistory));
+            memset(fInput, 0, sizeof(fInput));
+            memset(fTail, 0, sizeof(fTail));
+            memset(fSpectraRe, 0, sizeof(fSpectraRe));
+            memset(fSpectraIm, 0, sizeof(fSpectraIm));
+            fPos = 0;
+            fNewest = 0;
+        }
+
+        // next output sample, for the input sample x
+        inline REAL compute(REAL x)
+        {
+            fHistory[fPos] = x;
+            fHistory[fPos + B] = x;
+            fInput[B + fPos] = x;
+            REAL y = fTail[fPos];
+            const REAL* past = &fHistory[fPos + 1];
+            for (int j = 0; j < B; j++) {
+                y += fHead[j] * past[j];
+            }
+            if (++fPos == B) {
+                nextBlock();
+                fPos = 0;
+            }
+            return y;
+        }
+
+};
+
+#endif
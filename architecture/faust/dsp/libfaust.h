@@ -0,0 +1,89 @@
+/************************************************************************
+    FAUST Architecture File
+    Copyright (C) 2003-2017 GRAME, Centre National de Creation Musicale
+    ---------------------------------------------------------------------
+    This Architecture section is free software; you can redistribute it
+    and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3 of
+    the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; If not, see <http://www.gnu.org/licenses/>.
+
+    EXCEPTION : As a special exception, you may create a larger work
+    that contains this FAUST architecture section and distribute
+    that work under terms of your choice, so long as this FAUST
+    architecture section is not modified.
+
+ ************************************************************************
+ ************************************************************************/
+
+#ifndef __libfaust__
+#define __libfaust__
+
+#include <string>
+#include <vector>
+
+/**
+ * Subprocess wrapper around the Faust compiler, provided by libfaust.a (see
+ * compiler/Makefile.unix). The library does not contain the compiler, which
+ * keeps its state in globals and ends on errors with exit() : each call runs
+ * the faust binary (see fCompiler) in a new process, created with posix_spawn
+ * (CreateProcess on Windows), on a copy of the source in a private temporary
+ * directory. The compilations thus don't share any state, and their errors
+ * are returned in the result instead of ending the host. The calls can be
+ * made from several threads at the same time, each one costing the time of a
+ * command line compilation.
+ *
+ * As with the command line compiler, the order of the metadata and of the
+ * terms of commutative operations follows the tree addresses, and may change
+ * from one compilation to another.
+ */
+
+struct faust_options {
+
+    std::string fCompiler;                  // the compiler to run, searched in the PATH ("faust" by default)
+    std::vector<std::string> fImportDirs;   // -I : directories searched for imports and libraries
+    std::string fClassName;                 // -cn : name of the generated class
+    bool fVectorize;                        // -vec : generate vector code
+    int fVecSize;                           // -vs : size of the vectors
+    bool fScheduler;                        // -sch : generate tasks for the work stealing scheduler
+    bool fOpenMP;                           // -omp : generate OpenMP pragmas
+    int fFloatSize;                         // 1 : -single, 2 : -double, 3 : -quad
+    bool fJSON;                             // -json : generate the JSON description
+    int fTimeout;                           // -t : abort the compilation after fTimeout seconds
+    std::vector<std::string> fOptions;      // other command line options
+
+    faust_options():fCompiler("faust"), fClassName("mydsp"), fVectorize(false), fVecSize(32), fScheduler(false),
+                    fOpenMP(false), fFloatSize(1), fJSON(false), fTimeout(120) {}
+
+};
+
+struct faust_result {
+
+    std::string fCode;                      // the generated C++ code
+    std::string fJSON;                      // the JSON description, when fJSON is set
+    std::string fMessages;                  // the warnings and errors of the compiler
+
+};
+
+/**
+ * Compile a DSP.
+ *
+ * @param name - the name of the DSP, used to name the source file ("process" by default) : as the
+ *               source is compiled in a temporary directory, the directories of its imports must
+ *               be in options.fImportDirs
+ * @param source - the Faust source code
+ * @param options - the compilation options
+ * @param result - the generated code and the compiler messages
+ *
+ * @return true if the compilation succeeded, false otherwise (see result.fMessages).
+ */
+bool compileFaustDSP(const std::string& name, const std::string& source, const faust_options& options, faust_result& result);
+
+#endif
@@ -437,17 +437,23 @@ class mydsp_poly : public dsp, public midi {
     
         void init(int sample_rate)
         {
-            // Init voices
-            for (int i = 0; i < fPolyphony; i++) {
-                fVoiceTable[i]->init(sample_rate);
+            // Init the first voice, the other ones copy its state when possible
+            fVoiceTable[0]->init(sample_rate);
+            for (int i = 1; i < fPolyphony; i++) {
+                if (!fVoiceTable[i]->copyState(fVoiceTable[0])) {
+                    fVoiceTable[i]->init(sample_rate);
+                }
             }
         }
     
         void instanceInit(int sample_rate)
         {
-            // Init voices
-            for (int i = 0; i < fPolyphony; i++) {
-                fVoiceTable[i]->instanceInit(sample_rate);
+            // Init the first voice, the other ones copy its state when possible
+            fVoiceTable[0]->instanceInit(sample_rate);
+            for (int i = 1; i < fPolyphony; i++) {
+                if (!fVoiceTable[i]->copyState(fVoiceTable[0])) {
+                    fVoiceTable[i]->instanceInit(sample_rate);
+                }
             }
         }
     
@@ -0,0 +1,69 @@
+/************************************************************************
+    FAUST Architecture File
+    Copyright (C) 2003-2017 GRAME, Centre National de Creation Musicale
+    ---------------------------------------------------------------------
+    This Architecture section is free software; you can redistribute it
+    and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3 of
+    the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; If not, see <http://www.gnu.org/licenses/>.
+
+    EXCEPTION : As a special exception, you may create a larger work
+    that contains this FAUST architecture section and distribute
+    that work under terms of your choice, so long as this FAUST
+    architecture section is not modified.
+
+ ************************************************************************
+ ************************************************************************/
+
+#ifndef __preset_dsp__
+#define __preset_dsp__
+
+#include "faust/dsp/dsp.h"
+#include "faust/gui/PresetUI.h"
+
+/*******************************************************************************
+ * preset_dsp : applies the presets recalled or morphed with its PresetUI
+ * at the beginning of each block, before the decorated DSP computes it.
+ ******************************************************************************/
+
+class preset_dsp : public decorator_dsp {
+
+    protected:
+
+        PresetUI fPresets;
+
+    public:
+
+        preset_dsp(dsp* dsp):decorator_dsp(dsp)
+        {
+            fDSP->buildUserInterface(&fPresets);
+        }
+        virtual ~preset_dsp() {}
+
+        // To be used from the UI thread
+        PresetUI* getPresets() { return &fPresets; }
+
+        virtual preset_dsp* clone() { return new preset_dsp(fDSP->clone()); }
+
+        virtual void compute(int count, FAUSTFLOAT** inputs, FAUSTFLOAT** outputs)
+        {
+            fPresets.process();
+            fDSP->compute(count, inputs, outputs);
+        }
+        virtual void compute(double date_usec, int count, FAUSTFLOAT** inputs, FAUSTFLOAT** outputs)
+        {
+            fPresets.process();
+            fDSP->compute(date_usec, count, inputs, outputs);
+        }
+
+};
+
+#endif
@@ -42,6 +42,7 @@
 #include "faust/dsp/dsp.h"
 #include "faust/gui/SimpleParser.h"
 #include "faust/gui/JSONUI.h"
+#include "faust/gui/BinaryUI.h"
 
 #ifdef _WIN32
 #include <windows.h>
@@ -103,7 +104,7 @@ struct JSONUIDecoder {
         
         for (it = fUiItems.begin(); it != fUiItems.end(); it++) {
             string type = (*it)->type;
-            if (type == "vslider" || type == "hslider" || type == "nentry" || type == "button") {
+            if (type == "vslider" || type == "hslider" || type == "nentry" || type == "button" || type == "checkbox") {
                 fInputItems++;
             } else if (type == "hbargraph" || type == "vbargraph") {
                 fOutputItems++;          
@@ -153,7 +154,7 @@ struct JSONUIDecoder {
             FAUSTFLOAT max = STR2REAL((*it)->max);
             FAUSTFLOAT step = STR2REAL((*it)->step);
             
-            if (type == "vslider" || type == "hslider" || type == "nentry" || type == "button") {
+            if (type == "vslider" || type == "hslider" || type == "nentry" || type == "button" || type == "checkbox") {
                 isInItem = true;
             } else if (type == "hbargraph" || type == "vbargraph") {
                 isOutItem = true;        
@@ -220,6 +221,7 @@ struct JSONUIDecoder {
 
 //----------------------------------------------------------------
 //  Proxy dsp definition created from the DSP JSON description
+//  or from its binary descriptor (see BinaryUI.h).
 //  This class allows a 'proxy' dsp to control a real dsp 
 //  possibly running somewhere else.
 //----------------------------------------------------------------
@@ -230,33 +232,69 @@ class proxy_dsp : public dsp {
     
         int fSamplingFreq;
         JSONUIDecoder* fDecoder;
+        BinaryUIDecoder* fBinaryDecoder;
+        std::vector<uint64_t> fDescriptor;  // owned copy of the binary descriptor, 8 bytes aligned
+        size_t fDescriptorSize;
+    
+        void initBinary(const char* descriptor, size_t size, bool copy)
+        {
+            fDecoder = 0;
+            fDescriptorSize = size;
+            if (copy && size > 0) {
+                fDescriptor.resize((size + 7) / 8);
+                memcpy(&fDescriptor[0], descriptor, size);
+                descriptor = (const char*)&fDescriptor[0];
+            }
+            fBinaryDecoder = new BinaryUIDecoder(descriptor, size);
+        }
         
     public:
     
         proxy_dsp(const string& json)
         {
             fDecoder = new JSONUIDecoder(json);
+            fBinaryDecoder = 0;
+            fDescriptorSize = 0;
+            fSamplingFreq = -1;
+        }
+    
+        // The descriptor is used in place unless 'copy' is set, it then has to outlive the proxy
+        proxy_dsp(const char* descriptor, size_t size, bool copy = false)
+        {
+            initBinary(descriptor, size, copy);
             fSamplingFreq = -1;
         }
           
         proxy_dsp(dsp* dsp)
         {
-            JSONUI builder(dsp->getNumInputs(), dsp->getNumOutputs());
+            BinaryUI builder(dsp->getNumInputs(), dsp->getNumOutputs());
             dsp->metadata(&builder);
             dsp->buildUserInterface(&builder);
+            std::string descriptor = builder.binary();
+            initBinary(descriptor.data(), descriptor.size(), true);
             fSamplingFreq = dsp->getSampleRate();
-            fDecoder = new JSONUIDecoder(builder.JSON());
         }
       
         virtual ~proxy_dsp()
         {
             delete fDecoder;
+            delete fBinaryDecoder;
         }
+    
+        // False when built from an invalid binary descriptor
+        bool isValid() { return (fDecoder) ? true : fBinaryDecoder->isValid(); }
        
-        virtual int getNumInputs() 	{ return fDecoder->fNumInputs; }
-        virtual int getNumOutputs() { return fDecoder->fNumOutputs; }
+        virtual int getNumInputs() { return (fDecoder) ? fDecoder->fNumInputs : fBinaryDecoder->fNumInputs; }
+        virtual int getNumOutputs() { return (fDecoder) ? fDecoder->fNumOutputs : fBinaryDecoder->fNumOutputs; }
         
-        virtual void buildUserInterface(UI* ui) { fDecoder->buildUserInterface(ui); }
+        virtual void buildUserInterface(UI* ui)
+        {
+            if (fDecoder) {
+                fDecoder->buildUserInterface(ui);
+            } else {
+                fBinaryDecoder->buildUserInterface(ui);
+            }
+        }
         
         // To possibly implement in a concrete proxy dsp 
         virtual void init(int samplingRate) { fSamplingFreq = samplingRate; }
@@ -267,8 +305,23 @@ class proxy_dsp : public dsp {
     
         virtual int getSampleRate() { return fSamplingFreq; }
     
-        virtual proxy_dsp* clone() { return new proxy_dsp(fDecoder->fJSON); }
-        virtual void metadata(Meta* m) { fDecoder->metadata(m); }
+        virtual proxy_dsp* clone()
+        {
+            if (fDecoder) {
+                return new proxy_dsp(fDecoder->fJSON);
+            } else {
+                return new proxy_dsp(fBinaryDecoder->fData, fDescriptorSize, fDescriptor.size() > 0);
+            }
+        }
+    
+        virtual void metadata(Meta* m)
+        {
+            if (fDecoder) {
+                fDecoder->metadata(m);
+            } else {
+                fBinaryDecoder->metadata(m);
+            }
+        }
     
         virtual void compute(int count, FAUSTFLOAT** inputs, FAUSTFLOAT** outputs) {}
         virtual void compute(double date_usec, int count, FAUSTFLOAT** inputs, FAUSTFLOAT** outputs) {} 
@@ -0,0 +1,353 @@
+/************************************************************************
+    FAUST Architecture File
+    Copyright (C) 2003-2017 GRAME, Centre National de Creation Musicale
+    ---------------------------------------------------------------------
+    This Architecture section is free software; you can redistribute it
+    and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3 of
+    the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; If not, see <http://www.gnu.org/licenses/>.
+
+    EXCEPTION : As a special exception, you may create a larger work
+    that contains this FAUST architecture section and distribute
+    that work under terms of your choice, so long as this FAUST
+    architecture section is not modified.
+
+ ************************************************************************
+ ************************************************************************/
+
+#ifndef __swap_dsp__
+#define __swap_dsp__
+
+#include <pthread.h>
+#include <unistd.h>
+#include <string.h>
+
+#include <vector>
+#include <map>
+#include <string>
+#include <algorithm>
+
+#include "faust/dsp/dsp.h"
+#include "faust/gui/MapUI.h"
+#include "faust/gui/BinaryUI.h"
+#include "faust/gui/ring-buffer.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+inline void* atomicExchangePtr(void* volatile* ptr, void* value)
+{
+#ifdef _WIN32
+    return InterlockedExchangePointer(ptr, value);
+#else
+    return __atomic_exchange_n(ptr, value, __ATOMIC_ACQ_REL);
+#endif
+}
+
+/**
+ * Deletes DSP instances given by the audio thread from a low priority thread.
+ * 'reclaim' is lock-free and can be called in real-time context.
+ */
+
+class dsp_reclaimer {
+
+    private:
+
+        ringbuffer_t* fQueue;
+        pthread_t fThread;
+        volatile bool fRunning;
+
+        void deleteAll()
+        {
+            dsp* dsp;
+            while (ringbuffer_read(fQueue, (char*)&dsp, sizeof(dsp)) == sizeof(dsp)) {
+                delete dsp;
+            }
+        }
+
+        static void* run(void* arg)
+        {
+            dsp_reclaimer* reclaimer = static_cast<dsp_reclaimer*>(arg);
+            while (reclaimer->fRunning) {
+                reclaimer->deleteAll();
+                usleep(20000);
+            }
+            return 0;
+        }
+
+    public:
+
+        dsp_reclaimer(int size = 64):fRunning(true)
+        {
+            fQueue = ringbuffer_create(size * sizeof(dsp*));
+            pthread_create(&fThread, NULL, run, this);
+        }
+
+        virtual ~dsp_reclaimer()
+        {
+            fRunning = false;
+            pthread_join(fThread, NULL);
+            deleteAll();
+            ringbuffer_free(fQueue);
+        }
+
+        // Returns false when the queue is full, the instance then has to be given again later
+        bool reclaim(dsp* dsp)
+        {
+            if (ringbuffer_write_space(fQueue) < sizeof(dsp)) return false;
+            ringbuffer_write(fQueue, (const char*)&dsp, sizeof(dsp));
+            return true;
+        }
+
+};
+
+/**
+ * DSP decorator allowing to replace the running DSP without stopping the audio stream.
+ *
+ * A new instance, with the same number of inputs and outputs, is given with 'swap' from
+ * a non real-time thread. The audio thread takes it at the beginning of the next block,
+ * crossfades the outputs of the old and new instances over 'fade' samples, then gives
+ * the old instance to a reclaimer thread which deletes it.
+ *
+ * The user interface is built once on stable zones : their values are copied at each
+ * block to (and from, for bargraphs) the controls of the running instances which have
+ * the same path. Controls keep their values when the DSP is replaced, and user
+ * interfaces never access a deleted instance.
+ */
+
+class swap_dsp : public decorator_dsp {
+
+    protected:
+
+        enum { kChunkSize = 256 };
+
+        // A running instance with the mapping of its controls to the stable zones
+        struct dsp_slot : public decorator_dsp {
+
+            std::vector<std::pair<FAUSTFLOAT*, FAUSTFLOAT*> > fInputs;    // stable zone, instance zone
+            std::vector<std::pair<FAUSTFLOAT*, FAUSTFLOAT*> > fOutputs;   // instance zone, stable zone
+
+            dsp_slot(dsp* dsp):decorator_dsp(dsp) {}
+
+            void setControls()
+            {
+                for (size_t i = 0; i < fInputs.size(); i++) {
+                    *fInputs[i].second = *fInputs[i].first;
+                }
+            }
+
+            void getControls()
+            {
+                for (size_t i = 0; i < fOutputs.size(); i++) {
+                    *fOutputs[i].second = *fOutputs[i].first;
+                }
+            }
+
+            dsp* getDSP() { return fDSP; }
+        };
+
+        std::vector<uint64_t> fDescriptor;          // descriptor of the stable user interface, 8 bytes aligned
+        BinaryUIDecoder* fControls;                 // owns the stable zones
+        std::map<std::string, FAUSTFLOAT*> fStableZones;
+
+        dsp_slot* fCurrent;                         // same as fDSP
+        dsp_slot* fNext;                            // instance fading in
+        void* volatile fPending;                    // instance given by 'swap', not yet taken by the audio thread
+        dsp_slot* fZombie;                          // instance waiting for room in the reclaimer queue
+        dsp_reclaimer fReclaimer;
+
+        int fFade;
+        int fFadePos;
+        int fSampleRate;
+
+        std::vector<std::vector<FAUSTFLOAT> > fOldBuffer;
+        std::vector<std::vector<FAUSTFLOAT> > fNewBuffer;
+        std::vector<FAUSTFLOAT*> fInputs;
+        std::vector<FAUSTFLOAT*> fOldOutputs;
+        std::vector<FAUSTFLOAT*> fNewOutputs;
+
+        dsp_slot* createSlot(dsp* dsp)
+        {
+            dsp_slot* slot = new dsp_slot(dsp);
+            MapUI map;
+            dsp->buildUserInterface(&map);
+            std::map<std::string, FAUSTFLOAT*>::iterator it;
+            for (it = map.getMap().begin(); it != map.getMap().end(); it++) {
+                if (fStableZones.find((*it).first) != fStableZones.end()) {
+                    FAUSTFLOAT* stable = fStableZones[(*it).first];
+                    if (stable >= fControls->fOutControl && stable < fControls->fOutControl + fControls->fOutputItems) {
+                        slot->fOutputs.push_back(std::make_pair((*it).second, stable));
+                    } else {
+                        slot->fInputs.push_back(std::make_pair(stable, (*it).second));
+                    }
+                }
+            }
+            return slot;
+        }
+
+        void crossfade(int count, FAUSTFLOAT** inputs, FAUSTFLOAT** outputs)
+        {
+            int numInputs = int(fInputs.size());
+            int numOutputs = int(fOldOutputs.size());
+
+            for (int offset = 0; offset < count; offset += kChunkSize) {
+                int size = std::min(int(kChunkSize), count - offset);
+                for (int chan = 0; chan < numInputs; chan++) {
+                    fInputs[chan] = inputs[chan] + offset;
+                }
+                // Both instances read the inputs before the outputs are written (they may be the same buffers)
+                fCurrent->compute(size, &fInputs[0], &fOldOutputs[0]);
+                fNext->compute(size, &fInputs[0], &fNewOutputs[0]);
+                for (int chan = 0; chan < numOutputs; chan++) {
+                    FAUSTFLOAT* out = outputs[chan] + offset;
+                    FAUSTFLOAT* old_out = fOldOutputs[chan];
+                    FAUSTFLOAT* new_out = fNewOutputs[chan];
+                    for (int i = 0; i < size; i++) {
+                        FAUSTFLOAT gain = (fFadePos + i < fFade) ? FAUSTFLOAT(fFadePos + i) / FAUSTFLOAT(fFade) : FAUSTFLOAT(1);
+                        out[i] = old_out[i] + gain * (new_out[i] - old_out[i]);
+                    }
+                }
+                fFadePos += size;
+            }
+        }
+
+    public:
+
+        /**
+         * Constructor.
+         *
+         * @param dsp - the initial dsp. Beware : swap_dsp will use and finally delete the pointer.
+         * @param fade - the crossfade duration in samples
+         */
+        swap_dsp(dsp* dsp, int fade = 4096):fNext(0), fPending(0), fZombie(0), fFadePos(0), fSampleRate(0)
+        {
+            fFade = (fade > 0) ? fade : 1;
+
+            // Stable zones
+            BinaryUI builder(dsp->getNumInputs(), dsp->getNumOutputs());
+            dsp->buildUserInterface(&builder);
+            std::string descriptor = builder.binary();
+            fDescriptor.resize((descriptor.size() + 7) / 8);
+            memcpy(&fDescriptor[0], descriptor.data(), descriptor.size());
+            fControls = new BinaryUIDecoder((const char*)&fDescriptor[0], descriptor.size());
+            MapUI map;
+            fControls->buildUserInterface(&map);
+            fStableZones = map.getMap();
+
+            fCurrent = createSlot(dsp);
+            fDSP = fCurrent;
+
+            fInputs.resize(dsp->getNumInputs());
+            for (int chan = 0; chan < dsp->getNumOutputs(); chan++) {
+                fOldBuffer.push_back(std::vector<FAUSTFLOAT>(kChunkSize));
+                fNewBuffer.push_back(std::vector<FAUSTFLOAT>(kChunkSize));
+                fOldOutputs.push_back(&fOldBuffer[chan][0]);
+                fNewOutputs.push_back(&fNewBuffer[chan][0]);
+            }
+        }
+
+        virtual ~swap_dsp()
+        {
+            delete fNext;
+            delete fZombie;
+            delete (dsp_slot*)fPending;
+            delete fControls;
+        }
+
+        /**
+         * Replace the running DSP, to be called from a non real-time thread.
+         *
+         * @param dsp - the new dsp, with the same number of inputs and outputs. Beware : swap_dsp will use and finally delete the pointer.
+         * @param init - whether the new dsp has to be initialized at the current sample rate
+         * @return false if the dsp cannot replace the running one (it is then not used)
+         */
+        bool swap(dsp* dsp, bool init = true)
+        {
+            if (dsp->getNumInputs() != int(fInputs.size()) || dsp->getNumOutputs() != int(fOldOutputs.size())) {
+                return false;
+            }
+            if (init && fSampleRate > 0) {
+                dsp->init(fSampleRate);
+            }
+            // A previous instance not yet taken by the audio thread is never used
+            delete (dsp_slot*)atomicExchangePtr(&fPending, createSlot(dsp));
+            return true;
+        }
+
+        // Whether a replacement is pending or fading in
+        bool isSwapping() { return fPending || fNext; }
+
+        virtual void buildUserInterface(UI* ui_interface) { fControls->buildUserInterface(ui_interface); }
+
+        virtual void init(int samplingRate)
+        {
+            fSampleRate = samplingRate;
+            fDSP->init(samplingRate);
+        }
+
+        virtual void instanceInit(int samplingRate)
+        {
+            fSampleRate = samplingRate;
+            fDSP->instanceInit(samplingRate);
+        }
+
+        virtual void instanceResetUserInterface()
+        {
+            fCurrent->instanceResetUserInterface();
+            for (size_t i = 0; i < fCurrent->fInputs.size(); i++) {
+                *fCurrent->fInputs[i].first = *fCurrent->fInputs[i].second;
+            }
+        }
+
+        virtual swap_dsp* clone() { return new swap_dsp(fCurrent->getDSP()->clone(), fFade); }
+
+        virtual void compute(int count, FAUSTFLOAT** inputs, FAUSTFLOAT** outputs)
+        {
+            if (fZombie && fReclaimer.reclaim(fZombie)) {
+                fZombie = 0;
+            }
+
+            if (!fNext && !fZombie) {
+                fNext = (dsp_slot*)atomicExchangePtr(&fPending, 0);
+                fFadePos = 0;
+            }
+
+            fCurrent->setControls();
+
+            if (!fNext) {
+                fCurrent->compute(count, inputs, outputs);
+                fCurrent->getControls();
+                return;
+            }
+
+            fNext->setControls();
+            crossfade(count, inputs, outputs);
+            fNext->getControls();
+
+            if (fFadePos >= fFade) {
+                dsp_slot* old = fCurrent;
+                fDSP = fCurrent = fNext;
+                fNext = 0;
+                if (!fReclaimer.reclaim(old)) {
+                    fZombie = old;
+                }
+            }
+        }
+
+        virtual void compute(double date_usec, int count, FAUSTFLOAT** inputs, FAUSTFLOAT** outputs)
+        {
+            compute(count, inputs, outputs);
+        }
+
+};
+
+#endif
@@ -0,0 +1,452 @@
+/************************************************************************
+    FAUST Architecture File
+    Copyright (C) 2003-2017 GRAME, Centre National de Creation Musicale
+    ---------------------------------------------------------------------
+    This Architecture section is free software; you can redistribute it
+    and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3 of
+    the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; If not, see <http://www.gnu.org/licenses/>.
+
+    EXCEPTION : As a special exception, you may create a larger work
+    that contains this FAUST architecture section and distribute
+    that work under terms of your choice, so long as this FAUST
+    architecture section is not modified.
+
+
+ ************************************************************************
+ ************************************************************************/
+
+#ifndef FAUST_BINARYUI_H
+#define FAUST_BINARYUI_H
+
+#ifndef FAUSTFLOAT
+#define FAUSTFLOAT float
+#endif
+
+#include "faust/gui/UI.h"
+#include "faust/gui/meta.h"
+
+#include <vector>
+#include <map>
+#include <string>
+#include <string.h>
+#include <stdint.h>
+
+/*******************************************************************************
+ * Binary DSP descriptor
+ *
+ * A compact, versioned image of the information JSONUI produces: name, number
+ * of inputs/outputs, global metadata and the flat list of UI items. All
+ * sections are made of fixed size records laid out with their natural
+ * alignment, so that a descriptor loaded in memory (or mmap'ed from the '.fdesc'
+ * file written by 'faust -fdesc') is used in place after a single validation
+ * pass, without any parsing or string allocation.
+ *
+ *      BinaryUIHeader              64 bytes
+ *      BinaryUIItem[fNumItems]     48 bytes each (groups, 'close' and widgets)
+ *      BinaryUIMeta[fNumMeta]      8 bytes each (global meta first, then items meta)
+ *      strings                     '\0' terminated, referenced by offset
+ *
+ * The buffer given to the decoder must be 8 bytes aligned (malloc, new and
+ * mmap all guarantee it).
+ ******************************************************************************/
+
+#define FAUST_BINARYUI_MAGIC    "FDSC"
+#define FAUST_BINARYUI_VERSION  1
+#define FAUST_BINARYUI_ORDER    0x01020304
+
+enum {
+    kBinaryHGroup = 0, kBinaryVGroup, kBinaryTGroup, kBinaryClose,
+    kBinaryButton, kBinaryCheckButton, kBinaryVSlider, kBinaryHSlider, kBinaryNumEntry,
+    kBinaryHBargraph, kBinaryVBargraph
+};
+
+struct BinaryUIHeader {
+    char        fMagic[4];
+    uint32_t    fVersion;
+    uint32_t    fByteOrder;
+    uint32_t    fSize;          // total size of the descriptor in bytes
+    int32_t     fInputs;
+    int32_t     fOutputs;
+    uint32_t    fInputItems;    // number of buttons, checkboxes, sliders and entries
+    uint32_t    fOutputItems;   // number of bargraphs
+    uint32_t    fNumItems;
+    uint32_t    fNumMeta;       // global and items metadata
+    uint32_t    fNumGlobalMeta;
+    uint32_t    fName;          // offset in the strings section
+    uint32_t    fSHAKey;
+    uint32_t    fStringsSize;
+    uint32_t    fReserved[2];
+};
+
+struct BinaryUIItem {
+    uint16_t    fType;
+    uint16_t    fNumMeta;
+    uint32_t    fLabel;         // offset in the strings section
+    uint32_t    fMeta;          // index of the first item meta in the meta section
+    uint32_t    fIndex;         // index in the input or output controls
+    double      fInit;
+    double      fMin;
+    double      fMax;
+    double      fStep;
+};
+
+struct BinaryUIMeta {
+    uint32_t    fKey;
+    uint32_t    fValue;
+};
+
+/*******************************************************************************
+ * BinaryUI : Faust User Interface
+ * This class produces the binary descriptor of the DSP instance.
+ ******************************************************************************/
+
+class BinaryUI : public Meta, public UI
+{
+
+    protected:
+
+        std::vector<BinaryUIItem> fItems;
+        std::vector<BinaryUIMeta> fGlobalMeta;
+        std::vector<BinaryUIMeta> fItemMeta;
+        std::vector<BinaryUIMeta> fMetaAux;
+        std::string fStrings;
+        std::map<std::string, uint32_t> fStringsMap;
+        std::string fName;
+        std::string fSHAKey;
+        int fInputs, fOutputs;
+        uint32_t fInputItems, fOutputItems;
+
+        uint32_t addString(const std::string& str)
+        {
+            std::map<std::string, uint32_t>::iterator it = fStringsMap.find(str);
+            if (it != fStringsMap.end()) {
+                return (*it).second;
+            } else {
+                uint32_t offset = uint32_t(fStrings.size());
+                fStrings.append(str.c_str(), str.size() + 1);
+                fStringsMap[str] = offset;
+                return offset;
+            }
+        }
+
+        void addItem(int type, const char* label, FAUSTFLOAT init, FAUSTFLOAT min, FAUSTFLOAT max, FAUSTFLOAT step)
+        {
+            BinaryUIItem item;
+            item.fType = uint16_t(type);
+            item.fNumMeta = uint16_t(fMetaAux.size());
+            item.fLabel = addString(label);
+            item.fMeta = uint32_t(fItemMeta.size());
+            item.fInit = init;
+            item.fMin = min;
+            item.fMax = max;
+            item.fStep = step;
+            if (type >= kBinaryButton && type <= kBinaryNumEntry) {
+                item.fIndex = fInputItems++;
+            } else if (type == kBinaryHBargraph || type == kBinaryVBargraph) {
+                item.fIndex = fOutputItems++;
+            } else {
+                item.fIndex = 0;
+            }
+            fItemMeta.insert(fItemMeta.end(), fMetaAux.begin(), fMetaAux.end());
+            fMetaAux.clear();
+            fItems.push_back(item);
+        }
+
+        void init(const std::string& name, int inputs, int outputs, const std::string& sha_key)
+        {
+            fName = name;
+            fSHAKey = sha_key;
+            fInputs = inputs;
+            fOutputs = outputs;
+            fInputItems = 0;
+            fOutputItems = 0;
+        }
+
+    public:
+
+        BinaryUI(const std::string& name, int inputs, int outputs, const std::string& sha_key)
+        {
+            init(name, inputs, outputs, sha_key);
+        }
+
+        BinaryUI(int inputs, int outputs)
+        {
+            init("", inputs, outputs, "");
+        }
+
+        BinaryUI()
+        {
+            init("", -1, -1, "");
+        }
+
+        virtual ~BinaryUI() {}
+
+        // -- widget's layouts
+
+        virtual void openTabBox(const char* label) { addItem(kBinaryTGroup, label, 0, 0, 0, 0); }
+        virtual void openHorizontalBox(const char* label) { addItem(kBinaryHGroup, label, 0, 0, 0, 0); }
+        virtual void openVerticalBox(const char* label) { addItem(kBinaryVGroup, label, 0, 0, 0, 0); }
+        virtual void closeBox() { addItem(kBinaryClose, "", 0, 0, 0, 0); }
+
+        // -- active widgets
+
+        virtual void addButton(const char* label, FAUSTFLOAT* zone)
+        {
+            addItem(kBinaryButton, label, 0, 0, 1, 1);
+        }
+        virtual void addCheckButton(const char* label, FAUSTFLOAT* zone)
+        {
+            addItem(kBinaryCheckButton, label, 0, 0, 1, 1);
+        }
+        virtual void addVerticalSlider(const char* label, FAUSTFLOAT* zone, FAUSTFLOAT init, FAUSTFLOAT min, FAUSTFLOAT max, FAUSTFLOAT step)
+        {
+            addItem(kBinaryVSlider, label, init, min, max, step);
+        }
+        virtual void addHorizontalSlider(const char* label, FAUSTFLOAT* zone, FAUSTFLOAT init, FAUSTFLOAT min, FAUSTFLOAT max, FAUSTFLOAT step)
+        {
+            addItem(kBinaryHSlider, label, init, min, max, step);
+        }
+        virtual void addNumEntry(const char* label, FAUSTFLOAT* zone, FAUSTFLOAT init, FAUSTFLOAT min, FAUSTFLOAT max, FAUSTFLOAT step)
+        {
+            addItem(kBinaryNumEntry, label, init, min, max, step);
+        }
+
+        // -- passive widgets
+
+        virtual void addHorizontalBargraph(const char* label, FAUSTFLOAT* zone, FAUSTFLOAT min, FAUSTFLOAT max)
+        {
+            addItem(kBinaryHBargraph, label, 0, min, max, 0);
+        }
+        virtual void addVerticalBargraph(const char* label, FAUSTFLOAT* zone, FAUSTFLOAT min, FAUSTFLOAT max)
+        {
+            addItem(kBinaryVBargraph, label, 0, min, max, 0);
+        }
+
+        // -- metadata declarations
+
+        virtual void declare(FAUSTFLOAT* zone, const char* key, const char* val)
+        {
+            BinaryUIMeta meta = { addString(key), addString(val) };
+            fMetaAux.push_back(meta);
+        }
+
+        // Meta interface
+        virtual void declare(const char* key, const char* value)
+        {
+            if ((strcmp(key, "name") == 0) && (fName == "")) fName = value;
+            BinaryUIMeta meta = { addString(key), addString(value) };
+            fGlobalMeta.push_back(meta);
+        }
+
+        std::string binary()
+        {
+            BinaryUIHeader header;
+            memset(&header, 0, sizeof(header));
+            memcpy(header.fMagic, FAUST_BINARYUI_MAGIC, 4);
+            header.fVersion = FAUST_BINARYUI_VERSION;
+            header.fByteOrder = FAUST_BINARYUI_ORDER;
+            header.fInputs = fInputs;
+            header.fOutputs = fOutputs;
+            header.fInputItems = fInputItems;
+            header.fOutputItems = fOutputItems;
+            header.fNumItems = uint32_t(fItems.size());
+            header.fNumMeta = uint32_t(fGlobalMeta.size() + fItemMeta.size());
+            header.fNumGlobalMeta = uint32_t(fGlobalMeta.size());
+            header.fName = addString(fName);
+            header.fSHAKey = addString(fSHAKey);
+            header.fStringsSize = uint32_t(fStrings.size());
+            header.fSize = uint32_t(sizeof(BinaryUIHeader)
+                                    + fItems.size() * sizeof(BinaryUIItem)
+                                    + header.fNumMeta * sizeof(BinaryUIMeta)
+                                    + fStrings.size());
+
+            // Item metas are indexed after the global ones
+            std::vector<BinaryUIItem> items = fItems;
+            for (size_t i = 0; i < items.size(); i++) {
+                items[i].fMeta += header.fNumGlobalMeta;
+            }
+
+            std::string res;
+            res.reserve(header.fSize);
+            res.append((const char*)&header, sizeof(header));
+            if (items.size() > 0) res.append((const char*)&items[0], items.size() * sizeof(BinaryUIItem));
+            if (fGlobalMeta.size() > 0) res.append((const char*)&fGlobalMeta[0], fGlobalMeta.size() * sizeof(BinaryUIMeta));
+            if (fItemMeta.size() > 0) res.append((const char*)&fItemMeta[0], fItemMeta.size() * sizeof(BinaryUIMeta));
+            res.append(fStrings);
+            return res;
+        }
+
+};
+
+/*******************************************************************************
+ * BinaryUIDecoder : decodes a binary descriptor in place and implements
+ * 'metadata' and 'buildUserInterface'. The descriptor is not copied and has
+ * to stay valid as long as the decoder is used.
+ ******************************************************************************/
+
+struct BinaryUIDecoder {
+
+    const char* fData;
+    const BinaryUIHeader* fHeader;
+    const BinaryUIItem* fItems;
+    const BinaryUIMeta* fMeta;
+    const char* fStrings;
+
+    FAUSTFLOAT* fInControl;
+    FAUSTFLOAT* fOutControl;
+
+    int fNumInputs, fNumOutputs;
+    int fInputItems, fOutputItems;
+
+    static bool isValid(const char* data, size_t size)
+    {
+        if (!data || size < sizeof(BinaryUIHeader) || (uintptr_t(data) & 7)) return false;
+        const BinaryUIHeader* header = (const BinaryUIHeader*)data;
+        if (memcmp(header->fMagic, FAUST_BINARYUI_MAGIC, 4) != 0
+            || header->fVersion != FAUST_BINARYUI_VERSION
+            || header->fByteOrder != FAUST_BINARYUI_ORDER
+            || header->fSize > size
+            || header->fNumGlobalMeta > header->fNumMeta) {
+            return false;
+        }
+        uint64_t strings = sizeof(BinaryUIHeader)
+            + uint64_t(header->fNumItems) * sizeof(BinaryUIItem)
+            + uint64_t(header->fNumMeta) * sizeof(BinaryUIMeta);
+        if ((strings + header->fStringsSize != header->fSize)
+            || (header->fStringsSize == 0)
+            || (data[header->fSize - 1] != 0)
+            || (header->fName >= header->fStringsSize)
+            || (header->fSHAKey >= header->fStringsSize)) {
+            return false;
+        }
+        // Single pass over the records so that decoding never reads outside the buffer
+        const BinaryUIItem* items = (const BinaryUIItem*)(data + sizeof(BinaryUIHeader));
+        const BinaryUIMeta* meta = (const BinaryUIMeta*)(items + header->fNumItems);
+        for (uint32_t i = 0; i < header->fNumItems; i++) {
+            const BinaryUIItem& item = items[i];
+            if (item.fType > kBinaryVBargraph
+                || item.fLabel >= header->fStringsSize
+                || uint64_t(item.fMeta) + item.fNumMeta > header->fNumMeta
+                || (item.fType >= kBinaryButton && item.fType <= kBinaryNumEntry && item.fIndex >= header->fInputItems)
+                || (item.fType >= kBinaryHBargraph && item.fIndex >= header->fOutputItems)) {
+                return false;
+            }
+        }
+        for (uint32_t i = 0; i < header->fNumMeta; i++) {
+            if (meta[i].fKey >= header->fStringsSize || meta[i].fValue >= header->fStringsSize) return false;
+        }
+        return true;
+    }
+
+    BinaryUIDecoder(const char* data, size_t size)
+    {
+        fData = data;
+        if (isValid(data, size)) {
+            fHeader = (const BinaryUIHeader*)data;
+            fItems = (const BinaryUIItem*)(data + sizeof(BinaryUIHeader));
+            fMeta = (const BinaryUIMeta*)(fItems + fHeader->fNumItems);
+            fStrings = (const char*)(fMeta + fHeader->fNumMeta);
+            fNumInputs = fHeader->fInputs;
+            fNumOutputs = fHeader->fOutputs;
+            fInputItems = fHeader->fInputItems;
+            fOutputItems = fHeader->fOutputItems;
+        } else {
+            fHeader = 0;
+            fItems = 0;
+            fMeta = 0;
+            fStrings = "";
+            fNumInputs = fNumOutputs = -1;
+            fInputItems = fOutputItems = 0;
+        }
+        fInControl = new FAUSTFLOAT[fInputItems];
+        fOutControl = new FAUSTFLOAT[fOutputItems];
+    }
+
+    virtual ~BinaryUIDecoder()
+    {
+        delete [] fInControl;
+        delete [] fOutControl;
+    }
+
+    bool isValid() { return fHeader != 0; }
+
+    const char* getName() { return (fHeader) ? fStrings + fHeader->fName : ""; }
+    const char* getSHAKey() { return (fHeader) ? fStrings + fHeader->fSHAKey : ""; }
+
+    void metadata(Meta* m)
+    {
+        for (uint32_t i = 0; fHeader && i < fHeader->fNumGlobalMeta; i++) {
+            m->declare(fStrings + fMeta[i].fKey, fStrings + fMeta[i].fValue);
+        }
+    }
+
+    void buildUserInterface(UI* ui)
+    {
+        for (uint32_t i = 0; fHeader && i < fHeader->fNumItems; i++) {
+
+            const BinaryUIItem& item = fItems[i];
+            const char* label = fStrings + item.fLabel;
+            FAUSTFLOAT* zone = 0;
+
+            if (item.fType >= kBinaryButton && item.fType <= kBinaryNumEntry) {
+                zone = &fInControl[item.fIndex];
+                *zone = FAUSTFLOAT(item.fInit);
+            } else if (item.fType == kBinaryHBargraph || item.fType == kBinaryVBargraph) {
+                zone = &fOutControl[item.fIndex];
+                *zone = FAUSTFLOAT(item.fMin);
+            }
+
+            for (uint32_t j = item.fMeta; j < uint32_t(item.fMeta + item.fNumMeta); j++) {
+                ui->declare(zone, fStrings + fMeta[j].fKey, fStrings + fMeta[j].fValue);
+            }
+
+            switch (item.fType) {
+                case kBinaryHGroup:
+                    ui->openHorizontalBox(label);
+                    break;
+                case kBinaryVGroup:
+                    ui->openVerticalBox(label);
+                    break;
+                case kBinaryTGroup:
+                    ui->openTabBox(label);
+                    break;
+                case kBinaryClose:
+                    ui->closeBox();
+                    break;
+                case kBinaryButton:
+                    ui->addButton(label, zone);
+                    break;
+                case kBinaryCheckButton:
+                    ui->addCheckButton(label, zone);
+                    break;
+                case kBinaryVSlider:
+                    ui->addVerticalSlider(label, zone, item.fInit, item.fMin, item.fMax, item.fStep);
+                    break;
+                case kBinaryHSlider:
+                    ui->addHorizontalSlider(label, zone, item.fInit, item.fMin, item.fMax, item.fStep);
+                    break;
+                case kBinaryNumEntry:
+                    ui->addNumEntry(label, zone, item.fInit, item.fMin, item.fMax, item.fStep);
+                    break;
+                case kBinaryHBargraph:
+                    ui->addHorizontalBargraph(label, zone, item.fMin, item.fMax);
+                    break;
+                case kBinaryVBargraph:
+                    ui->addVerticalBargraph(label, zone, item.fMin, item.fMax);
+                    break;
+            }
+        }
+    }
+
+};
+
+#endif // FAUST_BINARYUI_H
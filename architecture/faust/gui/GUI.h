@@ -89,7 +89,7 @@ class GUI : public UI
             fZoneMap[z]->push_back(c);
         } 	
 
-        void updateAllZones();
+        virtual void updateAllZones();
         
         void updateZone(FAUSTFLOAT* z);
         
@@ -34,6 +34,9 @@
 #include <string>
 #include <utility>
 #include <iostream>
+#include <algorithm>
+#include <stdlib.h>
+#include <string.h>
 
 #include "faust/gui/GUI.h"
 #include "faust/midi/midi.h"
@@ -43,6 +46,8 @@
  * MidiUI : Faust User Interface
  * This class decodes MIDI meta data and maps incoming MIDI messages to them.
  * Currently "ctrl, keyon, keypress, pgm, chanpress, pitchwheel/pitchbend meta data is handled.
+ * An optional MIDI channel (0..15) can be given : [midi:ctrl 7 2], [midi:pitchwheel 2],
+ * otherwise the item responds to all channels.
  ******************************************************************************/
  
 class uiMidiItem : public uiItem {
@@ -388,18 +393,78 @@ class uiMidiKeyPress : public uiMidiItem
 
 class MapUI;
 
+/**
+ * Flat MIDI dispatch table : the items bound to each (channel, number) pair are
+ * stored contiguously, so that dispatching an incoming message costs two array
+ * reads whatever the number of bindings, without any lookup or allocation.
+ * Items declared without channel are bound to the 16 channels.
+ */
+template <class ITEM>
+class uiMidiTable {
+
+    private:
+    
+        int fNumbers;
+        std::vector<std::pair<int, ITEM*> > fBindings;  // (channel * fNumbers + number, item), in declaration order
+        std::vector<ITEM*> fItems;                       // items sorted by (channel, number)
+        std::vector<int> fStart;                         // items of (channel, number) are in [fStart[i], fStart[i+1][
+    
+        void rebuild()
+        {
+            std::fill(fStart.begin(), fStart.end(), 0);
+            for (size_t i = 0; i < fBindings.size(); i++) {
+                fStart[fBindings[i].first + 1]++;
+            }
+            for (size_t i = 1; i < fStart.size(); i++) {
+                fStart[i] += fStart[i-1];
+            }
+            fItems.resize(fBindings.size());
+            std::vector<int> pos(fStart.begin(), fStart.end() - 1);
+            for (size_t i = 0; i < fBindings.size(); i++) {
+                fItems[pos[fBindings[i].first]++] = fBindings[i].second;
+            }
+        }
+    
+    public:
+    
+        uiMidiTable(int numbers = 128):fNumbers(numbers), fStart(16 * numbers + 1, 0) {}
+    
+        // 'chan' = -1 to bind the item to all channels
+        void add(int chan, int num, ITEM* item)
+        {
+            if (num < 0 || num >= fNumbers || chan >= 16) return;
+            for (int c = ((chan < 0) ? 0 : chan); c < ((chan < 0) ? 16 : chan + 1); c++) {
+                fBindings.push_back(std::make_pair(c * fNumbers + num, item));
+            }
+            rebuild();
+        }
+    
+        bool empty() { return fBindings.empty(); }
+    
+        inline void modifyZone(int chan, int num, FAUSTFLOAT v)
+        {
+            if ((unsigned int)num < (unsigned int)fNumbers) {
+                int index = (chan & 15) * fNumbers + num;
+                for (int i = fStart[index]; i < fStart[index + 1]; i++) {
+                    fItems[i]->modifyZone(v);
+                }
+            }
+        }
+    
+};
+
 class MidiUI : public GUI, public midi
 {
 
     protected:
     
-        std::map <int, std::vector<uiMidiCtrlChange*> > fCtrlChangeTable;
-        std::map <int, std::vector<uiMidiProgChange*> > fProgChangeTable;
-        std::map <int, std::vector<uiMidiChanPress*> >  fChanPressTable;
-        std::map <int, std::vector<uiMidiKeyOn*> >      fKeyOnTable;
-        std::map <int, std::vector<uiMidiKeyOff*> >     fKeyOffTable;
-        std::map <int, std::vector<uiMidiKeyPress*> >   fKeyPressTable;
-        std::vector<uiMidiPitchWheel*>                  fPitchWheelTable;
+        uiMidiTable<uiMidiCtrlChange>   fCtrlChangeTable;
+        uiMidiTable<uiMidiProgChange>   fProgChangeTable;
+        uiMidiTable<uiMidiChanPress>    fChanPressTable;
+        uiMidiTable<uiMidiKeyOn>        fKeyOnTable;
+        uiMidiTable<uiMidiKeyOff>       fKeyOffTable;
+        uiMidiTable<uiMidiKeyPress>     fKeyPressTable;
+        uiMidiTable<uiMidiPitchWheel>   fPitchWheelTable;
         
         std::vector<uiMidiStart*>   fStartTable;
         std::vector<uiMidiStop*>    fStopTable;
@@ -408,34 +473,57 @@ class MidiUI : public GUI, public midi
         std::vector<std::pair <std::string, std::string> > fMetaAux;
         
         midi_handler* fMidiHandler;
+    
+        // Parse "<type> <num> [<chan>]" MIDI metadata, 'chan' is -1 when not given
+        static bool parseMidiMeta(const std::string& meta, const char* type, int& num, int& chan)
+        {
+            size_t len = strlen(type);
+            if (meta.compare(0, len, type) != 0 || meta.size() <= len || meta[len] != ' ') {
+                return false;
+            }
+            const char* p = meta.c_str() + len;
+            char* end;
+            long val = strtol(p, &end, 10);
+            if (end == p || val < 0) {
+                return false;
+            }
+            num = int(val);
+            p = end;
+            val = strtol(p, &end, 10);
+            chan = (end != p && val >= 0 && val < 16) ? int(val) : -1;
+            return true;
+        }
         
         void addGenericZone(FAUSTFLOAT* zone, FAUSTFLOAT min, FAUSTFLOAT max, bool input = true)
         {
             if (fMetaAux.size() > 0) {
                 for (size_t i = 0; i < fMetaAux.size(); i++) {
-                    unsigned num;
+                    int num, chan;
                     if (fMetaAux[i].first == "midi") {
-                        if (sscanf(fMetaAux[i].second.c_str(), "ctrl %u", &num) == 1) {
-                            fCtrlChangeTable[num].push_back(new uiMidiCtrlChange(fMidiHandler, num, this, zone, min, max, input));
-                        } else if (sscanf(fMetaAux[i].second.c_str(), "keyon %u", &num) == 1) {
-                            fKeyOnTable[num].push_back(new uiMidiKeyOn(fMidiHandler, num, this, zone, min, max, input));
-                        } else if (sscanf(fMetaAux[i].second.c_str(), "keyoff %u", &num) == 1) {
-                            fKeyOffTable[num].push_back(new uiMidiKeyOff(fMidiHandler, num, this, zone, min, max, input));
-                        } else if (sscanf(fMetaAux[i].second.c_str(), "keypress %u", &num) == 1) {
-                            fKeyPressTable[num].push_back(new uiMidiKeyPress(fMidiHandler, num, this, zone, min, max, input));
-                        } else if (sscanf(fMetaAux[i].second.c_str(), "pgm %u", &num) == 1) {
-                            fProgChangeTable[num].push_back(new uiMidiProgChange(fMidiHandler, num, this, zone, input));
-                        } else if (sscanf(fMetaAux[i].second.c_str(), "chanpress %u", &num) == 1) {
-                            fChanPressTable[num].push_back(new uiMidiChanPress(fMidiHandler, num, this, zone, input));
-                        } else if (strcmp(fMetaAux[i].second.c_str(), "pitchwheel") == 0 
-                            || strcmp(fMetaAux[i].second.c_str(), "pitchbend") == 0) {
-                            fPitchWheelTable.push_back(new uiMidiPitchWheel(fMidiHandler, this, zone, min, max, input));
+                        const std::string& meta = fMetaAux[i].second;
+                        if (parseMidiMeta(meta, "ctrl", num, chan)) {
+                            fCtrlChangeTable.add(chan, num, new uiMidiCtrlChange(fMidiHandler, num, this, zone, min, max, input));
+                        } else if (parseMidiMeta(meta, "keyon", num, chan)) {
+                            fKeyOnTable.add(chan, num, new uiMidiKeyOn(fMidiHandler, num, this, zone, min, max, input));
+                        } else if (parseMidiMeta(meta, "keyoff", num, chan)) {
+                            fKeyOffTable.add(chan, num, new uiMidiKeyOff(fMidiHandler, num, this, zone, min, max, input));
+                        } else if (parseMidiMeta(meta, "keypress", num, chan)) {
+                            fKeyPressTable.add(chan, num, new uiMidiKeyPress(fMidiHandler, num, this, zone, min, max, input));
+                        } else if (parseMidiMeta(meta, "pgm", num, chan)) {
+                            fProgChangeTable.add(chan, num, new uiMidiProgChange(fMidiHandler, num, this, zone, input));
+                        } else if (parseMidiMeta(meta, "chanpress", num, chan)) {
+                            fChanPressTable.add(chan, num, new uiMidiChanPress(fMidiHandler, num, this, zone, input));
+                        } else if (meta == "pitchwheel" || meta == "pitchbend") {
+                            fPitchWheelTable.add(-1, 0, new uiMidiPitchWheel(fMidiHandler, this, zone, min, max, input));
+                        } else if (parseMidiMeta(meta, "pitchwheel", num, chan) || parseMidiMeta(meta, "pitchbend", num, chan)) {
+                            // the channel is the only parameter
+                            fPitchWheelTable.add(num, 0, new uiMidiPitchWheel(fMidiHandler, this, zone, min, max, input));
                         // MIDI sync
-                        } else if (strcmp(fMetaAux[i].second.c_str(), "start") == 0) {
+                        } else if (meta == "start") {
                             fStartTable.push_back(new uiMidiStart(fMidiHandler, this, zone, input));
-                        } else if (strcmp(fMetaAux[i].second.c_str(), "stop") == 0) {
+                        } else if (meta == "stop") {
                             fStopTable.push_back(new uiMidiStop(fMidiHandler, this, zone, input));
-                        } else if (strcmp(fMetaAux[i].second.c_str(), "clock") == 0) {
+                        } else if (meta == "clock") {
                             fClockTable.push_back(new uiMidiClock(fMidiHandler, this, zone, input));
                         }
                     }
@@ -446,7 +534,7 @@ class MidiUI : public GUI, public midi
 
     public:
 
-        MidiUI(midi_handler* midi_handler)
+        MidiUI(midi_handler* midi_handler):fPitchWheelTable(1)
         {
             fMidiHandler = midi_handler;
             fMidiHandler->addMidiIn(this);
@@ -520,64 +608,38 @@ class MidiUI : public GUI, public midi
         
         MapUI* keyOn(double date, int channel, int note, int velocity)
         {
-            if (fKeyOnTable.find(note) != fKeyOnTable.end()) {
-                for (unsigned int i = 0; i < fKeyOnTable[note].size(); i++) {
-                    fKeyOnTable[note][i]->modifyZone(FAUSTFLOAT(velocity));
-                }
-            }
+            fKeyOnTable.modifyZone(channel, note, FAUSTFLOAT(velocity));
             return 0;
         }
         
         void keyOff(double date,  int channel, int note, int velocity)
         {
-            if (fKeyOffTable.find(note) != fKeyOffTable.end()) {
-                for (unsigned int i = 0; i < fKeyOffTable[note].size(); i++) {
-                    fKeyOffTable[note][i]->modifyZone(FAUSTFLOAT(velocity));
-                }
-            }
+            fKeyOffTable.modifyZone(channel, note, FAUSTFLOAT(velocity));
         }
            
         void ctrlChange(double date, int channel, int ctrl, int value)
         {
-            if (fCtrlChangeTable.find(ctrl) != fCtrlChangeTable.end()) {
-                for (unsigned int i = 0; i < fCtrlChangeTable[ctrl].size(); i++) {
-                    fCtrlChangeTable[ctrl][i]->modifyZone(FAUSTFLOAT(value));
-                }
-            } 
+            fCtrlChangeTable.modifyZone(channel, ctrl, FAUSTFLOAT(value));
         }
         
         void progChange(double date, int channel, int pgm)
         {
-            if (fProgChangeTable.find(pgm) != fProgChangeTable.end()) {
-                for (unsigned int i = 0; i < fProgChangeTable[pgm].size(); i++) {
-                    fProgChangeTable[pgm][i]->modifyZone(FAUSTFLOAT(1));
-                }
-            } 
+            fProgChangeTable.modifyZone(channel, pgm, FAUSTFLOAT(1));
         }
         
         void pitchWheel(double date, int channel, int wheel) 
         {
-            for (unsigned int i = 0; i < fPitchWheelTable.size(); i++) {
-                fPitchWheelTable[i]->modifyZone(FAUSTFLOAT(wheel));
-            }
+            fPitchWheelTable.modifyZone(channel, 0, FAUSTFLOAT(wheel));
         }
         
         void keyPress(double date, int channel, int pitch, int press) 
         {
-            if (fKeyPressTable.find(press) != fKeyPressTable.end()) {
-                for (unsigned int i = 0; i < fKeyPressTable[press].size(); i++) {
-                    fKeyPressTable[press][i]->modifyZone(FAUSTFLOAT(press));
-                }
-            } 
+            fKeyPressTable.modifyZone(channel, pitch, FAUSTFLOAT(press));
         }
         
         void chanPress(double date, int channel, int press)
         {
-            if (fChanPressTable.find(press) != fChanPressTable.end()) {
-                for (unsigned int i = 0; i < fChanPressTable[press].size(); i++) {
-                    fChanPressTable[press][i]->modifyZone(FAUSTFLOAT(1));
-                }
-            } 
+            fChanPressTable.modifyZone(channel, press, FAUSTFLOAT(1));
         }
         
         void ctrlChange14bits(double date, int channel, int ctrl, int value) {}
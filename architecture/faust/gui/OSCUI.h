@@ -158,6 +158,14 @@ class OSCUI : public GUI
 
 	virtual void show() {}
 
+	// the values transmitted during an update are grouped into OSC bundles (with the '-bundle 1' option)
+	virtual void updateAllZones()
+	{
+		fCtrl->beginUpdate();
+		GUI::updateAllZones();
+		fCtrl->endUpdate();
+	}
+
 	void run()
     {
         fCtrl->run(); 
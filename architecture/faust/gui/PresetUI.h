@@ -0,0 +1,351 @@
+/************************************************************************
+    FAUST Architecture File
+    Copyright (C) 2003-2017 GRAME, Centre National de Creation Musicale
+    ---------------------------------------------------------------------
+    This Architecture section is free software; you can redistribute it
+    and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3 of
+    the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; If not, see <http://www.gnu.org/licenses/>.
+
+    EXCEPTION : As a special exception, you may create a larger work
+    that contains this FAUST architecture section and distribute
+    that work under terms of your choice, so long as this FAUST
+    architecture section is not modified.
+
+
+ ************************************************************************
+ ************************************************************************/
+
+#ifndef FAUST_PRESETUI_H
+#define FAUST_PRESETUI_H
+
+#include "faust/gui/FUI.h"
+
+#include <vector>
+#include <map>
+#include <string>
+#include <algorithm>
+#include <iostream>
+#include <fstream>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+/*******************************************************************************
+ * Lock-free triple buffer : the writer fills 'back()' then calls 'publish()',
+ * the reader calls 'update()' then uses 'front()'. Neither side ever waits,
+ * and the reader always gets a complete value (the last published one).
+ ******************************************************************************/
+
+inline int atomicExchange(volatile int* ptr, int value)
+{
+#ifdef _WIN32
+    return InterlockedExchange((volatile LONG*)ptr, value);
+#else
+    return __atomic_exchange_n(ptr, value, __ATOMIC_ACQ_REL);
+#endif
+}
+
+inline int atomicLoad(volatile int* ptr)
+{
+#ifdef _WIN32
+    return *ptr;
+#else
+    return __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+#endif
+}
+
+template <class T>
+class triple_buffer {
+
+    private:
+
+        enum { kDirty = 4, kMask = 3 };
+
+        T fBuffers[3];
+        volatile int fMiddle;
+        int fBack;
+        int fFront;
+
+    public:
+
+        triple_buffer():fMiddle(1), fBack(0), fFront(2) {}
+
+        // Writer side
+        T& back() { return fBuffers[fBack]; }
+        void publish() { fBack = atomicExchange(&fMiddle, fBack | kDirty) & kMask; }
+
+        // Reader side, returns true when a new value has been published since the last call
+        bool update()
+        {
+            if (atomicLoad(&fMiddle) & kDirty) {
+                fFront = atomicExchange(&fMiddle, fFront) & kMask;
+                return true;
+            } else {
+                return false;
+            }
+        }
+        T& front() { return fBuffers[fFront]; }
+
+};
+
+/*******************************************************************************
+ * PresetUI : in-memory preset bank with atomic recall and morphing
+ *
+ * Presets are vectors of the values of all active controls (except buttons).
+ * Storing, recalling and morphing are done from the UI thread and never
+ * touch the zones : they publish a new bank or new morphing weights, which
+ * the audio thread picks up in 'process()', called at a block boundary before
+ * 'compute' (see preset_dsp in faust/dsp/preset-dsp.h). All controls of a
+ * preset are thus changed between two blocks.
+ *
+ * Morphing mixes the N presets of the bank with N weights, computed as N
+ * multiply-add passes over contiguous arrays that the compiler vectorizes.
+ * The controls can then be moved from their current values to the mix over
+ * several blocks.
+ ******************************************************************************/
+
+class PresetUI : public FUI
+{
+
+    protected:
+
+        struct Bank {
+            std::vector<std::vector<FAUSTFLOAT> > fPresets;    // the 'recallState' values, then the stored presets
+            std::vector<FAUSTFLOAT> fFrom;                      // values at the beginning of a ramp
+            std::vector<FAUSTFLOAT> fTarget;                    // mixed presets
+        };
+
+        struct Morph {
+            std::vector<FAUSTFLOAT> fWeights;
+            int fBlocks;
+        };
+
+        // UI thread state
+        std::vector<FAUSTFLOAT*> fZones;
+        std::map<FAUSTFLOAT*, int> fZoneIndex;
+        std::vector<std::vector<FAUSTFLOAT> > fPresets;
+        std::vector<FAUSTFLOAT> fFileState;
+        int fMorphBlocks;
+
+        // Shared between the UI and audio threads
+        triple_buffer<Bank> fBank;
+        triple_buffer<Morph> fMorph;
+
+        // Audio thread state
+        int fBlocks;
+        int fRemaining;
+        bool fPending;
+
+        virtual void addElement(const char* label, FAUSTFLOAT* zone, bool button = false)
+        {
+            FUI::addElement(label, zone, button);
+            if (!button) {
+                fZoneIndex[zone] = int(fZones.size());
+                fZones.push_back(zone);
+            }
+        }
+
+        void snapshot(std::vector<FAUSTFLOAT>& values)
+        {
+            values.resize(fZones.size());
+            for (size_t i = 0; i < fZones.size(); i++) {
+                values[i] = *fZones[i];
+            }
+        }
+
+        // Copies the bank with the 'recallState' values as first preset, so that
+        // the indexes of the stored presets are kept when new ones are added
+        void publishBank()
+        {
+            Bank& bank = fBank.back();
+            bank.fPresets.resize(fPresets.size() + 1);
+            bank.fPresets[0] = fFileState;
+            std::copy(fPresets.begin(), fPresets.end(), bank.fPresets.begin() + 1);
+            bank.fFrom.resize(fZones.size());
+            bank.fTarget.resize(fZones.size());
+            fBank.publish();
+        }
+
+        // 'weights' start with the one of the 'recallState' values
+        void publishMorph(const FAUSTFLOAT* weights, int count, int blocks)
+        {
+            Morph& morph = fMorph.back();
+            morph.fWeights.assign(fPresets.size() + 1, FAUSTFLOAT(0));
+            FAUSTFLOAT sum = 0;
+            for (int i = 0; i < count && i < int(morph.fWeights.size()); i++) {
+                morph.fWeights[i] = weights[i];
+                sum += weights[i];
+            }
+            if (sum > 0) {
+                for (size_t i = 0; i < morph.fWeights.size(); i++) {
+                    morph.fWeights[i] /= sum;
+                }
+            }
+            morph.fBlocks = blocks;
+            fMorph.publish();
+        }
+
+        void publishRecall(int index)
+        {
+            std::vector<FAUSTFLOAT> weights(fPresets.size() + 1, FAUSTFLOAT(0));
+            weights[index] = 1;
+            publishMorph(&weights[0], int(weights.size()), 0);
+        }
+
+        // Mix all presets with the morph weights in the target values
+        void mix(Bank& bank, const Morph& morph)
+        {
+            int size = int(fZones.size());
+            FAUSTFLOAT* out = &bank.fTarget[0];
+
+            for (int i = 0; i < size; i++) {
+                out[i] = 0;
+            }
+            // Weights of presets stored after the morph was published are 0,
+            // those of presets removed in the meantime are ignored
+            size_t presets = std::min(bank.fPresets.size(), morph.fWeights.size());
+            for (size_t k = 0; k < presets; k++) {
+                FAUSTFLOAT w = morph.fWeights[k];
+                if (w == 0 || bank.fPresets[k].size() != size_t(size)) continue;
+                const FAUSTFLOAT* in = &bank.fPresets[k][0];
+                for (int i = 0; i < size; i++) {
+                    out[i] += w * in[i];
+                }
+            }
+        }
+
+    public:
+
+        PresetUI():fMorphBlocks(0), fBlocks(0), fRemaining(0), fPending(false) {}
+        virtual ~PresetUI() {}
+
+        // -- UI thread methods, to be called once 'buildUserInterface' is done
+
+        int getNumPresets() { return int(fPresets.size()); }
+
+        // Store the current values in preset 'index' (-1 to add a new one), returns the preset index
+        int storePreset(int index = -1)
+        {
+            if (index < 0 || index > int(fPresets.size())) index = int(fPresets.size());
+            if (index == int(fPresets.size())) fPresets.push_back(std::vector<FAUSTFLOAT>());
+            snapshot(fPresets[index]);
+            if (fFileState.size() != fZones.size()) snapshot(fFileState);
+            publishBank();
+            return index;
+        }
+
+        bool removePreset(int index)
+        {
+            if (index < 0 || index >= int(fPresets.size())) return false;
+            fPresets.erase(fPresets.begin() + index);
+            publishBank();
+            return true;
+        }
+
+        // Values of preset 'index', in the order of the controls
+        const std::vector<FAUSTFLOAT>& getPreset(int index) { return fPresets[index]; }
+
+        bool recallPreset(int index)
+        {
+            if (index < 0 || index >= int(fPresets.size())) return false;
+            publishRecall(index + 1);
+            return true;
+        }
+
+        // Number of blocks used by 'morph' to go from the current values to the new ones
+        void setMorphBlocks(int blocks) { fMorphBlocks = (blocks > 0) ? blocks : 0; }
+
+        // Mix the presets with 'weights' (normalized so that their sum is 1)
+        bool morph(const FAUSTFLOAT* weights, int count)
+        {
+            if (fPresets.size() == 0) return false;
+            std::vector<FAUSTFLOAT> all(fPresets.size() + 1, FAUSTFLOAT(0));
+            for (int i = 0; i < count && i < int(fPresets.size()); i++) {
+                all[i + 1] = weights[i];
+            }
+            publishMorph(&all[0], int(all.size()), fMorphBlocks);
+            return true;
+        }
+
+        bool morph(const std::vector<FAUSTFLOAT>& weights)
+        {
+            return (weights.size() > 0) ? morph(&weights[0], int(weights.size())) : false;
+        }
+
+        // Recall a state saved with 'saveState', all values are applied at the same block boundary
+        virtual void recallState(const char* filename)
+        {
+            std::ifstream f(filename);
+            FAUSTFLOAT v;
+            std::string n;
+
+            snapshot(fFileState);
+            while (f.good()) {
+                f >> v >> n;
+                if (fName2Zone.count(n) > 0) {
+                    FAUSTFLOAT* zone = fName2Zone[n];
+                    if (fZoneIndex.count(zone) > 0) fFileState[fZoneIndex[zone]] = v;
+                } else if (n.size() > 0) {
+                    std::cerr << "recallState : parameter not found : " << n << " with value : " << v << std::endl;
+                }
+            }
+            f.close();
+            publishBank();
+            publishRecall(0);
+        }
+
+        // -- Audio thread method, to be called at block boundaries
+
+        void process()
+        {
+            // The weights are checked before the bank, which is published first : the bank is at least as recent
+            if (fMorph.update()) fPending = true;
+            // A ramp in progress restarts from the current values with the new bank
+            if (fBank.update() && fRemaining > 0) fPending = true;
+
+            Bank& bank = fBank.front();
+            int size = int(fZones.size());
+            if (size == 0 || int(bank.fTarget.size()) != size) return;
+
+            if (fPending) {
+                Morph& morph = fMorph.front();
+                fPending = false;
+                mix(bank, morph);
+                if (morph.fBlocks > 0) {
+                    for (int i = 0; i < size; i++) {
+                        bank.fFrom[i] = *fZones[i];
+                    }
+                    fBlocks = fRemaining = morph.fBlocks;
+                } else {
+                    fRemaining = 0;
+                    for (int i = 0; i < size; i++) {
+                        *fZones[i] = bank.fTarget[i];
+                    }
+                    return;
+                }
+            }
+
+            if (fRemaining > 0) {
+                fRemaining--;
+                FAUSTFLOAT t = FAUSTFLOAT(fBlocks - fRemaining) / FAUSTFLOAT(fBlocks);
+                const FAUSTFLOAT* from = &bank.fFrom[0];
+                const FAUSTFLOAT* target = &bank.fTarget[0];
+                for (int i = 0; i < size; i++) {
+                    *fZones[i] = (fRemaining == 0) ? target[i] : from[i] + t * (target[i] - from[i]);
+                }
+            }
+        }
+
+};
+
+#endif // FAUST_PRESETUI_H
@@ -404,12 +404,15 @@ static bool parseUI(const char*& p, std::vector<itemInfo*>& uiItems, int& numIte
                 
                 else if (label == "items") {
                     if (parseChar(p, ':') && parseChar(p, '[')) {
-                        do { 
+                        // an empty group is still closed
+                        bool empty = tryChar(p, ']');
+                        while (!empty) {
                             if (!parseUI(p, uiItems, numItems)) {
                                 return false;
                             }
-                        } while (tryChar(p, ','));
-                        if (parseChar(p, ']')) {
+                            if (!tryChar(p, ',')) break;
+                        }
+                        if (empty || parseChar(p, ']')) {
                             itemInfo* item = new itemInfo;
                             item->type = "close";
                             uiItems.push_back(item);
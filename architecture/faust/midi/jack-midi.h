@@ -60,20 +60,8 @@ class jack_midi_handler : public midi_handler {
             for (int i = 0; i < jack_midi_get_event_count(port_buf_in); ++i) {
                 jack_midi_event_t event;
                 if (jack_midi_event_get(&event, port_buf_in, i) == 0) {
-
-                    size_t nBytes = event.size;
-                    int type = (int)event.buffer[0] & 0xf0;
-                    int channel = (int)event.buffer[0] & 0x0f;
-                    double time = event.time; // Timestamp in frames
-
-                    // MIDI sync
-                    if (nBytes == 1) {
-                        handleSync(time, (int)event.buffer[0]);
-                    } else if (nBytes == 2) {
-                        handleData1(time, type, channel, (int)event.buffer[1]);
-                    } else if (nBytes == 3) {
-                        handleData2(time, type, channel, (int)event.buffer[1], (int)event.buffer[2]);
-                    }
+                    // Timestamp in frames
+                    handleBuffer(event.time, event.buffer, event.size);
                 }
             }
         }
@@ -133,10 +133,15 @@ class midi_handler : public midi {
 
         std::vector<midi*> fMidiInputs;
         std::string fName;
+    
+        // state of the byte stream parser (see handleBuffer)
+        int fRunningStatus;
+        int fData[2];
+        int fDataCount;
 
     public:
 
-        midi_handler(const std::string& name = "MIDIHandler"):fName(name) {}
+        midi_handler(const std::string& name = "MIDIHandler"):fName(name), fRunningStatus(0), fDataCount(0) {}
         virtual ~midi_handler() {}
 
         virtual void addMidiIn(midi* midi_dsp) { fMidiInputs.push_back(midi_dsp); }
@@ -205,6 +210,41 @@ class midi_handler : public midi {
                 }
             }
         }
+    
+        /**
+         * Decode a raw MIDI byte stream (possibly several messages, using running
+         * status, with interleaved real-time messages) and dispatch each complete
+         * message. The parser state is kept between calls, so messages can be split
+         * between two buffers. System exclusive and other system common messages are skipped.
+         */
+        void handleBuffer(double time, const unsigned char* buffer, size_t size)
+        {
+            for (size_t i = 0; i < size; i++) {
+                int byte = buffer[i];
+                if (byte >= 0xF8) {
+                    // real-time messages do not change the running status
+                    handleSync(time, byte);
+                } else if (byte >= 0xF0) {
+                    // system common and exclusive : data bytes are ignored until the next status
+                    fRunningStatus = 0;
+                    fDataCount = 0;
+                } else if (byte & 0x80) {
+                    fRunningStatus = byte;
+                    fDataCount = 0;
+                } else if (fRunningStatus) {
+                    fData[fDataCount++] = byte;
+                    int type = fRunningStatus & 0xf0;
+                    int channel = fRunningStatus & 0x0f;
+                    if (type == MIDI_PROGRAM_CHANGE || type == MIDI_AFTERTOUCH) {
+                        handleData1(time, type, channel, fData[0]);
+                        fDataCount = 0;
+                    } else if (fDataCount == 2) {
+                        handleData2(time, type, channel, fData[0], fData[1]);
+                        fDataCount = 0;
+                    }
+                }
+            }
+        }
 
 
 };
@@ -43,18 +43,9 @@ class rt_midi : public midi_handler {
         static void midiCallback(double time, std::vector<unsigned char>* message, void* arg)
         {
             rt_midi* midi = static_cast<rt_midi*>(arg);
-            unsigned int nBytes = message->size();
-            int type = (int)message->at(0) & 0xf0;
-            int channel = (int)message->at(0) & 0x0f;
-            
-            // MIDI sync
-            if (nBytes == 1) {
-                midi->handleSync(time, (int)message->at(0));
-            } else if (nBytes == 2) {
-                midi->handleData1(time, type, channel, (int)message->at(1));
-            } else if (nBytes == 3) {
-                midi->handleData2(time, type, channel, (int)message->at(1), (int)message->at(2));
-            } 
+            if (message->size() > 0) {
+                midi->handleBuffer(time, &(*message)[0], message->size());
+            }
         }
         
         bool openMidiInputPorts()
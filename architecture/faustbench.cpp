@@ -0,0 +1,101 @@
+/************************************************************************
+ IMPORTANT NOTE : this file contains two clearly delimited sections :
+ the ARCHITECTURE section (in two parts) and the USER section. Each section
+ is governed by its own copyright and license. Please check individually
+ each section for license and copyright information.
+ *************************************************************************/
+
+/*******************BEGIN ARCHITECTURE SECTION (part 1/2)****************/
+
+/************************************************************************
+ FAUST Architecture File
+ Copyright (C) 2016 GRAME, Centre National de Creation Musicale
+ ---------------------------------------------------------------------
+ This Architecture section is free software; you can redistribute it
+ and/or modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 3 of
+ the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; If not, see <http://www.gnu.org/licenses/>.
+
+ EXCEPTION : As a special exception, you may create a larger work
+ that contains this FAUST architecture section and distribute
+ that work under terms of your choice, so long as this FAUST
+ architecture section is not modified.
+
+ ************************************************************************
+ ************************************************************************/
+
+/*
+    Headless benchmark architecture, used by the 'faustbench' script to
+    autotune the compilation options of a DSP. The generated class is
+    measured offline with 'measure_dsp' (no audio driver, no GUI) and
+    the best throughput (in MB/s) is printed on a single line so that
+    it can be easily collected by scripts.
+
+    Options :
+        --frequency <n> : sample rate given to 'init' (default 44100)
+        --buffer <n>    : buffer size given to 'compute' (default 512)
+        --count <n>     : number of measured 'compute' calls (default 1000)
+        --skip <n>      : number of initial calls not taken into account (default 20)
+*/
+
+#include <math.h>
+#include <algorithm>
+#include <iostream>
+
+#include "faust/gui/UI.h"
+#include "faust/gui/meta.h"
+#include "faust/dsp/dsp-bench.h"
+#include "faust/misc.h"
+
+using namespace std;
+
+<<includeIntrinsic>>
+
+/********************END ARCHITECTURE SECTION (part 1/2)****************/
+
+/**************************BEGIN USER SECTION **************************/
+
+<<includeclass>>
+
+/***************************END USER SECTION ***************************/
+
+/*******************BEGIN ARCHITECTURE SECTION (part 2/2)***************/
+
+//-------------------------------------------------------------------------
+// 									MAIN
+//-------------------------------------------------------------------------
+
+int main(int argc, char *argv[])
+{
+    int srate = (int)lopt(argv, "--frequency", 44100);
+    int fpb = (int)lopt(argv, "--buffer", 512);
+    int count = (int)lopt(argv, "--count", 1000);
+    int skip = (int)lopt(argv, "--skip", 20);
+
+    mydsp* DSP = new mydsp();
+    DSP->init(srate);
+    measure_dsp* dsp = new measure_dsp(DSP, fpb, count, skip);
+
+    // Measuring DSP...
+    dsp->measure();
+
+    if (isopt(argv, "--stats")) {
+        dsp->printStats(argv[0]);
+    } else {
+        cout << dsp->getStats() << endl;
+    }
+
+    delete dsp;
+    return 0;
+}
+
+/********************END ARCHITECTURE SECTION (part 2/2)****************/
+
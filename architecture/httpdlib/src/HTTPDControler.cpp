@@ -45,15 +45,16 @@ using namespace std;
 namespace httpdfaust
 {
 
-#define kVersion	 0.73f
-#define kVersionStr	"0.73"
+#define kVersion	 0.74f
+#define kVersionStr	"0.74"
 
 static const char* kPortOpt	= "-port";
+static const char* kThreadsOpt	= "-httpdthreads";
 
 //--------------------------------------------------------------------------
 // utility for command line arguments 
 //--------------------------------------------------------------------------
-static int getPortOption(int argc, char *argv[], const std::string& option, int defaultValue)
+static int getIntOption(int argc, char *argv[], const std::string& option, int defaultValue)
 {
 	for (int i = 0; i < argc-1; i++) {
 		if (option == argv[i]) {
@@ -88,9 +89,10 @@ static bool getNetInfos(string& name, string& ip)
 
 //--------------------------------------------------------------------------
 HTTPDControler::HTTPDControler(int argc, char *argv[], const char* applicationname, bool init)
-	: fTCPPort(kTCPBasePort), fJson(0), fInit(init)
+	: fTCPPort(kTCPBasePort), fThreads(0), fJson(0), fInit(init)
 {
-	fTCPPort = getPortOption(argc, argv, kPortOpt, fTCPPort);
+	fTCPPort = getIntOption(argc, argv, kPortOpt, fTCPPort);
+	fThreads = getIntOption(argc, argv, kThreadsOpt, fThreads);
 	fFactory = new FaustFactory();
 	fHttpd = new HTTPDSetup();
 	
@@ -187,7 +189,7 @@ void HTTPDControler::run()
 		// and cast it to a RootNode
 		RootNode * rootnode = dynamic_cast<RootNode*>((MessageDriven*)root);
 		// starts the network services
-		if (fHttpd->start(root, fTCPPort)) {
+		if (fHttpd->start(root, fTCPPort, fThreads)) {
             fJson->root().setPort(fTCPPort);
             string json = fJson->root().json();  // fJson->root().json(true); to 'flatten' JSON 
             if (rootnode) rootnode->setJSON(json);
@@ -45,6 +45,14 @@ namespace httpdfaust
 
 #define kPortsScanRange		1000		// scan this number of TCP ports to find a free one (in case of busy port)
 
+#if MHD_VERSION >= 0x00093400
+#define kSuspendResume		1						// the connections may be suspended (long polling)
+#define kSuspendFlag		MHD_USE_SUSPEND_RESUME
+#else
+#define kSuspendResume		0						// the pending messages are answered immediately
+#define kSuspendFlag		0
+#endif
+
 //--------------------------------------------------------------------------
 // static functions
 // provided as callbacks to mhttpd
@@ -56,6 +64,25 @@ static int _answer_to_connection (void *cls, struct MHD_Connection *connection,
 	return server->answer(connection, url, method, version, upload_data, upload_data_size, con_cls); 
 }
 
+//--------------------------------------------------------------------------
+// called when a request is completed: frees its waiting deadline
+static void _request_completed (void *cls, struct MHD_Connection *connection, void **con_cls, enum MHD_RequestTerminationCode toe)
+{
+	delete (double*)*con_cls;
+	*con_cls = 0;
+}
+
+#ifdef _WIN32
+static DWORD WINAPI _resume (void *cls)
+#else
+static void* _resume (void *cls)
+#endif
+{
+	HTTPDServer* server = (HTTPDServer*)cls;
+	server->resumeLoop();
+	return 0;
+}
+
 // Convert string to float. Accepts both . and , as decimal point
 // Syntax is : [ ]*[+|-]n*(.|,)n*
 static float mystrtof(const char* str, const char** endptr)
@@ -106,17 +133,133 @@ static int _get_params (void *cls, enum MHD_ValueKind kind, const char *key, con
 // the http server
 //--------------------------------------------------------------------------
 HTTPDServer::HTTPDServer(MessageProcessor* mp)
-	: fProcessor(mp), fServer(0), fDebug(false)
+	: fProcessor(mp), fServer(0), fDebug(false), fRunning(false), fResuming(false)
 {
 }
 
 HTTPDServer::~HTTPDServer() { stop(); }
 
 //--------------------------------------------------------------------------
-bool HTTPDServer::start(int port)
+bool HTTPDServer::start(int port, int threads)
+{
+	unsigned int flags = MHD_USE_SELECT_INTERNALLY | kSuspendFlag;
+	if (threads > 0) {
+#if defined(__linux__) && (MHD_VERSION >= 0x00093300)
+		flags |= MHD_USE_EPOLL_LINUX_ONLY;
+#endif
+		fServer = MHD_start_daemon (flags, port, NULL, NULL, _answer_to_connection, this, 
+									MHD_OPTION_NOTIFY_COMPLETED, _request_completed, this,
+									MHD_OPTION_THREAD_POOL_SIZE, (unsigned int)threads, MHD_OPTION_END);
+	}
+	else fServer = MHD_start_daemon (flags, port, NULL, NULL, _answer_to_connection, this,
+									MHD_OPTION_NOTIFY_COMPLETED, _request_completed, this, MHD_OPTION_END);
+	if (!fServer) return false;
+
+	TLock lock(fSuspendMutex);
+	fRunning = true;
+#if kSuspendResume
+#ifdef _WIN32
+	fResumeThread = CreateThread (NULL, 0, _resume, this, 0, NULL);
+	fResuming = (fResumeThread != NULL);
+#else
+	fResuming = (pthread_create (&fResumeThread, NULL, _resume, this) == 0);
+#endif
+#endif
+	fRunning = fResuming;		// no connection is suspended without the resume thread
+	return true;
+}
+
+//--------------------------------------------------------------------------
+void HTTPDServer::stop ()
+{
+	if (fServer) {
+		stopResume();
+		MHD_stop_daemon (fServer);
+		fServer = 0;
+	}
+	clearCache();
+}
+
+//--------------------------------------------------------------------------
+// the suspended connections must be resumed before the daemon is stopped
+void HTTPDServer::stopResume ()
+{
+	{
+		TLock lock(fSuspendMutex);
+		fRunning = false;
+	}
+	if (fResuming) {
+#ifdef _WIN32
+		WaitForSingleObject (fResumeThread, INFINITE);
+		CloseHandle (fResumeThread);
+#else
+		pthread_join (fResumeThread, NULL);
+#endif
+		fResuming = false;
+	}
+	resumeAll();
+}
+
+//--------------------------------------------------------------------------
+void HTTPDServer::resumeLoop ()
+{
+	do {
+		msleep (kResumePeriod);
+	} while (resumeAll());
+}
+
+//--------------------------------------------------------------------------
+// the resumed connections process their request again
+bool HTTPDServer::resumeAll ()
 {
-	fServer = MHD_start_daemon (MHD_USE_SELECT_INTERNALLY, port, NULL, NULL, _answer_to_connection, this, MHD_OPTION_END);
-	return fServer != 0;
+	TLock lock(fSuspendMutex);
+#if kSuspendResume
+	for (unsigned int i=0; i<fSuspended.size(); i++)
+		MHD_resume_connection (fSuspended[i]);
+#endif
+	fSuspended.clear();
+	return fRunning;
+}
+
+//--------------------------------------------------------------------------
+// suspends the connection while the message is pending and its waiting time
+// is not over, the deadline is kept with the request (con_cls)
+bool HTTPDServer::suspend (struct MHD_Connection *connection, const Message* msg, void **con_cls)
+{
+	if (!msg->pending()) return false;
+	double now = mstime();
+	double* deadline = (double*)*con_cls;
+	if (!deadline) *con_cls = deadline = new double(now + msg->pending());
+	if (now >= *deadline) return false;
+
+	TLock lock(fSuspendMutex);
+	if (!fRunning) return false;
+#if kSuspendResume
+	MHD_suspend_connection (connection);
+#endif
+	fSuspended.push_back(connection);
+	return true;
+}
+
+//--------------------------------------------------------------------------
+// the cached responses are reference counted by libmicrohttpd: they can be
+// queued on several connections at the same time
+int HTTPDServer::sendCached (struct MHD_Connection *connection, const char* url)
+{
+	TLock lock(fCacheMutex);
+	map<string, struct MHD_Response*>::const_iterator i = fCache.find(url);
+	if (i == fCache.end()) return MHD_NO;
+	return MHD_queue_response (connection, MHD_HTTP_OK, i->second);
+}
+
+//--------------------------------------------------------------------------
+void HTTPDServer::clearCache ()
+{
+	TLock lock(fCacheMutex);
+	for (map<string, struct MHD_Response*>::iterator i = fCache.begin(); i != fCache.end(); i++) {
+		MHD_destroy_response (i->second);
+	}
+	fCache.clear();
 }
 
 //--------------------------------------------------------------------------
@@ -177,8 +320,29 @@ int HTTPDServer::page (struct MHD_Connection *connection, const char * page)
 }
 
 //--------------------------------------------------------------------------
-int HTTPDServer::send (struct MHD_Connection *connection, std::vector<Message*> msgs)
+int HTTPDServer::send (struct MHD_Connection *connection, std::vector<Message*> msgs, const char* url)
 {
+	if (url && (msgs.size() == 1) && msgs[0]->cacheable()) {
+		stringstream page;
+		msgs[0]->print(page);
+		page << endl;
+		string mime = msgs[0]->mimetype();
+		delete msgs[0];
+		string content = page.str();
+		struct MHD_Response *response = MHD_create_response_from_buffer (content.size(), (void *)content.c_str(), MHD_RESPMEM_MUST_COPY);
+		if (!response) {
+			cerr << "MHD_create_response_from_buffer error: null response\n";
+			return MHD_NO;
+		}
+		MHD_add_response_header (response, "Content-Type", mime.c_str());
+		MHD_add_response_header (response, "Access-Control-Allow-Origin", "*");
+		int ret = MHD_queue_response (connection, MHD_HTTP_OK, response);
+		TLock lock(fCacheMutex);
+		if (fCache.find(url) == fCache.end()) fCache[url] = response;	// the cache keeps the response reference
+		else MHD_destroy_response (response);
+		return ret;
+	}
+
 	stringstream page;
 	string mime;
 	for (unsigned int i=0; i<msgs.size(); i++) {
@@ -211,6 +375,10 @@ int HTTPDServer::answer (struct MHD_Connection *connection, const char *url, con
 		return send (connection, msg.c_str(), 0, MHD_HTTP_BAD_REQUEST);
 	}
 
+	// GET requests without arguments may be answered with a cached response
+	bool cacheable = (t == MHD_GET_ARGUMENT_KIND) && (MHD_get_connection_values (connection, t, NULL, NULL) == 0);
+	if (cacheable && !fDebug && (sendCached (connection, url) == MHD_YES)) return MHD_YES;
+
 	Message msg (url);
 	MHD_get_connection_values (connection, t, _get_params, &msg);
 	vector<Message*> outMsgs;
@@ -220,8 +388,10 @@ int HTTPDServer::answer (struct MHD_Connection *connection, const char *url, con
 		cout << endl;
 	}
 	fProcessor->processMessage (&msg, outMsgs);
-	if (outMsgs.size())
-		send (connection, outMsgs);
+	if ((outMsgs.size() == 1) && suspend (connection, outMsgs[0], con_cls))
+		delete outMsgs[0];			// the request will be processed again when resumed
+	else if (outMsgs.size())
+		send (connection, outMsgs, cacheable ? url : 0);
 	else 
 		page (connection, url);
 	return MHD_YES;
@@ -28,6 +28,7 @@
 #include <string>
 #include <ostream>
 #include <vector>
+#include <map>
 
 #ifdef _WIN32
 #include <winsock2.h>
@@ -51,6 +52,8 @@ typedef size_t socklen_t;
 
 #include <microhttpd.h>
 
+#include "TMutex.h"
+
 namespace httpdfaust
 {
 
@@ -60,24 +63,54 @@ class MessageProcessor;
 //--------------------------------------------------------------------------
 /*!
 	\brief a specific thread to listen incoming osc packets
+
+	With a threads count greater than 0, the server runs a pool of threads
+	(using epoll on linux) instead of a single select thread.
+	Responses to cacheable messages (e.g. the JSON description) are built
+	once and shared by the next requests of the same url.
+	Requests answered with a pending message (e.g. the changes long polling)
+	are suspended without blocking a server thread: they are resumed every
+	kResumePeriod ms to process the request again, until the message is
+	no more pending or its waiting time is over.
 */
 class HTTPDServer
 {
 	MessageProcessor*	fProcessor;
 	struct MHD_Daemon *	fServer;
 	bool				fDebug;
-	
-	int send (struct MHD_Connection *connection, std::vector<Message*> msgs);
+	std::map<std::string, struct MHD_Response*>	fCache;		///< the responses of the cacheable messages
+	TMutex				fCacheMutex;
+	std::vector<struct MHD_Connection*>	fSuspended;		///< the connections waiting for a pending message
+	TMutex				fSuspendMutex;
+	bool				fRunning;		///< true while the resume thread runs
+#ifdef _WIN32
+	HANDLE				fResumeThread;
+#else
+	pthread_t			fResumeThread;
+#endif
+	bool				fResuming;		///< true when the resume thread is running
+
+	bool suspend (struct MHD_Connection *connection, const Message* msg, void **con_cls);
+	bool resumeAll ();
+	void stopResume ();
+
+	int send (struct MHD_Connection *connection, std::vector<Message*> msgs, const char* url);
+	int sendCached (struct MHD_Connection *connection, const char* url);
+	void clearCache ();
 	int page (struct MHD_Connection *connection, const char *page);
 	const char* getMIMEType (const std::string& page);
 
 	public:
+		enum { kResumePeriod = 10 };		// in ms
+
 				 HTTPDServer(MessageProcessor* mp);
 		virtual ~HTTPDServer();
 
 		/// \brief starts the httpd server
-		bool start (int port);
-		void stop ()			{ if (fServer) MHD_stop_daemon (fServer); fServer=0; }
+		bool start (int port, int threads = 0);
+		void stop ();
+		/// \brief the resume thread loop, resumes the suspended connections until the server stops
+		void resumeLoop ();
 		int answer (struct MHD_Connection *connection, const char *url, const char *method, const char *version, 
 					const char *upload_data, size_t *upload_data_size, void **con_cls);
 
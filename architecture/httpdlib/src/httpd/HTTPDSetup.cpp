@@ -41,13 +41,13 @@ bool HTTPDSetup::running() const	{ return fServer ? true : false; }
 //bool HTTPDSetup::running() const	{ return fServer ? fServer->isRunning() : false; }
 
 //--------------------------------------------------------------------------
-bool HTTPDSetup::start(MessageProcessor* mp, int& tcpport )
+bool HTTPDSetup::start(MessageProcessor* mp, int& tcpport, int threads)
 {
 	int port = tcpport;
 	bool done = false;
 	fServer = new HTTPDServer (mp);
 	do {
-		done = fServer->start(port);
+		done = fServer->start(port, threads);
 		if (!done) {
 			if ( port - tcpport > kPortsScanRange) return false;
 			port++;
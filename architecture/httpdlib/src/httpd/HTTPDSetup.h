@@ -44,7 +44,7 @@ class HTTPDSetup
 		 		 HTTPDSetup() : fServer(0) {} 
 		virtual ~HTTPDSetup();
 
-		bool start(MessageProcessor* mp, int& port);
+		bool start(MessageProcessor* mp, int& port, int threads = 0);
 
 		void stop();
 		bool running() const;
@@ -48,6 +48,7 @@ class htmlfactory;
 class HTTPDControler
 {
 	int fTCPPort;				// the tcp port number
+	int fThreads;				// the server threads count (0 for a single select thread)
 	FaustFactory*	fFactory;	// a factory to build the memory representation
 	jsonfactory*	fJson;
 	htmlfactory*	fHtml;
@@ -0,0 +1,102 @@
+/*
+
+  Copyright (C) 2016 Grame
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+  Grame Research Laboratory, 9 rue du Garet, 69001 Lyon - France
+  research@grame.fr
+
+*/
+
+
+#ifndef __TMutex__
+#define __TMutex__
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/time.h>
+#endif
+
+namespace httpdfaust
+{
+
+//--------------------------------------------------------------------------
+/*!
+	\brief cross platform mutex
+
+	Based on pthread on linux and mac and 
+	Windows critical sections on Windows
+*/
+class TMutex
+{
+#ifdef _WIN32
+	CRITICAL_SECTION	fMutex;
+	public:
+				 TMutex()		{ InitializeCriticalSection(&fMutex); }
+		virtual ~TMutex()		{ DeleteCriticalSection(&fMutex); }
+		void	lock()			{ EnterCriticalSection(&fMutex); }
+		void	unlock()		{ LeaveCriticalSection(&fMutex); }
+#else
+	pthread_mutex_t		fMutex;
+	public:
+				 TMutex()		{ pthread_mutex_init(&fMutex, 0); }
+		virtual ~TMutex()		{ pthread_mutex_destroy(&fMutex); }
+		void	lock()			{ pthread_mutex_lock(&fMutex); }
+		void	unlock()		{ pthread_mutex_unlock(&fMutex); }
+#endif
+};
+
+//--------------------------------------------------------------------------
+/*!
+	\brief scoped lock of a TMutex
+*/
+class TLock
+{
+	TMutex& fMutex;
+	public:
+				 TLock(TMutex& mutex) : fMutex(mutex)	{ fMutex.lock(); }
+		virtual ~TLock()								{ fMutex.unlock(); }
+};
+
+//--------------------------------------------------------------------------
+inline void msleep(int ms)
+{
+#ifdef _WIN32
+	Sleep(ms);
+#else
+	usleep(ms * 1000);
+#endif
+}
+
+//--------------------------------------------------------------------------
+// the current time in ms
+inline double mstime()
+{
+#ifdef _WIN32
+	return double(GetTickCount());
+#else
+	struct timeval tv;
+	gettimeofday(&tv, 0);
+	return double(tv.tv_sec) * 1000. + double(tv.tv_usec) * 0.001;
+#endif
+}
+
+} // end namespoace
+
+#endif
@@ -115,17 +115,19 @@ class Message
 		std::string	fAddress;			///< the message destination address
 		std::string	fMIME;				///< the message MIME type
 		argslist	fArguments;			///< the message arguments
+		bool		fCacheable;			///< true when the message content doesn't change
+		int			fPending;			///< the time the answer may wait for a new content (in ms)
 	
 	public:
 			/*!
 				\brief an empty message constructor
 			*/
-			 Message() : fMIME("text/plain") {}
+			 Message() : fMIME("text/plain"), fCacheable(false), fPending(0) {}
 			/*!
 				\brief a message constructor
 				\param address the message destination address
 			*/
-			 Message(const std::string& address) : fAddress(address), fMIME("text/plain") {}
+			 Message(const std::string& address) : fAddress(address), fMIME("text/plain"), fCacheable(false), fPending(0) {}
 
 	virtual ~Message() {}
 
@@ -152,6 +154,16 @@ class Message
 		\param mime the MIME type
 	*/
 	void				setMIMEType(const std::string& mime)	{ fMIME = mime; }
+	/*!
+		\brief marks the message as cacheable: the server may keep the corresponding response
+		\param state the cacheable state
+	*/
+	void				setCacheable(bool state)				{ fCacheable = state; }
+	/*!
+		\brief marks the message as pending: the server may wait for a new content before answering
+		\param ms the maximum waiting time in ms, 0 to answer immediately
+	*/
+	void				setPending(int ms)						{ fPending = ms; }
 	/*!
 		\brief print the message
 		\param out the output stream
@@ -162,6 +174,10 @@ class Message
 	const std::string&	address() const		{ return fAddress; }
 	/// \brief gives the message address
 	const std::string&	mimetype() const	{ return fMIME; }
+	/// \brief gives the message cacheable state
+	bool				cacheable() const	{ return fCacheable; }
+	/// \brief gives the message maximum waiting time
+	int					pending() const		{ return fPending; }
 	/// \brief gives the message parameters list
 	const argslist&		params() const		{ return fArguments; }
 	/// \brief gives the message parameters list
@@ -30,6 +30,7 @@
 
 #include "MessageDriven.h"
 #include "FaustNode.h"
+#include "RootNode.h"
 
 namespace httpdfaust
 {
@@ -48,9 +49,10 @@ class FaustFactory
 {
 	std::stack<SMessageDriven>	fNodes;		///< maintains the current hierarchy level
 	SMessageDriven				fRoot;		///< keep track of the root node
+	RootNode*					fRootNode;	///< the root node, which watches the zones values
 
 	public:
-				 FaustFactory() {}
+				 FaustFactory() : fRootNode(0) {}
 		virtual ~FaustFactory() {}
 
 		/**
@@ -61,7 +63,9 @@ class FaustFactory
 			SMessageDriven top = fNodes.size() ? fNodes.top() : fRoot;
 			if (top) {
 				std::string prefix = top->getAddress();
-				top->add( FaustNode<C>::create (label, zone, init, min, max, prefix.c_str(), initZone));
+				typename FaustNode<C>::SFaustNode node = FaustNode<C>::create (label, zone, init, min, max, prefix.c_str(), initZone);
+				top->add(node);
+				if (fRootNode) fRootNode->watch(node->getAddress(), zone);
 			}
 		}
 
@@ -73,7 +77,9 @@ class FaustFactory
 			SMessageDriven top = fNodes.size() ? fNodes.top() : fRoot;
 			if (top) {
 				std::string prefix = top->getAddress();
-				top->add( FaustNode<C>::create (label, zone, min, max, prefix.c_str(), initZone) );
+				typename FaustNode<C>::SFaustNode node = FaustNode<C>::create (label, zone, min, max, prefix.c_str(), initZone);
+				top->add(node);
+				if (fRootNode) fRootNode->watch(node->getAddress(), zone);
 			}
 		}
 
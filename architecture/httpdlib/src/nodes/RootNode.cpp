@@ -22,6 +22,8 @@
 */
 
 #include <string>
+#include <sstream>
+#include <algorithm>
 
 #include "RootNode.h"
 #include "Message.h"
@@ -32,6 +34,7 @@ namespace httpdfaust
 {
 
 static const char* kJSONAddr = "/JSON";
+static const char* kChangesAddr = "/changes";
 
 
 //--------------------------------------------------------------------------
@@ -44,12 +47,39 @@ bool RootNode::processMessage(const Message* msg, vector<Message*>& outMsg)
 	else if (addr == kJSONAddr) {
 		Message* msg = new Message(fJson);
 		msg->setMIMEType("application/json");
+		msg->setCacheable(true);
 		outMsg.push_back(msg);
 		return true;
 	}
+	else if (addr == kChangesAddr) {
+		return changes(msg, outMsg);
+	}
 	return MessageDriven::processMessage(msg, outMsg);
 }
 
+//--------------------------------------------------------------------------
+// the changes request: /changes?since=<seq>&timeout=<ms>
+bool RootNode::changes(const Message* msg, vector<Message*>& outMsg)
+{
+	float since = 0, timeout = 0;
+	for (int i = 0; i < msg->size() - 1; i++) {
+		string key;
+		if (msg->param(i, key)) {
+			if (key == "since") msg->param(i+1, since);
+			else if (key == "timeout") msg->param(i+1, timeout);
+		}
+	}
+	stringstream json;
+	fChanges.changes((unsigned long)since, json);
+	Message* out = new Message(json.str());
+	out->setMIMEType("application/json");
+	// nothing new: the server may wait for changes and ask again (long polling)
+	if (since && (timeout > 0) && !fChanges.changed((unsigned long)since))
+		out->setPending(int(min(timeout, float(ZoneChanges::kMaxTimeout))));
+	outMsg.push_back(out);
+	return true;
+}
+
 //--------------------------------------------------------------------------
 bool RootNode::accept(const Message* msg, vector<Message*>& outMsg)
 {
@@ -58,6 +88,7 @@ bool RootNode::accept(const Message* msg, vector<Message*>& outMsg)
 	if ((msg->size() == 0) && (msg->address() == "/")) {
 		Message* msg = new Message (fHtml);
 		msg->setMIMEType("text/html");
+		msg->setCacheable(true);
 		outMsg.push_back(msg);
 		return true;
 	}
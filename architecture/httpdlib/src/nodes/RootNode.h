@@ -27,6 +27,7 @@
 
 #include <string>
 #include "MessageDriven.h"
+#include "ZoneChanges.h"
 
 namespace httpdfaust
 {
@@ -42,7 +43,10 @@ class RootNode : public MessageDriven
 {
 	std::string fJson;
 	std::string fHtml;
+	ZoneChanges fChanges;		///< the change feed of the parameters values
 	
+	bool		changes(const Message* msg, std::vector<Message*>& outMsg);
+
 	protected:
 				 RootNode(const char *name) : MessageDriven (name, "") {}
 		virtual ~RootNode() {}
@@ -52,6 +56,8 @@ class RootNode : public MessageDriven
 
 		void			setJSON(const std::string& json)	{ fJson = json; }
 		void			setHtml(const std::string& html)	{ fHtml = html; }
+		/// \brief the max number of clients waiting for changes (i.e. blocking a server thread)
+		template <typename C> void watch(const std::string& address, const C* zone)	{ fChanges.add(address, zone); }
 		//--------------------------------------------------------------------------
 		bool			processMessage(const Message* msg, std::vector<Message*>& outMsg);
 		virtual bool	accept(const Message* msg, std::vector<Message*>& outMsg);
@@ -0,0 +1,114 @@
+/*
+
+  Copyright (C) 2016 Grame
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+  Grame Research Laboratory, 9 rue du Garet, 69001 Lyon - France
+  research@grame.fr
+
+*/
+
+#include <math.h>
+
+#include "ZoneChanges.h"
+
+using namespace std;
+
+namespace httpdfaust
+{
+
+//--------------------------------------------------------------------------
+// true when the sequence number a is more recent than b
+static bool newer(unsigned long a, unsigned long b)
+{
+	unsigned long d = (a - b) & ZoneChanges::kSeqMask;
+	return d && (d < (ZoneChanges::kSeqMask >> 1));
+}
+
+//--------------------------------------------------------------------------
+void ZoneChanges::add(const string& address, const float* fzone, const double* dzone)
+{
+	watchedzone z;
+	z.fAddress = address;
+	z.fFloat = fzone;
+	z.fDouble = dzone;
+	z.fLast = fzone ? *fzone : *dzone;
+	z.fSeq = fSeq;
+	TLock lock(fMutex);
+	fZones.push_back(z);
+}
+
+//--------------------------------------------------------------------------
+unsigned long ZoneChanges::scan()
+{
+	TLock lock(fMutex);
+	double time = mstime();
+	if ((time - fLastScan) < kScanPeriod) return fSeq;	// scanned recently by another client
+	fLastScan = time;
+
+	unsigned long seq = (fSeq + 1) & kSeqMask;
+	if (!seq) seq = 1;									// 0 is reserved for the first request
+	bool changed = false;
+	for (vector<watchedzone>::iterator i = fZones.begin(); i != fZones.end(); i++) {
+		double v = i->fFloat ? *i->fFloat : *i->fDouble;
+		if ((v != i->fLast) && ((v == v) || (i->fLast == i->fLast))) {		// NaN is not a change of NaN
+			i->fLast = v;
+			i->fSeq = seq;
+			changed = true;
+		}
+	}
+	if (changed) fSeq = seq;
+	return fSeq;
+}
+
+//--------------------------------------------------------------------------
+bool ZoneChanges::changed(unsigned long since)
+{
+	return !since || newer(scan(), since);
+}
+
+//--------------------------------------------------------------------------
+// JSON has no representation of NaN and of the infinite values
+static void writeValue(ostream& out, double v, bool single)
+{
+	if ((v != v) || (v == HUGE_VAL) || (v == -HUGE_VAL)) {
+		out << "null";
+	} else {
+		streamsize precision = out.precision(single ? 9 : 17);		// the digits to read back the same value
+		out << v;
+		out.precision(precision);
+	}
+}
+
+//--------------------------------------------------------------------------
+unsigned long ZoneChanges::changes(unsigned long since, ostream& out)
+{
+	scan();
+	TLock lock(fMutex);
+	const char* sep = "";
+	out << "{\"seq\": " << fSeq << ", \"values\": {";
+	for (vector<watchedzone>::const_iterator i = fZones.begin(); i != fZones.end(); i++) {
+		if (!since || newer(i->fSeq, since)) {
+			out << sep << "\"" << i->fAddress << "\": ";
+			writeValue(out, i->fLast, i->fFloat != 0);
+			sep = ", ";
+		}
+	}
+	out << "}}";
+	return fSeq;
+}
+
+} // end namespoace
@@ -0,0 +1,96 @@
+/*
+
+  Copyright (C) 2016 Grame
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+  Grame Research Laboratory, 9 rue du Garet, 69001 Lyon - France
+  research@grame.fr
+
+*/
+
+
+#ifndef __ZoneChanges__
+#define __ZoneChanges__
+
+#include <string>
+#include <vector>
+#include <ostream>
+
+#include "TMutex.h"
+
+namespace httpdfaust
+{
+
+//--------------------------------------------------------------------------
+/*!
+	\brief a change feed of the parameters values
+
+	The zones are compared to their previous value when a client asks for
+	the changes (at most every kScanPeriod ms, the scans being shared by all
+	the clients). A new sequence number is allocated to each scan that finds
+	changes, clients give back the last sequence number they received and get
+	the values changed since, in a single JSON object:
+	{ "seq": 12, "values": { "/app/level": 0.5, ... } }
+	The values are written with all their digits, and the values that are
+	not finite numbers (NaN or infinite) as null.
+*/
+class ZoneChanges
+{
+	struct watchedzone {
+		std::string		fAddress;		///< the parameter address
+		const float*	fFloat;			///< the parameter zone (float version)
+		const double*	fDouble;		///< the parameter zone (double version)
+		double			fLast;			///< the value at the last scan
+		unsigned long	fSeq;			///< the sequence number of its last change
+	};
+
+	std::vector<watchedzone>	fZones;
+	unsigned long	fSeq;			///< the current sequence number
+	double			fLastScan;		///< the time of the last scan
+	TMutex			fMutex;
+
+	unsigned long	scan();
+	void			add(const std::string& address, const float* fzone, const double* dzone);
+
+	public:
+		enum { kScanPeriod = 10, kMaxTimeout = 30000 };		// in ms
+		enum { kSeqMask = 0xffffff };		// sequence numbers are sent as float values
+
+				 ZoneChanges() : fSeq(1), fLastScan(0) {}
+		virtual ~ZoneChanges() {}
+
+		void	add(const std::string& address, const float* zone)		{ add(address, zone, 0); }
+		void	add(const std::string& address, const double* zone)		{ add(address, 0, zone); }
+
+		/*!
+			\brief tests if values changed since a given sequence number
+			\param since the last sequence number received by the client, 0 to get all the values
+			\return true when there are values to send
+		*/
+		bool			changed(unsigned long since);
+
+		/*!
+			\brief writes the values changed since a given sequence number
+			\param since the last sequence number received by the client, 0 to get all the values
+			\param out the output stream
+			\return the current sequence number
+		*/
+		unsigned long	changes(unsigned long since, std::ostream& out);
+};
+
+} // end namespoace
+
+#endif
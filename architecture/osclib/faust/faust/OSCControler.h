@@ -89,6 +89,12 @@ class OSCControler
 		//--------------------------------------------------------------------------
 		void run();				// starts the network services
 		void stop();			// stop the network services
+
+		//--------------------------------------------------------------------------
+		// beginUpdate and endUpdate bracket a user interface update: in bundle mode,
+		// all the values transmitted between the two calls are sent as OSC bundles
+		void beginUpdate();
+		void endUpdate();
 		
 		int	getUDPPort() const			{ return fUDPPort; }
 		int	getUDPOut()	const			{ return fUDPOut; }
@@ -107,6 +113,20 @@ class OSCControler
 		static const char* versionstr();	// the Faust OSC library version number as a string
 		static int gXmit;                   // a static variable to control the transmission of values
                                             // i.e. the use of the interface as a controler
+		static bool gBundle;                // when true, the transmitted values are grouped into OSC bundles
+		static float gXmitRate;             // the max transmission rate of a zone (in Hz, 0 for no limit)
+		static float gXmitDelta;            // the min change of a zone to be transmitted (as a fraction of its range)
+		static int gFilterGeneration;       // incremented each time the filtered paths change
+
+		static double xmitTime();           // the current time (in seconds) used by the rate limiting
+		/*!
+			\brief checks the rate and change thresholds of a zone before transmitting a new value
+			\param value the new value of the zone
+			\param last the last transmitted value
+			\param range the range of the zone
+			\param lastTime the time of the last transmission, updated when the value should be sent
+		*/
+		static bool xmitAllowed(double value, double last, double range, double& lastTime);
 };
 
 #define kNoXmit     0
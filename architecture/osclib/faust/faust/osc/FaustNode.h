@@ -58,17 +58,29 @@ template <typename C> class FaustNode : public MessageDriven, public uiItem
 	mapping<C>	fMapping;
     RootNode* fRoot;
     bool fInput;  // true for input nodes (slider, button...)
+
+	// transmission state, used by reflectZone
+	std::string					fAddress;		// the node OSC address
+	std::vector<std::string>	fAliases;		// the aliases of the node, collected at first transmission
+	bool	fAliasesReady;
+	int		fFilterGeneration;		// the filtered paths generation fFiltered refers to
+	bool	fFiltered;				// true when the node address is filtered
+	C		fLastSent;				// the last transmitted value
+	double	fLastTime;				// the time of the last transmission
 	
 	bool	store(C val) { *fZone = fMapping.clip(val); return true; }
-	void	sendOSC() const;
+	void	sendOSC();
+	bool	xmitAllowed(C val);
 
 	protected:
 		FaustNode(RootNode* root, const char *name, C* zone, C init, C min, C max, const char* prefix, GUI* ui, bool initZone, bool input) 
-			: MessageDriven(name, prefix), uiItem(ui, zone), fRoot(root), fMapping(min, max), fInput(input)
+			: MessageDriven(name, prefix), uiItem(ui, zone), fMapping(min, max), fRoot(root), fInput(input),
+			  fAliasesReady(false), fFilterGeneration(-1), fFiltered(false), fLastSent(init), fLastTime(0)
 			{ 
                 if (initZone) {
                     *zone = init; 
                 }
+                fAddress = getOSCAddress();
             }
 			
 		virtual ~FaustNode() {}
@@ -88,7 +100,11 @@ template <typename C> class FaustNode : public MessageDriven, public uiItem
 
 		bool accept(const Message* msg);
 		void get(unsigned long ipdest) const;		///< handler for the 'get' message
-		virtual void reflectZone() { sendOSC(); fCache = *fZone; }
+		virtual void reflectZone()
+		{
+			// a value not transmitted yet is kept out of the cache, so that it is reconsidered at the next update
+			if (xmitAllowed(*fZone)) { sendOSC(); fCache = *fZone; }
+		}
 };
 
 } // end namespace
@@ -36,6 +36,7 @@ namespace oscfaust
 class Message;
 class OSCRegexp;
 class MessageDriven;
+class AddressCache;
 typedef class SMARTP<MessageDriven>	SMessageDriven;
 
 //--------------------------------------------------------------------------
@@ -48,17 +49,24 @@ typedef class SMARTP<MessageDriven>	SMessageDriven;
 	
 	The principle of the dispatch is the following:
 	- first the processMessage() method should be called on the top level node
-	- next processMessage call propose 
+	- literal addresses are dispatched down the tree using the subnodes name hash index
+	- addresses containing OSC patterns (*, ?, [], {}) are resolved once with resolve()
+	  and the resulting destination nodes are kept in a LRU cache
 */
 class MessageDriven : public MessageProcessor, public smartable
 {
 	std::string						fName;			///< the node name
 	std::string						fOSCPrefix;		///< the node OSC address prefix (OSCAddress = fOSCPrefix + '/' + fName)
 	std::vector<SMessageDriven>		fSubNodes;		///< the subnodes of the current node
+	std::vector<std::pair<unsigned long, int> >	fIndex;	///< the subnodes (name hash, index) sorted by hash
+	AddressCache*					fAddressCache;			///< the resolved OSC patterns (top level node only)
+
+	void	dispatch(const Message* msg, const std::string& addr, size_t pos);
+	void	resolve(const OSCRegexp* regexp, const std::string& addrTail, std::vector<MessageDriven*>& targets);
 
 	protected:
-				 MessageDriven(const char *name, const char *oscprefix) : fName (name), fOSCPrefix(oscprefix) {}
-		virtual ~MessageDriven() {}
+				 MessageDriven(const char *name, const char *oscprefix) : fName (name), fOSCPrefix(oscprefix), fAddressCache(0) {}
+		virtual ~MessageDriven();
 
 	public:
 		static SMessageDriven create(const char* name, const char *oscprefix)	{ return new MessageDriven(name, oscprefix); }
@@ -70,20 +78,6 @@ class MessageDriven : public MessageProcessor, public smartable
 		*/
 		virtual void	processMessage(const Message* msg);
 
-		/*!
-			\brief propose an OSc message at a given hierarchy level.
-			\param msg the osc message currently processed
-			\param regexp a regular expression based on the osc address head
-			\param addrTail the osc address tail
-			
-			The method first tries to match the regular expression with the object name. 
-			When it matches:
-			- it calls \c accept when \c addrTail is empty 
-			- or it \c propose the message to its subnodes when \c addrTail is not empty. 
-			  In this case a new \c regexp is computed with the head of \c addrTail and a new \c addrTail as well.
-		*/
-		virtual void	propose(const Message* msg, const OSCRegexp* regexp, const std::string addrTail);
-
 		/*!
 			\brief accept an OSC message. 
 			\param msg the osc message currently processed
@@ -117,7 +111,7 @@ class MessageDriven : public MessageProcessor, public smartable
 		*/
 		virtual void	get (unsigned long ipdest, const std::string & what) const {}
 
-		void			add(SMessageDriven node)	{ fSubNodes.push_back (node); }
+		void			add(SMessageDriven node);
 		const char*		getName() const				{ return fName.c_str(); }
 		std::string		getOSCAddress() const;
 		int				size() const				{ return fSubNodes.size (); }
@@ -24,7 +24,13 @@
 */
 
 #include <stdlib.h>
+#include <math.h>
 #include <iostream>
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <sys/time.h>
+#endif
 
 #include "faust/OSCControler.h"
 #include "faust/osc/FaustFactory.h"
@@ -34,14 +40,15 @@
 #include "OSCSetup.h"
 #include "OSCFError.h"
 #include "OSCRegexp.h"
+#include "OSCStream.h"
 
 using namespace std;
 
 namespace oscfaust
 {
 
-#define kVersion	 0.96f
-#define kVersionStr	"0.96"
+#define kVersion	 0.97f
+#define kVersionStr	"0.97"
 
 static const char* kUDPPortOpt	= "-port";
 static const char* kUDPOutOpt	= "-outport";
@@ -49,10 +56,20 @@ static const char* kUDPErrOpt	= "-errport";
 static const char* kUDPDestOpt	= "-desthost";
 static const char* kXmitOpt		= "-xmit";
 static const char* kXmitFilterOpt = "-xmitfilter";
+static const char* kXmitRateOpt	= "-xmitrate";
+static const char* kXmitDeltaOpt = "-xmitdelta";
+static const char* kBundleOpt	= "-bundle";
 
 int OSCControler::gXmit = 0;		// a static variable to control the transmission of values
                                     // i.e. the use of the interface as a controler
 
+bool OSCControler::gBundle = false;
+float OSCControler::gXmitRate = 0;
+float OSCControler::gXmitDelta = 0;
+int OSCControler::gFilterGeneration = 0;
+
+static double gUpdateTime = 0;		// the time of the current update, 0 outside of beginUpdate/endUpdate
+
 std::vector<OSCRegexp*> OSCControler::fFilteredPaths;
     
 //--------------------------------------------------------------------------
@@ -89,6 +106,16 @@ static int getXmitOption(int argc, char *argv[], const std::string& option, bool
 	return defaultValue;
 }
 
+static float getFloatOption(int argc, char *argv[], const std::string& option, float defaultValue)
+{
+	for (int i = 0; i < argc-1; i++) {
+		if (option == argv[i]) {
+			return float(strtod(argv[i+1], 0));
+		}
+	}
+	return defaultValue;
+}
+
 static void treatXmitFilterOption(int argc, char *argv[], const std::string& option)
 {
     for (int i = 0; i < argc-1; i++) {
@@ -115,6 +142,9 @@ OSCControler::OSCControler(int argc, char *argv[], GUI* ui, OSCIO* io, ErrorCall
 	fUPDErr  = getPortOption(argc, argv, kUDPErrOpt, fUPDErr);
 	fDestAddress = getDestOption (argc, argv, kUDPDestOpt, "localhost");
 	gXmit = getXmitOption(argc, argv, kXmitOpt, kNoXmit);
+	gBundle = getXmitOption(argc, argv, kBundleOpt, false) != 0;
+	gXmitRate = getFloatOption(argc, argv, kXmitRateOpt, 0);
+	gXmitDelta = getFloatOption(argc, argv, kXmitDeltaOpt, 0);
     
     treatXmitFilterOption(argc, argv, kXmitFilterOpt);
  
@@ -170,6 +200,52 @@ void OSCControler::run()
 	}
 }
 
+//--------------------------------------------------------------------------
+// a user interface update starts: in bundle mode, the values are collected
+// into the xmit stream, which is written by the GUI thread only
+void OSCControler::beginUpdate()
+{
+	gUpdateTime = 0;
+	if (gXmitRate > 0) gUpdateTime = xmitTime();
+	if (gBundle && gXmit && _oscxmit) {
+		oscxmit.setAddress(oscout.getAddress());
+		oscxmit.setPort(oscout.getPort());
+		oscxmit.beginBundle();
+	}
+}
+
+//--------------------------------------------------------------------------
+void OSCControler::endUpdate()
+{
+	if (_oscxmit) oscxmit.endBundle();
+	gUpdateTime = 0;
+}
+
+//--------------------------------------------------------------------------
+double OSCControler::xmitTime()
+{
+	if (gUpdateTime) return gUpdateTime;	// a single clock read per update
+#ifdef WIN32
+	return double(GetTickCount()) * 0.001;
+#else
+	struct timeval tv;
+	gettimeofday(&tv, 0);
+	return double(tv.tv_sec) + double(tv.tv_usec) * 1e-6;
+#endif
+}
+
+//--------------------------------------------------------------------------
+bool OSCControler::xmitAllowed(double value, double last, double range, double& lastTime)
+{
+	if ((gXmitDelta > 0) && (fabs(value - last) < gXmitDelta * fabs(range))) return false;
+	if (gXmitRate > 0) {
+		double time = xmitTime();
+		if ((time - lastTime) < (1. / gXmitRate)) return false;
+		lastTime = time;
+	}
+	return true;
+}
+
 //--------------------------------------------------------------------------
 const char*	OSCControler::getRootName()	const { return fFactory->root()->getName(); }
     
@@ -178,6 +254,7 @@ void OSCControler::addFilteredPath(std::string path)
 {
     OSCRegexp* regexp = new OSCRegexp(path.c_str());
     fFilteredPaths.push_back(regexp);
+    gFilterGeneration++;
 }
     
 //--------------------------------------------------------------------------
@@ -198,6 +275,7 @@ void OSCControler::resetFilteredPaths()
         fFilteredPaths.erase(fFilteredPaths.begin()+i);
         delete reg;
     }
+    gFilterGeneration++;
 }  
 
 //--------------------------------------------------------------------------
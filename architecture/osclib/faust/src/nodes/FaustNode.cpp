@@ -30,37 +30,85 @@ namespace oscfaust
 {
 
 //--------------------------------------------------------------------------
-template<> void FaustNode<float>::sendOSC() const 
+// the values are transmitted by the GUI thread on the xmit stream: the
+// standard output stream is written by the OSC listener thread only
+static OSCStream& xmitStream()
 {
-    if (OSCControler::gXmit != kNoXmit && !OSCControler::isPathFiltered(getOSCAddress())) {
-        std::vector<std::string> aliases = fRoot->getAliases(getOSCAddress());
+	if (!oscxmit.inBundle()) {			// the bundles keep the destination of the update
+		oscxmit.setAddress(oscout.getAddress());
+		oscxmit.setPort(oscout.getPort());
+	}
+	return oscxmit;
+}
+
+//--------------------------------------------------------------------------
+template<> bool FaustNode<float>::xmitAllowed(float val)
+{
+    if (OSCControler::gXmit == kNoXmit) return true;
+    if (!OSCControler::xmitAllowed(val, fLastSent, fMapping.fMaxOut - fMapping.fMinOut, fLastTime)) return false;
+    fLastSent = val;
+    return true;
+}
+
+//--------------------------------------------------------------------------
+template<> bool FaustNode<double>::xmitAllowed(double val)
+{
+    if (OSCControler::gXmit == kNoXmit) return true;
+    if (!OSCControler::xmitAllowed(val, fLastSent, fMapping.fMaxOut - fMapping.fMinOut, fLastTime)) return false;
+    fLastSent = val;
+    return true;
+}
+
+//--------------------------------------------------------------------------
+template<> void FaustNode<float>::sendOSC()
+{
+    if (OSCControler::gXmit == kNoXmit) return;
+    // the filtered paths are matched again only when they have changed
+    if (fFilterGeneration != OSCControler::gFilterGeneration) {
+        fFiltered = OSCControler::isPathFiltered(fAddress);
+        fFilterGeneration = OSCControler::gFilterGeneration;
+    }
+    if (!fFiltered) {
+        // the aliases are all declared when the interface is built
+        if (!fAliasesReady) {
+            fAliases = fRoot->getAliases(fAddress);
+            fAliasesReady = true;
+        }
+        OSCStream& out = xmitStream();
         // If aliases are present
-        if (aliases.size() > 0) {  
-            for (size_t i = 0; i < aliases.size(); i++) {
-                oscout << OSCStart(aliases[i].c_str()) << float(*fZone) << OSCEnd();
-            }
+        for (size_t i = 0; i < fAliases.size(); i++) {
+            out << OSCStart(fAliases[i].c_str()) << float(*fZone) << OSCEnd();
         }
         // Also emit regular address
         if (OSCControler::gXmit == kAll) {
-            oscout << OSCStart(getOSCAddress().c_str()) << float(*fZone) << OSCEnd();
+            out << OSCStart(fAddress.c_str()) << float(*fZone) << OSCEnd();
         } 
     }
 }
 
 //--------------------------------------------------------------------------
-template<> void FaustNode<double>::sendOSC() const 
+template<> void FaustNode<double>::sendOSC()
 {
-    if (OSCControler::gXmit != kNoXmit && !OSCControler::isPathFiltered(getOSCAddress())) {
-        std::vector<std::string> aliases = fRoot->getAliases(getOSCAddress());
+    if (OSCControler::gXmit == kNoXmit) return;
+    // the filtered paths are matched again only when they have changed
+    if (fFilterGeneration != OSCControler::gFilterGeneration) {
+        fFiltered = OSCControler::isPathFiltered(fAddress);
+        fFilterGeneration = OSCControler::gFilterGeneration;
+    }
+    if (!fFiltered) {
+        // the aliases are all declared when the interface is built
+        if (!fAliasesReady) {
+            fAliases = fRoot->getAliases(fAddress);
+            fAliasesReady = true;
+        }
+        OSCStream& out = xmitStream();
         // If aliases are present
-        if (aliases.size() > 0) { 
-            for (size_t i = 0; i < aliases.size(); i++) {
-                oscout << OSCStart(aliases[i].c_str()) << double(*fZone) << OSCEnd();
-            }
+        for (size_t i = 0; i < fAliases.size(); i++) {
+            out << OSCStart(fAliases[i].c_str()) << double(*fZone) << OSCEnd();
         }
         // Also emit regular address
         if (OSCControler::gXmit == kAll) {
-            oscout << OSCStart(getOSCAddress().c_str()) << double(*fZone) << OSCEnd();
+            out << OSCStart(fAddress.c_str()) << double(*fZone) << OSCEnd();
         } 
     }
 }
@@ -108,7 +156,6 @@ template<> bool FaustNode<double>::accept(const Message* msg)			///< handler for
     if (msg->size() == 1) {			// checks for the message parameters count
                                     // messages with a param count other than 1 are rejected
         int ival; float fval;
-        std::vector<std::string> aliases = fRoot->getAliases(getOSCAddress());
         if ((OSCControler::gXmit == kNoXmit) || (OSCControler::gXmit == kAll) || (OSCControler::gXmit == kAlias && msg->alias() != "")) {
            if (msg->param(0, fval)) {
                 return store(double(fval));	// accepts float values
@@ -21,6 +21,9 @@
 
 */
 
+#include <algorithm>
+#include <list>
+#include <map>
 #include <sstream>
 
 #include "faust/osc/Message.h"
@@ -35,16 +38,160 @@ namespace oscfaust
 {
 
 static const char * kGetMsg = "get";
+static const size_t kCacheSize = 256;
+
+static unsigned long gTreeGeneration = 0;	// incremented each time a node is added to a tree
+
+//--------------------------------------------------------------------------
+// FNV-1a hash of an address segment
+static unsigned long hashName(const char* name, size_t len)
+{
+	unsigned long h = 2166136261UL;
+	for (size_t i = 0; i < len; i++) {
+		h = (h ^ (unsigned char)name[i]) * 16777619UL;
+	}
+	return h & 0xffffffffUL;
+}
+
+//--------------------------------------------------------------------------
+// true when the address contains OSC pattern matching characters
+static bool isPattern(const string& addr)
+{
+	return addr.find_first_of("*?[]{}") != string::npos;
+}
+
+//--------------------------------------------------------------------------
+/*!
+	\brief a LRU cache of the destination nodes of OSC address patterns
+
+	The cache is flushed when a node is added to any tree, since the
+	destinations of a pattern may then change.
+*/
+class AddressCache
+{
+	typedef vector<MessageDriven*>				targets;
+	typedef list<pair<string, targets> >		entries;
+
+	entries								fEntries;		///< the resolved patterns, most recently used first
+	map<string, entries::iterator>		fMap;			///< the resolved patterns by address
+	size_t								fSize;			///< the maximum number of entries
+	unsigned long						fGeneration;	///< the tree generation of the entries
+
+	public:
+				 AddressCache(size_t size) : fSize(size), fGeneration(gTreeGeneration) {}
+		virtual ~AddressCache() {}
+
+		const targets* find(const string& addr)
+		{
+			if (fGeneration != gTreeGeneration) {
+				fEntries.clear();
+				fMap.clear();
+				fGeneration = gTreeGeneration;
+				return 0;
+			}
+			map<string, entries::iterator>::iterator it = fMap.find(addr);
+			if (it == fMap.end()) return 0;
+			fEntries.splice(fEntries.begin(), fEntries, it->second);	// move to front, iterators stay valid
+			return &it->second->second;
+		}
+
+		const targets* insert(const string& addr, const targets& t)
+		{
+			if (fEntries.size() >= fSize) {
+				fMap.erase(fEntries.back().first);
+				fEntries.pop_back();
+			}
+			fEntries.push_front(make_pair(addr, t));
+			fMap[addr] = fEntries.begin();
+			return &fEntries.front().second;
+		}
+};
+
+//--------------------------------------------------------------------------
+MessageDriven::~MessageDriven()
+{
+	delete fAddressCache;
+}
+
+//--------------------------------------------------------------------------
+void MessageDriven::add(SMessageDriven node)
+{
+	fIndex.push_back(make_pair(hashName(node->fName.c_str(), node->fName.size()), int(fSubNodes.size())));
+	sort(fIndex.begin(), fIndex.end());		// (hash, index) pairs: subnodes order is kept for equal names
+	fSubNodes.push_back(node);
+	gTreeGeneration++;
+}
 
 //--------------------------------------------------------------------------
 void MessageDriven::processMessage(const Message* msg)
 {
-	const string addr = msg->address();
+	const string& addr = msg->address();
+
+	if (!isPattern(addr)) {
+		// literal address: check the first segment and go down the tree
+		if (addr.empty() || (addr[0] != '/')) return;
+		size_t next = addr.find('/', 1);
+		if (next == string::npos) next = addr.size();
+		if (fName.compare(0, string::npos, addr, 1, next - 1) == 0) {
+			dispatch(msg, addr, next);
+		}
+		return;
+	}
+
+	// OSC pattern: the regular expressions are only used for the first occurence
+	if (!fAddressCache) fAddressCache = new AddressCache(kCacheSize);
+	const vector<MessageDriven*>* targets = fAddressCache->find(addr);
+	if (!targets) {
+		vector<MessageDriven*> found;
+		// create a regular expression
+		OSCRegexp r(OSCAddress::addressFirst(addr).c_str());
+		// and resolve the destinations with this regexp and with the dest osc address tail
+		resolve(&r, OSCAddress::addressTail(addr), found);
+		targets = fAddressCache->insert(addr, found);
+	}
+	for (size_t i = 0; i < targets->size(); i++) {
+		(*targets)[i]->accept(msg);
+	}
+}
+
+//--------------------------------------------------------------------------
+// literal address dispatch: 'pos' is the position of the '/' starting the
+// next segment of 'addr' (or the address size when the node is the destination)
+void MessageDriven::dispatch(const Message* msg, const string& addr, size_t pos)
+{
+	if (pos >= addr.size()) {
+		accept(msg);
+		return;
+	}
+	size_t next = addr.find('/', pos + 1);
+	if (next == string::npos) next = addr.size();
+	size_t len = next - pos - 1;
+	unsigned long h = hashName(addr.data() + pos + 1, len);
+	vector<pair<unsigned long, int> >::const_iterator i = lower_bound(fIndex.begin(), fIndex.end(), make_pair(h, -1));
+	for (; (i != fIndex.end()) && (i->first == h); i++) {
+		MessageDriven* node = fSubNodes[i->second];
+		if (node->fName.compare(0, string::npos, addr, pos + 1, len) == 0) {
+			node->dispatch(msg, addr, next);
+		}
+	}
+}
 
-	// create a regular expression
-	OSCRegexp r(OSCAddress::addressFirst(addr).c_str());
-	// and call propose with this regexp and with the dest osc address tail
-	propose(msg, &r, OSCAddress::addressTail(addr));
+//--------------------------------------------------------------------------
+// matches the regular expression with the node name and, when the address tail
+// is not empty, with the subnodes names: collects the destination nodes
+void MessageDriven::resolve(const OSCRegexp* r, const std::string& addrTail, vector<MessageDriven*>& targets)
+{
+	if (r->match(getName())) {
+		if (addrTail.empty()) {
+			targets.push_back(this);
+		} else {
+			OSCRegexp rtail (OSCAddress::addressFirst(addrTail).c_str());
+			string tail = OSCAddress::addressTail(addrTail);
+			for (vector<SMessageDriven>::iterator i = fSubNodes.begin(); i != fSubNodes.end(); i++) {
+				(*i)->resolve(&rtail, tail, targets);
+			}
+		}
+	}
 }
 
 //--------------------------------------------------------------------------
@@ -84,20 +231,4 @@ bool MessageDriven::accept(const Message* msg)
 	return false;
 }
 
-//--------------------------------------------------------------------------
-void MessageDriven::propose(const Message* msg, const OSCRegexp* r, const std::string addrTail)
-{
-	if (r->match(getName())) {			// try to match the regular expression with the object name. 
-		if (addrTail.empty()) {			// it matches and the tail is empty
-			accept(msg);				// then call accept()
-		} else {						// it matches but the tail is not empty
-			OSCRegexp rtail (OSCAddress::addressFirst(addrTail).c_str());
-			for (vector<SMessageDriven>::iterator i = fSubNodes.begin(); i != fSubNodes.end(); i++) {
-				// then propagate propose() to subnodes with a new regexp and a new tail
-				(*i)->propose(msg, &rtail, OSCAddress::addressTail(addrTail));
-			}
-		}
-	}
-}
-
 } // end namespoace
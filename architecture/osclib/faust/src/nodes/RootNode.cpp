@@ -145,7 +145,9 @@ void RootNode::get(unsigned long ipdest) const		///< handler for the 'get' messa
 //--------------------------------------------------------------------------
 void RootNode::processAlias(const string& address, float val)
 {
- 	vector<aliastarget> targets = fAliases[address];	// retrieve the address aliases
+	std::map<std::string, std::vector<aliastarget> >::const_iterator it = fAliases.find(address);
+	if (it == fAliases.end()) return;					// the address is not an alias
+ 	const vector<aliastarget>& targets = it->second;	// retrieve the address aliases
 	size_t n = targets.size();							// that could point to an arbitraty number of targets
 	for (size_t i = 0; i < n; i++) {					// for each target
 		Message m(targets[i].fTarget, address);			// create a new message with the target address and the alias
@@ -213,7 +215,13 @@ bool RootNode::acceptSignal(const Message* msg)
 				break;						// and stops reading data
 			}
 		}
-		if (ret) fIO->receive(n, buff);	// call the IO controler receive method with the float data
+		if (ret) {
+			// in bundle mode, the output channels computed from this input are sent as bundles
+			// (oscout is written by the listener thread only, the GUI thread writes oscxmit)
+			if (OSCControler::gBundle) oscout.beginBundle();
+			fIO->receive(n, buff);			// call the IO controler receive method with the float data
+			oscout.endBundle();
+		}
 	}
 	else ret = false;
 	return ret;
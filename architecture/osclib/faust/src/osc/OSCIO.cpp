@@ -21,7 +21,7 @@
 
 */
 
-#include <sstream>
+#include <stdio.h>
 #include "faust/OSCIO.h"
 #include "OSCStream.h"
 
@@ -31,9 +31,11 @@ namespace oscfaust
 //--------------------------------------------------------------------------
 void OSCIO::send(int nframes, float* val, int chan) const
 {
-	std::stringstream dst;
-	dst << dest() << chan;					// first set the destination osc address
-	oscout << OSCStart(dst.str().c_str());	// then starts the osc out stream
+	char num[16];
+	sprintf(num, "%d", chan);
+	std::string dst(fDest);
+	dst += num;								// first set the destination osc address
+	oscout << OSCStart(dst.c_str());		// then starts the osc out stream
 	for (int n = 0; n < nframes; n++) {
 		oscout << val[n];					// and send the values
     }
@@ -21,6 +21,7 @@
 
 #include <iostream>
 #include "OSCStream.h"
+#include "TThreads.h"
 
 using namespace std;
 
@@ -29,8 +30,10 @@ namespace oscfaust
 
 OSCStream* _oscout = 0;				// OSC standard output stream
 OSCStream* _oscerr = 0;				// OSC standard error stream
+OSCStream* _oscxmit = 0;			// OSC stream used by the GUI thread to transmit the zones values
 
 static UdpSocket* _socket = 0;		// a shared transmit socket
+static TMutex _sendMutex;			// the socket is shared by the listener thread and the GUI thread
 int OSCStream::fRefCount = 0;
 
 //--------------------------------------------------------------------------
@@ -43,6 +46,8 @@ void OSCStream::start()
         if (!_oscout) throw std::bad_alloc();
         _oscerr = new OSCStream(_socket);
         if (!_oscerr) throw std::bad_alloc();
+        _oscxmit = new OSCStream(_socket);
+        if (!_oscxmit) throw std::bad_alloc();
     }
 }
 
@@ -53,8 +58,10 @@ void OSCStream::stop()
         delete _socket;
         delete _oscout;
         delete _oscerr;
+        delete _oscxmit;
         _oscout = 0;
         _oscerr = 0;
+        _oscxmit = 0;
         _socket = 0;
     }
 }
@@ -69,8 +76,17 @@ void OSCStream::setAddress(const string& address)
 //--------------------------------------------------------------------------
 OSCStream& OSCStream::start(const char* address)
 { 
-	stream().Clear();
-	if (!stream().IsReady()) cerr << "OSCStream OutboundPacketStream not ready" << endl;
+	if (fBundle) {
+		// a bundle has a single destination: flush it when the destination changes
+		if ((fAddress != fBundleAddress) || (fPort != fBundlePort)) {
+			flushBundle();
+			fBundleAddress = fAddress;
+			fBundlePort = fPort;
+		}
+	} else {
+		stream().Clear();
+		if (!stream().IsReady()) cerr << "OSCStream OutboundPacketStream not ready" << endl;
+	}
 	stream() << osc::BeginMessage(address); 
 	fState = kInProgress;
 	return *this;
@@ -88,10 +104,51 @@ void OSCStream::send(unsigned long ipdest, int port)
 {
 	if (state() == kInProgress) {
 		stream() << osc::EndMessage;
-		if (fSocket) {
+		fState = kIdle;
+		if (fBundle) {
+			fBundleCount++;
+			if (stream().Size() >= kBundleSize) flushBundle();
+		} else if (fSocket) {
+			TLock lock(_sendMutex);
 			fSocket->SendTo(IpEndpointName (ipdest, port), stream().Data(), stream().Size());
         }
-		fState = kIdle;
+	}
+}
+
+//--------------------------------------------------------------------------
+void OSCStream::beginBundle()
+{
+	if (fBundle) return;
+	fBundle = true;
+	fBundleCount = 0;
+	fBundleAddress = fAddress;
+	fBundlePort = fPort;
+	stream().Clear();
+	stream() << osc::BeginBundleImmediate;
+}
+
+//--------------------------------------------------------------------------
+void OSCStream::flushBundle()
+{
+	if (fBundleCount) {
+		stream() << osc::EndBundle;
+		if (fSocket) {
+			TLock lock(_sendMutex);
+			fSocket->SendTo(IpEndpointName (fBundleAddress, fBundlePort), stream().Data(), stream().Size());
+		}
+		stream().Clear();
+		stream() << osc::BeginBundleImmediate;
+		fBundleCount = 0;
+	}
+}
+
+//--------------------------------------------------------------------------
+void OSCStream::endBundle()
+{
+	if (fBundle) {
+		flushBundle();
+		stream().Clear();
+		fBundle = false;
 	}
 }
 
@@ -53,10 +53,15 @@ typedef struct OSCEnd {} OSCEnd;
 //--------------------------------------------------------------------------
 /*!
 \brief	OSC output streams
+
+	Between beginBundle() and endBundle(), the messages are not sent one by one
+	but collected into OSC bundles. The messages are written in place in the
+	stream buffer and a bundle is sent as soon as it exceeds kBundleSize, which
+	keeps the packets below the usual ethernet MTU.
 */
 class OSCStream 
 {
-	enum		{ kOutBufferSize = 16384 };
+	enum		{ kOutBufferSize = 16384, kBundleSize = 1024 };
 	enum state	{ kIdle, kInProgress };
 	
 	state		fState;
@@ -64,6 +69,11 @@ class OSCStream
 	unsigned long fAddress;			// the destination IP address
 	char		fBuffer[kOutBufferSize];
 
+	bool		fBundle;			// true when collecting messages into a bundle
+	int			fBundleCount;		// the number of messages in the current bundle
+	int			fBundlePort;		// the current bundle destination UDP port
+	unsigned long fBundleAddress;	// the current bundle destination IP address
+
 	osc::OutboundPacketStream	fOutStream;
 	UdpSocket*					fSocket;
 	
@@ -76,7 +86,8 @@ class OSCStream
 	static void stop();
 
         OSCStream(UdpSocket* socket) 
-            : fState(kIdle), fPort(1024), fAddress(kLocalhost), fOutStream(fBuffer, kOutBufferSize), fSocket(socket) 
+            : fState(kIdle), fPort(1024), fAddress(kLocalhost), fBundle(false), fBundleCount(0), fBundlePort(1024), fBundleAddress(kLocalhost),
+              fOutStream(fBuffer, kOutBufferSize), fSocket(socket) 
         {
             fSocket->allowBroadcast();
         } 
@@ -92,6 +103,11 @@ class OSCStream
 		OSCStream&			end();
 		void				send(unsigned long ipdest, int port);
 
+		void				beginBundle();		// starts collecting messages into bundles
+		void				endBundle();		// sends the pending bundle and returns to the one message per packet mode
+		void				flushBundle();		// sends the pending bundle (if any) and opens a new one
+		bool				inBundle() const	{ return fBundle; }
+
 		void setPort(int port)							{ fPort = port; }
 		void setAddress(unsigned long address)			{ fAddress = address; }
 		void setAddress(const std::string& address);
@@ -112,9 +128,11 @@ template <typename T>	OSCStream& operator <<(OSCStream& s, const std::vector<T>&
 
 extern OSCStream* _oscout;		// OSC standard output stream
 extern OSCStream* _oscerr;		// OSC standard input stream
+extern OSCStream* _oscxmit;		// OSC stream used by the GUI thread to transmit the zones values
 
 #define oscout (*_oscout)
 #define oscerr (*_oscerr)
+#define oscxmit (*_oscxmit)
 
 } // end namespace
 
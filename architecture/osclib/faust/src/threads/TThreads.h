@@ -73,4 +73,42 @@ class TThreads
 		ThreadHandle fThread;	// the thread handler
 };
 
+//___________________________________________________________________
+/*!
+	\brief cross platform mutex
+
+	Based on pthread on linux and mac and 
+	Windows critical sections on Windows
+*/
+class TMutex
+{
+#ifdef WIN32
+	CRITICAL_SECTION	fMutex;
+	public:
+				 TMutex()		{ InitializeCriticalSection(&fMutex); }
+		virtual ~TMutex()		{ DeleteCriticalSection(&fMutex); }
+		void	lock()			{ EnterCriticalSection(&fMutex); }
+		void	unlock()		{ LeaveCriticalSection(&fMutex); }
+#else
+	pthread_mutex_t		fMutex;
+	public:
+				 TMutex()		{ pthread_mutex_init(&fMutex, 0); }
+		virtual ~TMutex()		{ pthread_mutex_destroy(&fMutex); }
+		void	lock()			{ pthread_mutex_lock(&fMutex); }
+		void	unlock()		{ pthread_mutex_unlock(&fMutex); }
+#endif
+};
+
+//___________________________________________________________________
+/*!
+	\brief scoped lock of a TMutex
+*/
+class TLock
+{
+	TMutex& fMutex;
+	public:
+				 TLock(TMutex& mutex) : fMutex(mutex)	{ fMutex.lock(); }
+		virtual ~TLock()								{ fMutex.unlock(); }
+};
+
 #endif
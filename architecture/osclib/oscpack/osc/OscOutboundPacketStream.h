@@ -96,7 +96,8 @@ public:
     OutboundPacketStream& operator<<( const InfinitumType& rhs );
     OutboundPacketStream& operator<<( int32 rhs );
 
-#ifndef x86_64
+// int32 is 'int' on LP64 systems (see OscTypes.h)
+#if !(defined(x86_64) || defined(__LP64__) || defined(_LP64))
     OutboundPacketStream& operator<<( int rhs )
             { *this << (int32)rhs; return *this; }
 #endif
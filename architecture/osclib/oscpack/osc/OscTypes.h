@@ -49,7 +49,8 @@ typedef unsigned long long uint64;
 
 
 
-#ifdef x86_64
+// 'long' is 64 bits wide on LP64 systems
+#if defined(x86_64) || defined(__LP64__) || defined(_LP64)
 
 typedef signed int int32;
 typedef unsigned int uint32;
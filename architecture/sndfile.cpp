@@ -53,6 +53,7 @@
 #include "faust/gui/FUI.h"
 #include "faust/dsp/dsp.h"
 #include "faust/misc.h"
+#include "faust/audio/sample-format.h"
 
 #ifndef FAUSTFLOAT
 #define FAUSTFLOAT float
@@ -126,11 +127,7 @@ public:
 
   void 	separate()
   {
-    for (int s = 0; s < fNumFrames; s++) {
-      for (int c = 0; c < fNumInputs; c++) {
-        fOutputs[c][s] = fInput[c + s*fNumInputs];
-      }
-    }
+    deinterleaveSamples(fInput, fNumInputs, fNumFrames, fOutputs);
   }
 };
 
@@ -176,11 +173,7 @@ public:
 
   void interleave()
   {
-    for (int s = 0; s < fNumFrames; s++) {
-      for (int c = 0; c < fNumChans; c++) {
-        fOutput[c + s*fNumChans] = fInputs[c][s];
-      }
-    }
+    interleaveSamples(fInputs, fNumChans, fNumFrames, fOutput);
   }
 };
 
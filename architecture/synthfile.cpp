@@ -50,6 +50,8 @@
 #include <time.h>
 #include <vector>
 
+#include "faust/audio/sample-format.h"
+
 // g++ -O3 -lm -lsynthfile  myfx.cpp
 
 using namespace std;
@@ -419,11 +421,7 @@ class Interleaver
 	
 	void 	interleave()
 	{ 	
-		for (int s = 0; s < fNumFrames; s++) {
-			for (int c = 0; c < fNumOutputs; c++) {
-				fOutput[c + s*fNumOutputs] = fInputs[c][s];
-			}
-		}
+		interleaveSamples(fInputs, fNumOutputs, fNumFrames, fOutput);
 	}
 };
 
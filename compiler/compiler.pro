@@ -10,6 +10,7 @@ OBJECTS_DIR = binaries
 QT -= core gui
 
 QMAKE_CXXFLAGS_WARN_ON += -Wno-parentheses -Wno-unused-parameter
+unix:LIBS += -lpthread
 
 INCLUDEPATH += . \
 			   ../architecture \
@@ -82,6 +83,8 @@ HEADERS += boxes/boxcomplexity.h \
            signals/ppsig.hh \
            signals/prim2.hh \
            signals/recursivness.hh \
+           signals/sigcompute.hh \
+           signals/sigmatrix.hh \
            signals/signals.hh \
            signals/sigorderrules.hh \
            signals/sigprint.hh \
@@ -192,6 +195,8 @@ SOURCES += main.cpp \
            signals/ppsig.cpp \
            signals/prim2.cpp \
            signals/recursivness.cpp \
+           signals/sigcompute.cpp \
+           signals/sigmatrix.cpp \
            signals/signals.cpp \
            signals/sigorderrules.cpp \
            signals/sigprint.cpp \
@@ -58,6 +58,8 @@ SVGDev::SVGDev(const char* ficName, double largeur, double hauteur)
 		cout<<"Impossible to create or open "<<ficName<<endl;
         return;
 	}
+	// large diagrams make many small writes
+	setvbuf(fic_repr, 0, _IOFBF, 65536);
 
 	// representation file:
 	fprintf(fic_repr,"<?xml version=\"1.0\"?>\n");
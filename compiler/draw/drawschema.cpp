@@ -33,6 +33,10 @@
 #include <sys/types.h>
 #include <errno.h>
 #include <string.h>
+#ifndef WIN32
+#include <pthread.h>
+#include <unistd.h>
+#endif
 
 #include <ostream>
 #include <sstream>
@@ -50,7 +54,6 @@
 #include "devLib.h"
 #include "ppbox.hh"
 #include "xtended.hh"
-#include "occurrences.hh"
 #include "boxcomplexity.h"
 
 #include "schema.h"
@@ -126,16 +129,17 @@ extern int gFoldThreshold;				// max diagram complexity before folding
 
 
 // internal state during drawing
-static Occurrences* 	gOccurrences;
 static bool				sFoldingFlag;		// true with complex block-diagrams
 static stack<Tree>		gPendingExp;		// Expressions that need to be drawn
 static set<Tree>		gDrawnExp;			// Expressions drawn or scheduled so far
 static const char* 		gDevSuffix;			// .svg or .ps used to choose output device
 static string			gSchemaFileName;	// name of schema file beeing generated
 static map<Tree,string>	gBackLink;			// link to enclosing file for sub schema
+static vector<pair<schema*,string> > gSVGFiles;	// svg schemas to render, with their file name
 
 // prototypes of internal functions
 static void 	writeSchemaFile(Tree bd);
+static void 	renderSVGFiles();
 static schema* 	generateDiagramSchema (Tree bd);
 static schema* 	generateInsideSchema(Tree t);
 static void 	scheduleDrawing(Tree t);
@@ -170,6 +174,7 @@ void drawSchema(Tree bd, const char* projname, const char* dev)
 	Tree t; while (pendingDrawing(t)) {
 		writeSchemaFile(t);		// generate all the pending drawing
 	}
+	renderSVGFiles();			// place and write the svg files
 
 	cholddir();					// return to current directory
 }
@@ -214,7 +219,9 @@ static bool pendingDrawing(Tree& t)
 /**
  * Write a top level diagram. A top level diagram
  * is decorated with its definition name property
- * and is drawn in an individual file
+ * and is drawn in an individual file. The svg files
+ * are only generated here, and written later by
+ * renderSVGFiles().
  */
 static void writeSchemaFile(Tree bd)
 {
@@ -224,7 +231,6 @@ static void writeSchemaFile(Tree bd)
 
 	char 			temp[1024];
 
-	gOccurrences = new Occurrences(bd);
     getBoxType (bd, &ins, &outs);
 
 	bool hasname = getDefNameProperty(bd, id); 
@@ -245,10 +251,7 @@ static void writeSchemaFile(Tree bd)
     ts = makeTopSchema(addSchemaOutputs(outs, addSchemaInputs(ins, generateInsideSchema(bd))), 20, s2.str(), link);
 	// draw to the device defined by gDevSuffix
 	if (strcmp(gDevSuffix, "svg") == 0) {
-		SVGDev dev(s1.str().c_str(), ts->width(), ts->height());
-		ts->place(0,0, kLeftRight);
-		ts->draw(dev);
-        { collector c; ts->collectTraits(c); c.draw(dev); }
+		gSVGFiles.push_back(make_pair(ts, s1.str()));
 	} else {
 		PSDev dev(s1.str().c_str(), ts->width(), ts->height());
 		ts->place(0,0, kLeftRight);
@@ -262,6 +265,72 @@ static void writeSchemaFile(Tree bd)
 }
 
 
+//------------------------ rendering the svg files -------------------------
+
+/**
+ * Place and draw a top level schema in its svg file. It only
+ * uses the schema, not the block diagram it comes from.
+ */
+static void renderSVGFile(schema* ts, const string& filename)
+{
+	SVGDev dev(filename.c_str(), ts->width(), ts->height());
+	ts->place(0,0, kLeftRight);
+	ts->draw(dev);
+	{ collector c; ts->collectTraits(c); c.draw(dev); }
+}
+
+#ifndef WIN32
+
+static pthread_mutex_t	gRenderLock = PTHREAD_MUTEX_INITIALIZER;
+static size_t			gRenderNext;		// next svg file to render
+
+static void* renderWorker(void*)
+{
+	while (true) {
+		pthread_mutex_lock(&gRenderLock);
+		size_t i = gRenderNext++;
+		pthread_mutex_unlock(&gRenderLock);
+		if (i >= gSVGFiles.size()) return 0;
+		renderSVGFile(gSVGFiles[i].first, gSVGFiles[i].second);
+	}
+}
+
+/**
+ * Render the svg files on a pool of threads, one per processor. The
+ * schemas are independent of each other, and the file names are
+ * relative to the current directory set by drawSchema().
+ */
+static void renderSVGFiles()
+{
+	long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+	size_t n = (cpus > 1) ? min(size_t(cpus), gSVGFiles.size()) : 1;
+	vector<pthread_t> workers;
+
+	gRenderNext = 0;
+	for (size_t i = 1; i < n; i++) {
+		pthread_t thread;
+		if (pthread_create(&thread, 0, renderWorker, 0) == 0) workers.push_back(thread);
+	}
+	renderWorker(0);
+	for (size_t i = 0; i < workers.size(); i++) {
+		pthread_join(workers[i], 0);
+	}
+	gSVGFiles.clear();
+}
+
+#else
+
+static void renderSVGFiles()
+{
+	for (size_t i = 0; i < gSVGFiles.size(); i++) {
+		renderSVGFile(gSVGFiles[i].first, gSVGFiles[i].second);
+	}
+	gSVGFiles.clear();
+}
+
+#endif
+
+
 /**
  * Transform the definition name property of tree <t> into a
  * legal file name.  The resulting file name is stored in
@@ -362,13 +431,7 @@ static schema* generateDiagramSchema(Tree t)
 
 	//cerr << t << " generateDiagramSchema " << boxpp(t)<< endl;
 
-	if (getDefNameProperty(t, id)) {
-		stringstream 	s; s << tree2str(id);
-		//cerr << t << "\tNAMED : " << s.str() << endl;
-	}
-
-	if ( sFoldingFlag && /*(gOccurrences->getCount(t) > 0) &&*/
-			(boxComplexity(t) > 2) && getDefNameProperty(t, id)) {
+	if ( sFoldingFlag && (boxComplexity(t) > 2) && getDefNameProperty(t, id)) {
 		char 	temp[1024];
 		getBoxType(t, &ins, &outs);
 		stringstream s, l;
@@ -475,12 +538,17 @@ static schema* generateInsideSchema(Tree t)
 }
 
 /**
- * Convert User interface element into a textual representation
+ * Convert User interface element into a textual representation.
+ * The description is kept as a property of the box, as boxpp()
+ * is expensive and the same elements are drawn in several files.
  */
+property<string> gUserInterfaceDescriptionProperty;
+
 static void UserInterfaceDescription(Tree box, string& d)
 {
     Tree    t1, label, cur, min, max, step;
     stringstream 	fout;
+    if (gUserInterfaceDescriptionProperty.get(box, d)) return;
     // user interface
          if (isBoxButton(box, label))	fout << "button(" << extractName(label) << ')';
     else if (isBoxCheckbox(box, label))	fout << "checkbox(" << extractName(label) << ')';
@@ -534,6 +602,7 @@ static void UserInterfaceDescription(Tree box, string& d)
         exit(0);
     }
     d = fout.str();
+    gUserInterfaceDescriptionProperty.set(box, d);
 }
 
 
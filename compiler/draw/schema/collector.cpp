@@ -22,33 +22,55 @@
 
 #include "schema.h"
 #include <assert.h>
+#include <map>
+#include <vector>
 
 using namespace std;
 
 
+/**
+ * A trait is visible when it is connected to a real output on one side and
+ * to a real input on the other side, possibly through other traits. The real
+ * outputs are propagated along the traits from their start to their end, and
+ * the real inputs from their end to their start, each point only once.
+ */
 void collector::computeVisibleTraits()
 {
-    bool modified;
+    map<point, vector<const trait*> > starting;     // traits by start point
+    map<point, vector<const trait*> > ending;       // traits by end point
 
-    do {
-        modified = false;
-        for (set<trait>::iterator p = fTraits.begin(); p != fTraits.end(); p++) {
-            if (fWithInput.count(*p) == 0) {        // not connected to a real output
-                if (fOutputs.count(p->start) > 0) {
-                    fWithInput.insert(*p);          // the cable is connected to a real output
-                    fOutputs.insert(p->end);        // end become a real output too
-                    modified = true;
-                }
+    for (set<trait>::iterator p = fTraits.begin(); p != fTraits.end(); p++) {
+        starting[p->start].push_back(&*p);
+        ending[p->end].push_back(&*p);
+    }
+
+    vector<point> todo(fOutputs.begin(), fOutputs.end());
+    while (!todo.empty()) {
+        map<point, vector<const trait*> >::iterator q = starting.find(todo.back());
+        todo.pop_back();
+        if (q == starting.end()) continue;
+        for (size_t i = 0; i < q->second.size(); i++) {
+            const trait* t = q->second[i];
+            fWithInput.insert(*t);                  // the cable is connected to a real output
+            if (fOutputs.insert(t->end).second) {   // end become a real output too
+                todo.push_back(t->end);
             }
-            if (fWithOutput.count(*p) == 0) {       // not connected to a real input
-                if (fInputs.count(p->end) > 0) {
-                    fWithOutput.insert(*p);         // the cable is connected to a real input
-                    fInputs.insert(p->start);       // start become a real input too
-                    modified = true;
-                }
+        }
+    }
+
+    todo.assign(fInputs.begin(), fInputs.end());
+    while (!todo.empty()) {
+        map<point, vector<const trait*> >::iterator q = ending.find(todo.back());
+        todo.pop_back();
+        if (q == ending.end()) continue;
+        for (size_t i = 0; i < q->second.size(); i++) {
+            const trait* t = q->second[i];
+            fWithOutput.insert(*t);                 // the cable is connected to a real input
+            if (fInputs.insert(t->start).second) {  // start become a real input too
+                todo.push_back(t->start);
             }
         }
-    } while (modified);
+    }
 }
 
 bool collector::isVisible(const trait& t)
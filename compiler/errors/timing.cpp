@@ -1,14 +1,22 @@
 #include <iostream>
 #include <cassert>
+#include <cstdio>
+#include <ctime>
+#include <string>
+#include <vector>
 #ifndef WIN32
 #include <sys/time.h>
+#include <sys/resource.h>
+#include <unistd.h>
 #endif
 #include "compatibility.hh"
 #include "timing.hh"
+#include "tree.hh"
 
 using namespace std;
 
 extern bool gTimingSwitch;
+extern string gTraceFile;
 
 #if 1
 double mysecond()
@@ -20,6 +28,176 @@ double mysecond()
         return ( (double) tp.tv_sec + (double) tp.tv_usec * 1.e-6 );
 }
 
+/*****************************************************************************
+                            Phases
+*****************************************************************************/
+
+// a phase in progress
+struct phase {
+    string  fName;
+    double  fStartTime;         // wall clock time, in seconds
+    clock_t fStartClock;        // CPU time
+    int     fStartTrees;        // number of trees at the beginning of the phase
+};
+
+static vector<phase> gPhases;
+
+// peak resident set size of the compiler, in kB (0 when unknown)
+static long peakMemory()
+{
+#ifndef WIN32
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+        #ifdef __APPLE__
+        return usage.ru_maxrss / 1024;      // in bytes on OS X
+        #else
+        return usage.ru_maxrss;
+        #endif
+    }
+#endif
+    return 0;
+}
+
+/*****************************************************************************
+                            Chrome trace file
+
+    The phases are written as "complete" events ("ph":"X") of the Trace Event
+    Format, readable by chrome://tracing or Perfetto. Each event is written
+    when its phase ends, with the memory of the compiler and the state of the
+    tree hash table at that time.
+*****************************************************************************/
+
+static FILE*    gTrace = 0;
+static string   gTraceName;             // name of the file gTrace writes to
+static double   gTraceOrigin = 0;       // start of the first phase, in seconds
+static int      gTraceEvents = 0;
+
+static void closeTraceAtExit()
+{
+    closeTrace();
+}
+
+// open the trace file when needed, and return false if there is none
+static bool openTrace()
+{
+    if (gTraceName != gTraceFile) {
+        // a trace inherited from the server process : keep it as it is
+        if (gTrace) fclose(gTrace);
+        gTrace = 0;
+        gTraceName = gTraceFile;
+        if (gTraceFile != "") {
+            gTrace = fopen(gTraceFile.c_str(), "w");
+            if (!gTrace) {
+                cerr << "WARNING : can't open trace file " << gTraceFile << endl;
+                return false;
+            }
+            static bool registered = false;
+            if (!registered) {
+                atexit(closeTraceAtExit);
+                registered = true;
+            }
+            gTraceEvents = 0;
+            fprintf(gTrace, "[");
+        }
+    }
+    return gTrace != 0;
+}
+
+// escape a phase name for a JSON string
+static string jsonString(const string& s)
+{
+    string res;
+    for (size_t i = 0; i < s.size(); i++) {
+        char c = s[i];
+        if (c == '"' || c == '\\') {
+            res += '\\';
+            res += c;
+        } else if ((unsigned char)c < ' ') {
+            res += ' ';
+        } else {
+            res += c;
+        }
+    }
+    return res;
+}
+
+static int processId()
+{
+#ifndef WIN32
+    return int(getpid());
+#else
+    return 0;
+#endif
+}
+
+static void traceEvent(const phase& p, double end, clock_t endClock)
+{
+    if (!openTrace()) return;
+
+    int  trees  = CTree::gTreeCount;
+    long memory = peakMemory();
+    fprintf(gTrace, "%s\n{\"name\":\"%s\",\"cat\":\"faust\",\"ph\":\"X\",\"pid\":%d,\"tid\":0,\"ts\":%.0f,\"dur\":%.0f,"
+                    "\"args\":{\"cpu_ms\":%.3f,\"peak_rss_kb\":%ld,\"trees\":%d,\"new_trees\":%d,"
+                    "\"hash_load\":%.4f,\"hash_entries\":%d,\"properties\":%ld}}",
+            (gTraceEvents++ ? "," : ""), jsonString(p.fName).c_str(), processId(),
+            (p.fStartTime - gTraceOrigin) * 1e6, (end - p.fStartTime) * 1e6,
+            double(endClock - p.fStartClock) * 1000. / CLOCKS_PER_SEC, memory, trees, trees - p.fStartTrees,
+            double(trees) / CTree::hashTableSize(), CTree::gUsedEntries, CTree::gPropertyCount);
+    fprintf(gTrace, ",\n{\"name\":\"memory\",\"ph\":\"C\",\"pid\":%d,\"tid\":0,\"ts\":%.0f,\"args\":{\"peak_rss_kb\":%ld,\"trees\":%d}}",
+            processId(), (end - gTraceOrigin) * 1e6, memory, trees);
+    // the compiler may end with exit() at any time
+    fflush(gTrace);
+}
+
+void closeTrace()
+{
+    if (gTrace) {
+        fprintf(gTrace, "\n]\n");
+        fclose(gTrace);
+        gTrace = 0;
+    }
+}
+
+/*****************************************************************************
+                            startTrace/endTrace
+*****************************************************************************/
+
+void startTrace (const string& msg)
+{
+    if (gTraceFile != "") {
+        phase p;
+        p.fName = msg;
+        p.fStartTime = mysecond();
+        p.fStartClock = clock();
+        p.fStartTrees = CTree::gTreeCount;
+        if (gTraceOrigin == 0) gTraceOrigin = p.fStartTime;
+        gPhases.push_back(p);
+    }
+}
+
+void endTrace (const string& msg)
+{
+    if (gTraceFile != "" && gPhases.size() > 0) {
+        assert(gPhases.back().fName == msg);
+        traceEvent(gPhases.back(), mysecond(), clock());
+        gPhases.pop_back();
+    }
+}
+
+void endTrace (const string& msg, const string& name)
+{
+    if (gTraceFile != "" && gPhases.size() > 0) {
+        assert(gPhases.back().fName == msg);
+        gPhases.back().fName = name;
+        traceEvent(gPhases.back(), mysecond(), clock());
+        gPhases.pop_back();
+    }
+}
+
+/*****************************************************************************
+                            startTiming/endTiming
+*****************************************************************************/
+
 int		lIndex=0;
 double 	lStartTime[1024];
 double 	lEndTime[1024];
@@ -27,7 +205,7 @@ double 	lEndTime[1024];
 static void tab (int n, ostream& fout)
 {
         fout << '\n';
-        while (n--)     fout << '\t'; 
+        while (n--)     fout << '\t';
 }
 
 void startTiming (const char* msg)
@@ -37,10 +215,12 @@ void startTiming (const char* msg)
         tab(lIndex, cerr); cerr << "start " << msg << endl;
         lStartTime[lIndex++] = mysecond();
     }
+    startTrace(msg);
 }
 
 void endTiming (const char* msg)
 {
+    endTrace(msg);
     if (gTimingSwitch) {
         assert(lIndex>0);
         lEndTime[--lIndex] = mysecond();
@@ -56,5 +236,16 @@ void startTiming (const char* msg)
 void endTiming (const char* msg)
 {}
 
-#endif
+void startTrace (const string& msg)
+{}
 
+void endTrace (const string& msg)
+{}
+
+void endTrace (const string& msg, const string& name)
+{}
+
+void closeTrace()
+{}
+
+#endif
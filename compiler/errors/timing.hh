@@ -1,6 +1,8 @@
+
 #ifndef __TIMING__
 #define __TIMING__
 
+#include <string>
 
 // use startTiming("foo") and endTiming("foo") to measure the execution time of a portion of code
 // edit timing.cpp de unactivate the code
@@ -9,6 +11,17 @@ void startTiming (const char* msg);
 
 void endTiming (const char* msg);
 
-#endif
+// with -trace <file>, the phases (startTiming/endTiming included) are written with their time
+// and memory use in a Chrome trace JSON file. startTrace/endTrace are not displayed by -time,
+// and are meant for the frequent phases, like the compilation of each loop.
+
+void startTrace (const std::string& msg);
 
+void endTrace (const std::string& msg);
 
+// end the phase started with msg, whose name is only known at its end (the loops)
+void endTrace (const std::string& msg, const std::string& name);
+
+void closeTrace ();
+
+#endif
@@ -7,14 +7,158 @@
 
 //-----------------------new environment management----------------------------
 //
-// The environement is made of layers. Each layer contains a set of definitions
-// stored as properties of the layer. Each definition can refers to other
+// The environement is made of layers. Each layer contains a set of definitions.
+// Each definition can refers to other
 // definitions of the same layer or of subsequent layers. Recursive
 // definitions are not allowed. Multiple defintions of the same symbol
 // in a layer is allowed but generate a warning when the definition is
 // different
+//
+// A layer is the tree ENV_LAYER(parent, p) where p points to its EnvLayer
+// description (which also makes its hash key unique). Besides its own definitions, each layer has a
+// persistent hash array mapped trie (HAMT) of all the definitions visible
+// from it : its own definitions inserted in the map of its parent. An
+// insertion only copies the nodes of one path (at most 7), all other nodes
+// are shared with the parent map, and looking up a symbol costs a few
+// indexed accesses whatever the depth of the environment.
 //-----------------------------------------------------------------------------
 
+struct EnvDef {
+    Tree            fId;
+    Tree            fDef;
+    struct EnvLayer* fLayer;        ///< layer where fId is defined
+};
+
+struct EnvNode {
+    unsigned int    fDefMap;        ///< slots of this level holding a definition
+    unsigned int    fNodeMap;       ///< slots of this level holding a sub-node
+    vector<EnvDef>  fDefs;          ///< in slot order (or unordered in a collision node)
+    vector<const EnvNode*> fNodes;  ///< in slot order
+    EnvNode() : fDefMap(0), fNodeMap(0) {}
+};
+
+struct EnvLayer {
+    Tree            fLayer;
+    const EnvNode*  fMap;           ///< all the definitions visible from this layer
+    int             fBarriers;      ///< number of barriers below this layer
+    Tree            fEvalKey;       ///< memoization key of the evaluations in this layer
+    vector<Tree>    fIds;           ///< definitions of this layer
+    vector<Tree>    fDefs;
+};
+
+static Sym              ENVLAYER = symbol("ENV_LAYER");
+static Node             EVALPROPERTY(symbol("EvalProperty"));
+
+static const int        kEnvBits = 5;
+static const int        kEnvMaxShift = 32;
+
+static unsigned int envHash(Tree id)
+{
+    unsigned long long p = (unsigned long long)(size_t)id;
+    unsigned int h = (unsigned int)(p >> 3) ^ (unsigned int)(p >> 35);
+    h *= 0x9E3779B1;
+    return h ^ (h >> 16);
+}
+
+static int envSlot(unsigned int map, unsigned int bit)
+{
+    unsigned int x = map & (bit - 1);
+    int n = 0;
+    for (; x; x &= x - 1) n++;
+    return n;
+}
+
+static const EnvDef* envFind(const EnvNode* node, Tree id)
+{
+    unsigned int hash = envHash(id);
+    for (int shift = 0; node; shift += kEnvBits) {
+        if (shift >= kEnvMaxShift) {
+            for (size_t i = 0; i < node->fDefs.size(); i++) {
+                if (node->fDefs[i].fId == id) return &node->fDefs[i];
+            }
+            return 0;
+        }
+        unsigned int bit = 1U << ((hash >> shift) & 31);
+        if (node->fDefMap & bit) {
+            const EnvDef& d = node->fDefs[envSlot(node->fDefMap, bit)];
+            return (d.fId == id) ? &d : 0;
+        } else if (node->fNodeMap & bit) {
+            node = node->fNodes[envSlot(node->fNodeMap, bit)];
+        } else {
+            return 0;
+        }
+    }
+    return 0;
+}
+
+/**
+ * Return a new map where def replaces (or is added to) the definitions of node,
+ * which is not modified.
+ */
+static const EnvNode* envInsert(const EnvNode* node, const EnvDef& def, int shift)
+{
+    EnvNode* res = node ? new EnvNode(*node) : new EnvNode();
+
+    if (shift >= kEnvMaxShift) {
+        // collision node : all hash bits are equal
+        for (size_t i = 0; i < res->fDefs.size(); i++) {
+            if (res->fDefs[i].fId == def.fId) {
+                res->fDefs[i] = def;
+                return res;
+            }
+        }
+        res->fDefs.push_back(def);
+        return res;
+    }
+
+    unsigned int bit = 1U << ((envHash(def.fId) >> shift) & 31);
+    if (res->fDefMap & bit) {
+        int i = envSlot(res->fDefMap, bit);
+        if (res->fDefs[i].fId == def.fId) {
+            res->fDefs[i] = def;
+        } else {
+            // two symbols in the same slot : move them to a sub-node
+            const EnvNode* sub = envInsert(envInsert(0, res->fDefs[i], shift + kEnvBits), def, shift + kEnvBits);
+            res->fDefs.erase(res->fDefs.begin() + i);
+            res->fDefMap &= ~bit;
+            res->fNodes.insert(res->fNodes.begin() + envSlot(res->fNodeMap, bit), sub);
+            res->fNodeMap |= bit;
+        }
+    } else if (res->fNodeMap & bit) {
+        int i = envSlot(res->fNodeMap, bit);
+        res->fNodes[i] = envInsert(res->fNodes[i], def, shift + kEnvBits);
+    } else {
+        res->fDefs.insert(res->fDefs.begin() + envSlot(res->fDefMap, bit), def);
+        res->fDefMap |= bit;
+    }
+    return res;
+}
+
+/**
+ * Return the description of a layer, or 0 for a barrier or nil.
+ */
+static EnvLayer* envLayer(Tree lenv)
+{
+    Tree parent, layer;
+    return isTree(lenv, ENVLAYER, parent, layer) ? (EnvLayer*)layer->node().getPointer() : 0;
+}
+
+static const EnvNode* envMap(Tree lenv)
+{
+    while (!isNil(lenv)) {
+        EnvLayer* layer = envLayer(lenv);
+        if (layer) return layer->fMap;
+        lenv = lenv->branch(0);     // barrier
+    }
+    return 0;
+}
+
+static int envBarriers(Tree lenv)
+{
+    if (isNil(lenv)) return 0;
+    EnvLayer* layer = envLayer(lenv);
+    return layer ? layer->fBarriers : envBarriers(lenv->branch(0)) + 1;
+}
 
 
 /**
@@ -25,7 +169,12 @@
 */
 static Tree pushNewLayer(Tree lenv)
 {
-    return tree(unique("ENV_LAYER"), lenv);
+    EnvLayer* layer = new EnvLayer();
+    layer->fLayer = tree(ENVLAYER, lenv, tree(Node(layer)));
+    layer->fMap = envMap(lenv);
+    layer->fBarriers = envBarriers(lenv);
+    layer->fEvalKey = tree(EVALPROPERTY, layer->fLayer);
+    return layer->fLayer;
 }
 
 
@@ -60,7 +209,29 @@ bool isEnvBarrier(Tree lenv)
 
 
 /**
- * Add a definition (as a property) to the current top level layer. Check
+ * Add (or replace) a definition in the current top level layer.
+ * @param id the symbol id to be defined
+ * @param def the definition to be binded to the symbol id
+ * @param lenv the layer where to add this new definition
+*/
+static void setLayerDef(Tree id, Tree def, Tree lenv)
+{
+    EnvLayer* layer = envLayer(lenv);
+    EnvDef d = { id, def, layer };
+    layer->fMap = envInsert(layer->fMap, d, 0);
+    for (size_t i = 0; i < layer->fIds.size(); i++) {
+        if (layer->fIds[i] == id) {
+            layer->fDefs[i] = def;
+            return;
+        }
+    }
+    layer->fIds.push_back(id);
+    layer->fDefs.push_back(def);
+}
+
+
+/**
+ * Add a definition to the current top level layer. Check
  * and warn for multiple definitions.
  * @param id the symbol id to be defined
  * @param def the definition to be binded to the symbol id
@@ -69,9 +240,9 @@ bool isEnvBarrier(Tree lenv)
 static void addLayerDef(Tree id, Tree def, Tree lenv)
 {
     // check for multiple definitions of a symbol in the same layer
-    Tree olddef;
-    if (getProperty(lenv, id, olddef)) {
-        if (def == olddef) {
+    const EnvDef* old = envFind(envLayer(lenv)->fMap, id);
+    if (old && old->fLayer == envLayer(lenv)) {
+        if (def == old->fDef) {
             evalwarning(getDefFileProp(id), getDefLineProp(id), "equivalent re-definitions of", id);
         } else {
             fprintf(stderr, "%s:%d: ERROR: redefinition of symbols are not allowed : ", getDefFileProp(id), getDefLineProp(id));
@@ -80,7 +251,7 @@ static void addLayerDef(Tree id, Tree def, Tree lenv)
             gErrorCount++;
         }
     }
-    setProperty(lenv, id, def);
+    setLayerDef(id, def, lenv);
 }
 
 
@@ -134,13 +305,55 @@ Tree pushMultiClosureDefs(Tree ldefs, Tree visited, Tree lenv)
  */
 bool searchIdDef(Tree id, Tree& def, Tree lenv)
 {
-    // search the environment until a definition is found
-    // or a barrier (or nil) is reached
+    // the definition must be in a layer above the first barrier (or nil)
+    if (isEnvBarrier(lenv)) return false;
+
+    const EnvDef* d = envFind(envMap(lenv), id);
+    if (d && d->fLayer->fBarriers == envBarriers(lenv)) {
+        def = d->fDef;
+        return true;
+    }
+    return false;
+}
+
+
+/**
+ * Search the whole environment for the definition of a symbol ID.
+ * @param id the symbol ID to search
+ * @param def where to store the definition if any
+ * @param lenv the environment, replaced by the layer where the definition is found
+ * @return true if a definition was found
+ */
+bool findIdDef(Tree id, Tree& def, Tree& lenv)
+{
+    const EnvDef* d = envFind(envMap(lenv), id);
+    if (d) {
+        def = d->fDef;
+        lenv = d->fLayer->fLayer;
+        return true;
+    }
+    return false;
+}
+
+
+/**
+ * Return the property key used to memoize the evaluations made in an
+ * environment. It is built once for each layer.
+ * @param lenv the environment
+ * @return the key
+ */
+Tree envEvalKey(Tree lenv)
+{
+    static Tree nilKey = tree(EVALPROPERTY, nil);
 
-    while (!isEnvBarrier(lenv) && !getProperty(lenv, id, def)) {
-        lenv = lenv->branch(0);
+    EnvLayer* layer = envLayer(lenv);
+    if (layer) {
+        return layer->fEvalKey;
+    } else if (isNil(lenv)) {
+        return nilKey;
+    } else {
+        return tree(EVALPROPERTY, lenv);
     }
-    return !isEnvBarrier(lenv);
 }
 
 /**
@@ -171,12 +384,13 @@ Tree copyEnvReplaceDefs(Tree anEnv, Tree ldefs, Tree visited, Tree curEnv)
     vector<Tree>    ids, clos;
     Tree            copyEnv;
 
-    anEnv->exportProperties(ids, clos);             // get the definitions of the environment
+    ids = envLayer(anEnv)->fIds;                    // get the definitions of the environment
+    clos = envLayer(anEnv)->fDefs;
     copyEnv = pushNewLayer(anEnv->branch(0));       // create new environment with same stack
     updateClosures(clos, anEnv, copyEnv);           // update the closures replacing oldEnv with newEnv
 
 	for (unsigned int i=0; i < clos.size(); i++) {           // transfers the updated definitions to the new environment
-        setProperty(copyEnv, ids[i], clos[i]);
+        setLayerDef(ids[i], clos[i], copyEnv);
     }
 
     while (!isNil(ldefs)) {                         // replace the old definitions with the new ones
@@ -186,7 +400,7 @@ Tree copyEnvReplaceDefs(Tree anEnv, Tree ldefs, Tree visited, Tree curEnv)
         Tree cl = closure(rhs,nil,visited,curEnv);
         stringstream s; s << boxpp(id);
         if (!isBoxCase(rhs)) setDefNameProperty(cl,s.str());
-        setProperty(copyEnv, id, cl);
+        setLayerDef(id, cl, copyEnv);
         ldefs = tl(ldefs);
     }
     return copyEnv;
@@ -8,6 +8,10 @@ Tree pushValueDef(Tree id, Tree def, Tree lenv);
 
 bool searchIdDef(Tree id, Tree& def, Tree lenv);
 
+bool findIdDef(Tree id, Tree& def, Tree& lenv);
+
+Tree envEvalKey(Tree lenv);
+
 Tree pushMultiClosureDefs(Tree ldefs, Tree visited, Tree lenv);
 
 Tree copyEnvReplaceDefs(Tree anEnv, Tree ldefs, Tree visited, Tree curEnv);
@@ -83,6 +83,7 @@ static bool 	isBoxNumeric (Tree in, Tree& out);
 static Tree 	vec2list(const vector<Tree>& v);
 static void 	list2vec(Tree l, vector<Tree>& v);
 static Tree 	listn (int n, Tree e);
+static Tree		libraryEnvironment(Tree eqlst);
 
 static Tree     boxSimplification(Tree box);
 
@@ -109,6 +110,17 @@ Tree evalprocess (Tree eqlist)
 }
 
 
+/* Eval the library definitions of a list of definitions. */
+
+void evallibraries (Tree eqlist)
+{
+	Tree label;
+	for (Tree l = eqlist; !isNil(l); l = tl(l)) {
+		if (isBoxLibrary(tl(hd(l)), label)) eval(tl(hd(l)), nil, nil);
+	}
+}
+
+
 /* Eval a documentation expression. */
 
 Tree evaldocexpr (Tree docexpr, Tree eqlist)
@@ -250,8 +262,6 @@ bool getArgName(Tree t, Tree& id)
 static loopDetector LD(1024, 512);
 
 
-static Node EVALPROPERTY(symbol("EvalProperty"));
-
 /**
  * set the value of box in the environment env
  * @param box the block diagram we have evaluated
@@ -260,7 +270,7 @@ static Node EVALPROPERTY(symbol("EvalProperty"));
  */
 void setEvalProperty(Tree box, Tree env, Tree value)
 {
-    setProperty(box, tree(EVALPROPERTY,env), value);
+    setProperty(box, envEvalKey(env), value);
 }
 
 
@@ -273,7 +283,7 @@ void setEvalProperty(Tree box, Tree env, Tree value)
  */
 bool getEvalProperty(Tree box, Tree env, Tree& value)
 {
-	return getProperty(box, tree(EVALPROPERTY,env), value);
+	return getProperty(box, envEvalKey(env), value);
 }
 
 
@@ -396,7 +406,7 @@ static Tree realeval (Tree exp, Tree visited, Tree localValEnv)
     } else if (isBoxLibrary(exp, label)) {
         const char* fname = tree2str(label);
         Tree eqlst = gReader.expandlist(gReader.getlist(fname));
-        Tree res = closure(boxEnvironment(), nil, nil, pushMultiClosureDefs(eqlst, nil, nil));
+        Tree res = libraryEnvironment(eqlst);
         setDefNameProperty(res, label);
         //cerr << "component is " << boxpp(res) << endl;
         return res;
@@ -1193,12 +1203,8 @@ static Tree evalIdDef(Tree id, Tree visited, Tree lenv)
 	Tree def, name;
 
 	// search the environment env for a definition of symbol id
-	while (!isNil(lenv) && !getProperty(lenv, id, def)) {
-		lenv = lenv->branch(0);
-	}
-
-	// check that the definition exists
-	if (isNil(lenv)) {
+	// and check that it exists
+	if (!findIdDef(id, def, lenv)) {
         evalerror(getUseFileProp(id), getUseLineProp(id), "undefined symbol ", id);
         if (hasDefProp(id)) {
             cerr << *id << " is defined here : " << getDefFileProp(id) << ":" << getDefLineProp(id) << endl;
@@ -1228,6 +1234,26 @@ static Tree evalIdDef(Tree id, Tree visited, Tree lenv)
  * @return [e e e ...] n times
  */
 
+/**
+ * A property to share the environment of a library between all the
+ * library(...) expressions that refer to the same definitions. As the
+ * evaluations are memoized by environment, the definitions of a library
+ * used at several places, or by several programs compiled by the same
+ * process, are then only evaluated once.
+ */
+
+static Tree LIBRARYPROPERTY = tree(symbol("LIBRARYPROPERTY"));
+
+static Tree libraryEnvironment(Tree eqlst)
+{
+	Tree env;
+	if (!getProperty(eqlst, LIBRARYPROPERTY, env)) {
+		env = closure(boxEnvironment(), nil, nil, pushMultiClosureDefs(eqlst, nil, nil));
+		setProperty(eqlst, LIBRARYPROPERTY, env);
+	}
+	return env;
+}
+
 static Tree listn (int n, Tree e)
 {
 	return (n<= 0) ? nil : cons(e, listn(n-1,e));
@@ -1250,6 +1276,25 @@ static bool getPMProperty(Tree t, Tree env, Tree& pm)
 	return getProperty(t, tree(PMPROPERTYNODE, env), pm);
 }
 
+/**
+ * A property to share the automaton of a list of evaluated rules. The
+ * automaton only depends on the evaluated patterns, the right hand sides
+ * being closed at match time in the environment of the case expression, so
+ * that all the environments where the patterns have the same values share it.
+ */
+
+static Tree AUTOMATONPROPERTY = tree(symbol("AUTOMATONPROPERTY"));
+
+static Automaton* makeAutomaton(Tree evrules)
+{
+	Tree ta;
+	if (!getProperty(evrules, AUTOMATONPROPERTY, ta)) {
+		ta = tree((void*)make_pattern_matcher(evrules));
+		setProperty(evrules, AUTOMATONPROPERTY, ta);
+	}
+	return (Automaton*)tree2ptr(ta);
+}
+
 /**
  * Eval a case expression containing a list of pattern matching rules.
  * Creates a boxPatternMatcher containing a pm autamaton a state 
@@ -1263,7 +1308,7 @@ static Tree	evalCase(Tree rules, Tree env)
 {
 	Tree pm;
 	if (!getPMProperty(rules, env, pm)) {
-		Automaton*	a = make_pattern_matcher(evalRuleList(rules, env));
+		Automaton*	a = makeAutomaton(evalRuleList(rules, env));
         pm = boxPatternMatcher(a, 0, listn(len(rules), pushEnvBarrier(env)), rules, nil);
         setPMProperty(rules, env, pm);
 	}
@@ -50,6 +50,13 @@
 Tree evalprocess (Tree eqlist);
 Tree evaldocexpr (Tree docexpr, Tree eqlist);
 
+/**
+ * Eval the library(...) definitions of a list of definitions, which
+ * parses the libraries and prepares their environments.
+ * @param eqlist a list of definitions
+ **/
+void evallibraries (Tree eqlist);
+
 
 /**
  * Push a new layer and add a single definition.
@@ -77,14 +77,14 @@ Compiler::Compiler(const string& name, const string& super, int numInputs, int n
                 : fClass(new Klass(name, super, numInputs, numOutputs, vec)),
                 fNeedToDeleteClass(true), 
                 fUIRoot(uiFolder(cons(tree(0), tree("")))),
-                fDescription(0),fJSON(numInputs, numOutputs)
+                fDescription(0),fJSON(numInputs, numOutputs),fBinary(numInputs, numOutputs)
 {}
 
 Compiler::Compiler(Klass* k)
                 : fClass(k),
                   fNeedToDeleteClass(false), 
                   fUIRoot(uiFolder(cons(tree(0), tree("")))),
-                  fDescription(0),fJSON(k->inputs(), k->outputs())
+                  fDescription(0),fJSON(k->inputs(), k->outputs()),fBinary(k->inputs(), k->outputs())
 {}
 
 
@@ -145,6 +145,7 @@ void Compiler::generateMetaData()
             str1 << *(i->first);
             str2 << **(i->second.begin());
             fJSON.declare(str1.str().c_str(), unquote(str2.str()).c_str());
+            fBinary.declare(str1.str().c_str(), unquote(str2.str()).c_str());
         } else {
             for (set<Tree>::iterator j = i->second.begin(); j != i->second.end(); j++) {
                 if (j == i->second.begin()) {
@@ -152,10 +153,12 @@ void Compiler::generateMetaData()
                     str1 << *(i->first);
                     str2 << **j;
                     fJSON.declare(str1.str().c_str(), unquote(str2.str()).c_str());
+                    fBinary.declare(str1.str().c_str(), unquote(str2.str()).c_str());
                 } else {
                     stringstream str2;
                     str2 << **j;
                     fJSON.declare("contributor", unquote(str2.str()).c_str());
+                    fBinary.declare("contributor", unquote(str2.str()).c_str());
                 }
             }
         }
@@ -190,14 +193,15 @@ void Compiler::generateUserInterfaceTree(Tree t)
             for (set<string>::const_iterator j = values.begin(); j != values.end(); j++) {
                 fClass->addUICode(subst("ui_interface->declare($0, \"$1\", \"$2\");", "0", wdel(key) ,wdel(*j)));
                 fJSON.declare(NULL, wdel(key).c_str(), wdel(*j).c_str());
+                fBinary.declare(NULL, wdel(key).c_str(), wdel(*j).c_str());
             }
         }
         
         //-----------------
 		switch (orient) {
-			case 0 : model = "ui_interface->openVerticalBox(\"$0\");"; fJSON.openVerticalBox(checkNullLabel(t, simplifiedLabel).c_str()); break;
-			case 1 : model = "ui_interface->openHorizontalBox(\"$0\");"; fJSON.openHorizontalBox(checkNullLabel(t, simplifiedLabel).c_str()); break;
-			case 2 : model = "ui_interface->openTabBox(\"$0\");"; fJSON.openTabBox(checkNullLabel(t, simplifiedLabel).c_str()); break;
+			case 0 : model = "ui_interface->openVerticalBox(\"$0\");"; fJSON.openVerticalBox(checkNullLabel(t, simplifiedLabel).c_str()); fBinary.openVerticalBox(checkNullLabel(t, simplifiedLabel).c_str()); break;
+			case 1 : model = "ui_interface->openHorizontalBox(\"$0\");"; fJSON.openHorizontalBox(checkNullLabel(t, simplifiedLabel).c_str()); fBinary.openHorizontalBox(checkNullLabel(t, simplifiedLabel).c_str()); break;
+			case 2 : model = "ui_interface->openTabBox(\"$0\");"; fJSON.openTabBox(checkNullLabel(t, simplifiedLabel).c_str()); fBinary.openTabBox(checkNullLabel(t, simplifiedLabel).c_str()); break;
 			default :
                 fprintf(stderr, "error in user interface generation 1\n");
 				exit(1);
@@ -206,6 +210,7 @@ void Compiler::generateUserInterfaceTree(Tree t)
 		generateUserInterfaceElements(elements);
 		fClass->addUICode("ui_interface->closeBox();");
         fJSON.closeBox();
+        fBinary.closeBox();
 
 	} else if (isUiWidget(t, label, varname, sig)) {
 
@@ -249,6 +254,7 @@ void Compiler::generateWidgetCode(Tree fulllabel, Tree varname, Tree sig)
         for (set<string>::const_iterator j = values.begin(); j != values.end(); j++) {
             fClass->addUICode(subst("ui_interface->declare(&$0, \"$1\", \"$2\");", tree2str(varname), wdel(key), wdel(*j)));
              fJSON.declare(NULL, wdel(key).c_str(), wdel(*j).c_str());
+             fBinary.declare(NULL, wdel(key).c_str(), wdel(*j).c_str());
         }
     }
 
@@ -256,11 +262,13 @@ void Compiler::generateWidgetCode(Tree fulllabel, Tree varname, Tree sig)
         fClass->incUIActiveCount();
 		fClass->addUICode(subst("ui_interface->addButton(\"$0\", &$1);", checkNullLabel(varname, label), tree2str(varname)));
         fJSON.addButton(checkNullLabel(varname, label).c_str(), NULL);
+        fBinary.addButton(checkNullLabel(varname, label).c_str(), NULL);
 
 	} else if ( isSigCheckbox(sig, path) ) 			{
         fClass->incUIActiveCount();
 		fClass->addUICode(subst("ui_interface->addCheckButton(\"$0\", &$1);", checkNullLabel(varname, label), tree2str(varname)));
         fJSON.addCheckButton(checkNullLabel(varname, label).c_str(), NULL);
+        fBinary.addCheckButton(checkNullLabel(varname, label).c_str(), NULL);
 
 	} else if ( isSigVSlider(sig, path,c,x,y,z) )	{
         fClass->incUIActiveCount();
@@ -272,6 +280,7 @@ void Compiler::generateWidgetCode(Tree fulllabel, Tree varname, Tree sig)
                                 T(tree2float(y)),
                                 T(tree2float(z))));
         fJSON.addVerticalSlider(checkNullLabel(varname, label).c_str(), NULL, tree2float(c), tree2float(x), tree2float(y), tree2float(z));
+        fBinary.addVerticalSlider(checkNullLabel(varname, label).c_str(), NULL, tree2float(c), tree2float(x), tree2float(y), tree2float(z));
 
 	} else if ( isSigHSlider(sig, path,c,x,y,z) )	{
         fClass->incUIActiveCount();
@@ -283,6 +292,7 @@ void Compiler::generateWidgetCode(Tree fulllabel, Tree varname, Tree sig)
                                 T(tree2float(y)),
                                 T(tree2float(z))));
         fJSON.addHorizontalSlider(checkNullLabel(varname, label).c_str(), NULL, tree2float(c), tree2float(x), tree2float(y), tree2float(z));
+        fBinary.addHorizontalSlider(checkNullLabel(varname, label).c_str(), NULL, tree2float(c), tree2float(x), tree2float(y), tree2float(z));
 
 	} else if ( isSigNumEntry(sig, path,c,x,y,z) )	{
         fClass->incUIActiveCount();
@@ -294,6 +304,7 @@ void Compiler::generateWidgetCode(Tree fulllabel, Tree varname, Tree sig)
                                 T(tree2float(y)),
                                 T(tree2float(z))));
         fJSON.addNumEntry(checkNullLabel(varname, label).c_str(), NULL, tree2float(c), tree2float(x), tree2float(y), tree2float(z));
+        fBinary.addNumEntry(checkNullLabel(varname, label).c_str(), NULL, tree2float(c), tree2float(x), tree2float(y), tree2float(z));
 
 	} else if ( isSigVBargraph(sig, path,x,y,z) )	{
         fClass->incUIPassiveCount();
@@ -303,6 +314,7 @@ void Compiler::generateWidgetCode(Tree fulllabel, Tree varname, Tree sig)
                                 T(tree2float(x)),
                                 T(tree2float(y))));
         fJSON.addVerticalBargraph(checkNullLabel(varname, label).c_str(), NULL, tree2float(x), tree2float(y));
+        fBinary.addVerticalBargraph(checkNullLabel(varname, label).c_str(), NULL, tree2float(x), tree2float(y));
 
 	} else if ( isSigHBargraph(sig, path,x,y,z) )	{
         fClass->incUIPassiveCount();
@@ -312,6 +324,7 @@ void Compiler::generateWidgetCode(Tree fulllabel, Tree varname, Tree sig)
                                 T(tree2float(x)),
                                 T(tree2float(y))));
         fJSON.addHorizontalBargraph(checkNullLabel(varname, label).c_str(), NULL, tree2float(x), tree2float(y));
+        fBinary.addHorizontalBargraph(checkNullLabel(varname, label).c_str(), NULL, tree2float(x), tree2float(y));
         
 	} else {
 		fprintf(stderr, "Error in generating widget code\n");
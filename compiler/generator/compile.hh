@@ -36,6 +36,7 @@
 
 #include "description.hh"
 #include "faust/gui/JSONUI.h"
+#include "faust/gui/BinaryUI.h"
 
 ////////////////////////////////////////////////////////////////////////
 /**
@@ -56,6 +57,7 @@ protected:
 	Tree			fUIRoot;
 	Description*	fDescription;
     JSONUI          fJSON;
+    BinaryUI        fBinary;        ///< the binary descriptor, same content as fJSON
 
 public:
 	Compiler (const string& name, const string& super, int numInputs, int numOutputs, bool vec);
@@ -50,14 +50,21 @@
 #include "compatibility.hh"
 #include "ppsig.hh"
 #include "sigToGraph.hh"
+#include "sigcompute.hh"
 
 using namespace std;
 
 extern bool     gInPlace;
 extern bool     gDrawSignals;
 extern bool     gPrintJSONSwitch;
+extern bool     gPrintBinarySwitch;
+extern bool     gProfileSwitch;
 extern bool     gDrawSignals;
 extern int      gMaxCopyDelay;
+extern int      gMaxStaticTable;
+extern int      gMinMatrixSize;
+extern int      gMinFIRSize;
+extern int      gFIRBlockSize;
 extern string   gClassName;
 extern string   gMasterDocument;
 
@@ -104,6 +111,7 @@ string ScalarCompiler::getFreshID(const string& prefix)
 *****************************************************************************/
 
 extern bool gDumpNorm;
+extern bool gTimingSwitch;
 
 Tree ScalarCompiler::prepare(Tree LS)
 {
@@ -117,7 +125,9 @@ startTiming("ScalarCompiler::prepare");
  startTiming("second simplification");
 	Tree L2 = simplify(L1);			// simplify by executing every computable operation
  endTiming("second simplification");
+ startTiming("privatise");
 	Tree L3 = privatise(L2);		// Un-share tables with multiple writers
+ endTiming("privatise");
 
 	// dump normal form
 	if (gDumpNorm) {
@@ -125,15 +135,21 @@ startTiming("ScalarCompiler::prepare");
 		exit(0);
 	}
 
+    startTiming("recursivnessAnnotation");
 	recursivnessAnnotation(L3);		// Annotate L3 with recursivness information
+    endTiming("recursivnessAnnotation");
 
     startTiming("typeAnnotation");
         typeAnnotation(L3);				// Annotate L3 with type information
     endTiming("typeAnnotation");
 
+    startTiming("sharingAnalysis");
     sharingAnalysis(L3);			// annotate L3 with sharing count
+    endTiming("sharingAnalysis");
+    startTiming("occurrences markup");
   	fOccMarkup.mark(L3);			// annotate L3 with occurences analysis
-    //annotationStatistics();
+    endTiming("occurrences markup");
+    if (gTimingSwitch) annotationStatistics();
 endTiming("ScalarCompiler::prepare");
 
     if (gDrawSignals) {
@@ -175,10 +191,23 @@ void ScalarCompiler::compileMultiSignal (Tree L)
         fClass->addZone3(subst("$1* output$0 = output[$0];", T(i), xfloat()));
     }
 
+startTiming("code generation");
+	sigMatrix matrix;
+	bool hasMatrix = findOutputMatrix(L, gMinMatrixSize, gMinFIRSize, matrix);
 	for (int i = 0; isList(L); L = tl(L), i++) {
 		Tree sig = hd(L);
+		if (hasMatrix && matrix.isOutput(i)) continue;
+		// with -profile each output gets the cycles of the code first needed to compute it
+		if (gProfileSwitch) fClass->openProfileSection(subst("output$0", T(i)));
 		fClass->addExecCode(subst("output$0[i] = $2$1;", T(i), CS(sig), xcast()));
+		if (gProfileSwitch) fClass->closeProfileSection();
 	}
+	if (hasMatrix) {
+		if (gProfileSwitch) fClass->openProfileSection("output matrix");
+		generateOutputMatrix(matrix);
+		if (gProfileSwitch) fClass->closeProfileSection();
+	}
+endTiming("code generation");
     
     generateMetaData();
 	generateUserInterfaceTree(prepareUserInterfaceTree(fUIRoot));
@@ -190,6 +219,13 @@ void ScalarCompiler::compileMultiSignal (Tree L)
     if (gPrintJSONSwitch) {
         ofstream xout(subst("$0.json", makeDrawPath()).c_str());
         xout << fJSON.JSON();
+    }
+    
+    if (gPrintBinarySwitch) {
+        // Binary descriptor of the same interface, for fast 'proxy_dsp' decoding
+        ofstream bout(subst("$0.fdesc", makeDrawPath()).c_str(), ios::binary);
+        string desc = fBinary.binary();
+        bout.write(desc.data(), desc.size());
     } 
 }
 
@@ -415,9 +451,31 @@ string ScalarCompiler::generateOutput (Tree sig, const string& idx, const string
 							   BINARY OPERATION
 *****************************************************************************/
 
+/**
+ * Test if sig is a FIR filter (see findFIR) that a convolver can compute : the
+ * filters inside a recursion stay direct, as their input, like the recursive
+ * projection itself, is not known before their output. Integer filters stay
+ * direct too, the convolver computing in floating point.
+ */
+static bool findConvolvableFIR(Tree sig, sigFIR& fir)
+{
+    int     i;
+    Tree    rec;
+
+    if (getCertifiedSigType(sig)->nature() != kReal) return false;
+    if (getRecursivness(sig) > 0 || !findFIR(sig, gMinFIRSize, fir)) return false;
+    return !(isProj(fir.fInput, &i, rec) && getRecursivness(fir.fInput) > 0);
+}
+
 string ScalarCompiler::generateBinOp(Tree sig, int opcode, Tree arg1, Tree arg2)
 {
-    if (opcode == kDiv) {
+    sigFIR fir;
+
+    if (findConvolvableFIR(sig, fir)) {
+        // long FIR filter of constant coefficients
+        return generateFIR(sig, fir);
+
+    } else if (opcode == kDiv) {
         // special handling for division, we always want a float division
         Type        t1 = getCertifiedSigType(arg1);
         Type        t2 = getCertifiedSigType(arg2);
@@ -805,6 +863,12 @@ string ScalarCompiler::generateStaticTable(Tree sig, Tree tsize, Tree content)
 
 	assert ( isSigGen(content, g) );
 
+	// tables whose content is known at compile time are directly declared as static const arrays
+	vector<double> values;
+	if (isSigInt(tsize, &size) && (size <= gMaxStaticTable) && computeSigTable(g, size, values)) {
+		return generateConstTable(g, values);
+	}
+
 	if (!getCompiledExpression(content, cexp)) {
 		cexp = setCompiledExpression(content, generateStaticSigGen(content, g));
     } else {
@@ -851,6 +915,140 @@ string ScalarCompiler::generateStaticTable(Tree sig, Tree tsize, Tree content)
 }
 
 
+/**
+ * Declare a read only table whose content has been computed at compile time
+ * as a static const array initialized with the values
+ */
+string ScalarCompiler::generateConstTable(Tree content, const vector<double>& values)
+{
+	string		ctype, vname;
+	int			size = values.size();
+	bool		isint = (getCertifiedSigType(content)->nature() == kInt);
+
+	if (isint) {
+		vname = getFreshID("itbl");
+		ctype = "int";
+	} else {
+		vname = getFreshID("ftbl");
+		ctype = ifloat();
+	}
+
+	// Converts the values into a string : "{a,b,c,...}", 16 values per line
+	stringstream init;
+
+	char sep = '{';
+	for (int i = 0; i < size; i++) {
+		init << sep << ((i % 16 == 0) ? "\n\t" : "") << (isint ? T(int(values[i])) : T(values[i]));
+		sep = ',';
+	}
+	init << "\n};";
+
+	fClass->addDeclCode(subst("static const $0 \t$1[$2];", ctype, vname, T(size)));
+	fClass->getTopParentKlass()->addStaticFields(
+				subst("const $0 \t$1::$2[$3] = ", ctype, fClass->getFullClassName(), vname, T(size))
+				+ init.str());
+
+	return vname;
+}
+
+
+/**
+ * Generate the outputs of a matrix (see findOutputMatrix) with a single
+ * multiply-accumulate kernel : the combined signals are gathered in a vector,
+ * multiplied by the matrix declared as a static const array, and the results
+ * are copied to the outputs. The matrix is stored by input, so that the inner
+ * loop, over the outputs, can be vectorized by the C++ compiler.
+ */
+void ScalarCompiler::generateOutputMatrix(const sigMatrix& matrix)
+{
+	int		inputs = matrix.fInputs.size();
+	int		outputs = matrix.fOutputs.size();
+	string	mname = getFreshID("fMatrix");
+	string	vin = getFreshID("fMatrixIn");
+	string	vout = getFreshID("fMatrixOut");
+
+	// Converts the matrix into a string : "{{a,b,...},{c,d,...},...}", one input per line
+	stringstream init;
+
+	char sep = '{';
+	for (int k = 0; k < inputs; k++) {
+		init << sep << "\n\t{";
+		for (int j = 0; j < outputs; j++) {
+			init << ((j > 0) ? "," : "") << T(matrix.fCoefs[k][j]);
+		}
+		init << "}";
+		sep = ',';
+	}
+	init << "\n};";
+
+	fClass->addDeclCode(subst("static const $0 \t$1[$2][$3];", ifloat(), mname, T(inputs), T(outputs)));
+	fClass->getTopParentKlass()->addStaticFields(
+				subst("const $0 \t$1::$2[$3][$4] = ", ifloat(), fClass->getFullClassName(), mname, T(inputs), T(outputs))
+				+ init.str());
+
+	// the vector of the combined signals
+	string values;
+	for (int k = 0; k < inputs; k++) {
+		Tree x = matrix.fInputs[k];
+		string cexp = CS(x);
+		if (getCertifiedSigType(x)->nature() == kInt) cexp = subst("$0($1)", ifloat(), cexp);
+		values += ((k > 0) ? ", " : "") + cexp;
+	}
+
+	fClass->addExecCode(subst("$0 \t$1[$2] = {$3};", ifloat(), vin, T(inputs), values));
+	fClass->addExecCode(subst("$0 \t$1[$2] = {0};", ifloat(), vout, T(outputs)));
+	fClass->addExecCode(subst("for (int k=0; k<$0; k++) {", T(inputs)));
+	fClass->addExecCode(subst("\tfor (int j=0; j<$0; j++) {", T(outputs)));
+	fClass->addExecCode(subst("\t\t$0[j] += ($1[k][j] * $2[k]);", vout, mname, vin));
+	fClass->addExecCode("\t}");
+	fClass->addExecCode("}");
+	for (int j = 0; j < outputs; j++) {
+		fClass->addExecCode(subst("output$0[i] = $2$1[$3];", T(matrix.fOutputs[j]), vout, xcast(), T(j)));
+	}
+}
+
+
+/**
+ * Default block size of the FFT convolution of a FIR filter of size taps :
+ * the smallest power of 2 (and at least 16) greater than the square root of
+ * size, which balances the taps computed directly and the partitions.
+ */
+static int firBlockSize(int size)
+{
+	int block = 16;
+	while (block * block < size) block *= 2;
+	return block;
+}
+
+/**
+ * Generate a FIR filter (see findFIR) with a fir_convolver : the first taps
+ * are computed directly, the other ones by FFT convolution every B samples.
+ * The filter is the same, but its cost per sample is in O(B + N/B) instead
+ * of O(N). The coefficients are declared as a constant table.
+ */
+string ScalarCompiler::generateFIR(Tree sig, const sigFIR& fir)
+{
+	int		size = fir.fCoefs.size();
+	int		block = (gFIRBlockSize > 0) ? pow2limit(gFIRBlockSize) : firBlockSize(size);
+	string	vname = getFreshID("fConvolver");
+
+	// the partitions only apply to the taps after the first block
+	while (block > 1 && 2*block > size) block /= 2;
+
+	string table = generateConstTable(sig, fir.fCoefs);
+	string cexp = CS(fir.fInput);
+	if (getCertifiedSigType(fir.fInput)->nature() == kInt) cexp = subst("$0($1)", ifloat(), cexp);
+
+	fClass->rememberNeedFIRConvolver();
+	fClass->addDeclCode(subst("fir_convolver<$0,$1,$2> \t$3;", ifloat(), T(size), T(block), vname));
+	fClass->addInitCode(subst("$0.init($1);", vname, table));
+	fClass->addClearCode(subst("$0.clear();", vname));
+
+	// the convolver has a state : it must be called once per sample
+	return generateVariableStore(sig, subst("$0.compute($1)", vname, cexp));
+}
+
+
 /*----------------------------------------------------------------------------
 						sigWRTable : table assignement
 ----------------------------------------------------------------------------*/
@@ -30,6 +30,7 @@
 #include "sigtyperules.hh"
 #include "occurences.hh"
 #include "property.hh"
+#include "sigmatrix.hh"
 
 ////////////////////////////////////////////////////////////////////////
 /**
@@ -111,6 +112,9 @@ class ScalarCompiler : public Compiler
 	
     string          generateTable 		(Tree sig, Tree tsize, Tree content);
     string          generateStaticTable	(Tree sig, Tree tsize, Tree content);
+    string          generateConstTable	(Tree content, const vector<double>& values);
+    void            generateOutputMatrix(const sigMatrix& matrix);
+    string          generateFIR			(Tree sig, const sigFIR& fir);
     string          generateWRTbl 		(Tree sig, Tree tbl, Tree idx, Tree data);
     string          generateRDTbl 		(Tree sig, Tree tbl, Tree idx);
     string          generateSigGen		(Tree sig, Tree content);
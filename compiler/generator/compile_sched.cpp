@@ -24,8 +24,11 @@
 #include "compile_sched.hh"
 #include "floats.hh"
 #include "ppsig.hh"
+#include "timing.hh"
 
 extern int gVecSize;
+extern int gMinMatrixSize;
+extern int gMinFIRSize;
 
 void SchedulerCompiler::compileMultiSignal (Tree L)
 {
@@ -43,12 +46,23 @@ void SchedulerCompiler::compileMultiSignal (Tree L)
     fClass->addSharedDecl("input"); 
     fClass->addSharedDecl("output"); 
     
+    startTiming("code generation");
+    sigMatrix matrix;
+    bool hasMatrix = findOutputMatrix(L, gMinMatrixSize, gMinFIRSize, matrix);
     for (int i = 0; isList(L); L = tl(L), i++) {
         Tree sig = hd(L);
+        if (hasMatrix && matrix.isOutput(i)) continue;
         fClass->openLoop("count");
         fClass->addExecCode(subst("output$0[i] = $2$1;", T(i), CS(sig), xcast()));
-        fClass->closeLoop(sig);
+        fClass->closeLoop(sig, subst("output$0", T(i)));
     }
+    if (hasMatrix) {
+        // the outputs of the matrix are computed in the same loop
+        fClass->openLoop("count");
+        generateOutputMatrix(matrix);
+        fClass->closeLoop(matrix.fSignals[0], "output matrix");
+    }
+    endTiming("code generation");
     
     // Build tasks list 
     fClass->buildTasksList();
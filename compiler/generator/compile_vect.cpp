@@ -26,9 +26,13 @@
 #include "compile_vect.hh"
 #include "floats.hh"
 #include "ppsig.hh"
+#include "timing.hh"
 
 extern int gVecSize;
+extern int gMinMatrixSize;
+extern int gMinFIRSize;
 extern bool gPrintJSONSwitch;
+extern bool gPrintBinarySwitch;
 
 string makeDrawPath();
 
@@ -48,12 +52,23 @@ void VectorCompiler::compileMultiSignal (Tree L)
     fClass->addSharedDecl("input");
     fClass->addSharedDecl("output");
 
+    startTiming("code generation");
+    sigMatrix matrix;
+    bool hasMatrix = findOutputMatrix(L, gMinMatrixSize, gMinFIRSize, matrix);
     for (int i = 0; isList(L); L = tl(L), i++) {
         Tree sig = hd(L);
+        if (hasMatrix && matrix.isOutput(i)) continue;
         fClass->openLoop("count");
         fClass->addExecCode(subst("output$0[i] = $2$1;", T(i), CS(sig), xcast()));
-        fClass->closeLoop(sig);
+        fClass->closeLoop(sig, subst("output$0", T(i)));
     }
+    if (hasMatrix) {
+        // the outputs of the matrix are computed in the same loop
+        fClass->openLoop("count");
+        generateOutputMatrix(matrix);
+        fClass->closeLoop(matrix.fSignals[0], "output matrix");
+    }
+    endTiming("code generation");
 
     generateMetaData();
     generateUserInterfaceTree(prepareUserInterfaceTree(fUIRoot));
@@ -66,9 +81,41 @@ void VectorCompiler::compileMultiSignal (Tree L)
         ofstream xout(subst("$0.json", makeDrawPath()).c_str());
         xout << fJSON.JSON();
     }
+    
+    if (gPrintBinarySwitch) {
+        // Binary descriptor of the same interface, for fast 'proxy_dsp' decoding
+        ofstream bout(subst("$0.fdesc", makeDrawPath()).c_str(), ios::binary);
+        string desc = fBinary.binary();
+        bout.write(desc.data(), desc.size());
+    }
 }
 
 
+/**
+ * Returns the label of the loop computing a signal : the vectors it fills,
+ * all the recursive vectors of a group for a projection
+ */
+string VectorCompiler::loopLabel(Tree sig)
+{
+    int     i;
+    Tree    x, id, body;
+    string  vname;
+
+    if (isProj(sig, &i, x)) sig = x;
+    if (isRec(sig, id, body)) {
+        string label, sep;
+        for (int k = 0; k < len(body); k++) {
+            if (getVectorNameProperty(sigProj(k, sig), vname)) {
+                label += sep + vname;
+                sep = ", ";
+            }
+        }
+        return label;
+    } else {
+        return (getVectorNameProperty(sig, vname)) ? vname : "";
+    }
+}
+
 /**
  * Compile a signal
  * @param sig the signal expression to compile.
@@ -142,7 +189,7 @@ void VectorCompiler::generateCodeRecursions (Tree sig)
         setCompiledExpression(sig, "[RecursionVisited]");
         fClass->openLoop(sig, "count");
         generateRec(sig, id, body);
-        fClass->closeLoop(sig);
+        fClass->closeLoop(sig, loopLabel(sig));
     } else {
         // we go down the expression
         vector<Tree>  subsigs;
@@ -190,13 +237,13 @@ string VectorCompiler::generateLoopCode (Tree sig)
                 // x must be defined
                 fClass->openLoop(x, "count");
                 string c = ScalarCompiler::generateCode(sig);
-                fClass->closeLoop(sig);
+                fClass->closeLoop(sig, loopLabel(sig));
                 return c;
             }
         } else {
             fClass->openLoop("count");
             string c = ScalarCompiler::generateCode(sig);
-            fClass->closeLoop(sig);
+            fClass->closeLoop(sig, loopLabel(sig));
             return c;
         }
     } else {
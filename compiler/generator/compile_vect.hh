@@ -67,6 +67,7 @@ protected:
     virtual string      generateWaveform(Tree sig);
 
     bool    needSeparateLoop(Tree sig);
+    string  loopLabel(Tree sig);
     
 };
 
@@ -49,6 +49,8 @@
 #include "signals.hh"
 #include "ppsig.hh"
 #include "recursivness.hh"
+#include "timing.hh"
+#include "enrobage.hh"
 
 
 extern int  gFloatSize;
@@ -61,6 +63,10 @@ extern int  gVecSize;
 extern bool gUIMacroSwitch;
 extern int  gVectorLoopVariant;
 extern bool	gGroupTaskSwitch;
+extern bool gProfileSwitch;
+extern bool gFieldLayoutSwitch;
+extern bool gMemoryManager;
+extern bool gCopyStateSwitch;
 
 extern map<Tree, set<Tree> > gMetaDataSet;
 static int gTaskCount = 0;
@@ -72,6 +78,7 @@ void tab (int n, ostream& fout)
 }
 
 bool Klass::fNeedPowerDef = false;
+bool Klass::fNeedFIRConvolver = false;
 
 /**
  * Store the loop used to compute a signal
@@ -95,6 +102,7 @@ bool Klass::getLoopProperty(Tree sig, Loop*& l)
  */
 void Klass::openLoop(const string& size)
 {
+    startTrace("loop");
     fTopLoop = new Loop(fTopLoop, size);
     //cerr << "\nOPEN SHARED LOOP(" << size << ") ----> " << fTopLoop << endl;
 }
@@ -106,6 +114,7 @@ void Klass::openLoop(const string& size)
  */
 void Klass::openLoop(Tree recsymbol, const string& size)
 {
+    startTrace("recursive loop");
     fTopLoop = new Loop(recsymbol, fTopLoop, size);
     //cerr << "\nOPEN REC LOOP(" << *recsymbol << ", " << size << ") ----> " << fTopLoop << endl;
 }
@@ -113,13 +122,20 @@ void Klass::openLoop(Tree recsymbol, const string& size)
 /**
  * Close the top loop and either keep it
  * or absorb it within its enclosing loop.
+ * @param sig the signal computed by the loop
+ * @param label what the loop computes (used for profiling)
  */
-void Klass::closeLoop(Tree sig)
+void Klass::closeLoop(Tree sig, const string& label)
 {
     assert(fTopLoop);
     Loop* l = fTopLoop;
     fTopLoop = l->fEnclosingLoop;
     assert(fTopLoop);
+    l->fLabel = label;
+
+    // the trace event is named after the loop, with its profiling label
+    string kind = (l->fIsRecursive) ? "recursive loop" : "loop";
+    endTrace(kind, (label != "") ? kind + " " + label : kind);
 
     //l->println(4, cerr);
     //cerr << endl;
@@ -254,6 +270,59 @@ void Klass::printAdditionalCode(ostream& fout)
 
     }
 
+    if (gFieldLayoutSwitch) {
+        // Add the cache line alignment of the big fields (-hcl)
+        fout << "#ifndef FAUSTALIGN" << endl;
+        fout << "#if defined(_MSC_VER)" << endl;
+        fout << "#define FAUSTALIGN __declspec(align(64))" << endl;
+        fout << "#else" << endl;
+        fout << "#define FAUSTALIGN __attribute__((aligned(64)))" << endl;
+        fout << "#endif" << endl;
+        fout << "#endif" << endl;
+        // Add malloc/free and bad_alloc used by the aligned operator new
+        fout << "#include <stdlib.h>" << endl;
+        fout << "#include <new>" << endl;
+    }
+
+    if (gCopyStateSwitch) {
+        // Add memcpy used by copyState (-cs)
+        fout << "#include <string.h>" << endl;
+    }
+
+    if (gMemoryManager) {
+        // Add malloc/free used when no memory manager is given (-mem)
+        fout << "#include <stdlib.h>" << endl;
+    }
+
+    if (gProfileSwitch) {
+        // Add the cycle counter used by the instrumented loops (-profile)
+        fout << "#ifndef FAUSTCYCLES" << endl;
+        fout << "#define FAUSTCYCLES" << endl;
+        fout << "#include <stdio.h>" << endl;
+        fout << "#if defined(_MSC_VER)" << endl;
+        fout << "#include <intrin.h>" << endl;
+        fout << "inline unsigned long long faustcycles() { return __rdtsc(); }" << endl;
+        fout << "#elif defined(__i386__) || defined(__x86_64__)" << endl;
+        fout << "inline unsigned long long faustcycles() { unsigned int lo, hi; __asm__ __volatile__(\"rdtsc\" : \"=a\" (lo), \"=d\" (hi)); return ((unsigned long long)hi << 32) | lo; }" << endl;
+        fout << "#else" << endl;
+        fout << "#include <time.h>" << endl;
+        fout << "inline unsigned long long faustcycles() { struct timespec ts; clock_gettime(CLOCK_MONOTONIC, &ts); return (unsigned long long)ts.tv_sec * 1000000000ULL + ts.tv_nsec; }" << endl;
+        fout << "#endif" << endl;
+        fout << "#endif" << endl;
+    }
+
+    if (fNeedFIRConvolver) {
+        // Add the FIR convolver (faust/dsp/fir-convolver.h), the generated code does not depend on the architecture files
+        istream* src = open_arch_stream("faust/dsp/fir-convolver.h");
+        if (src) {
+            streamCopy(*src, fout);
+            delete src;
+        } else {
+            cerr << "ERROR : can't include \"faust/dsp/fir-convolver.h\", file not found" << endl;
+            exit(1);
+        }
+    }
+
 }
 
 /**
@@ -577,6 +646,184 @@ void Klass::printGraphDotFormat(ostream& fout)
     fout << "}" << endl;
 }
 
+/**
+ * Returns a label without the characters that would need escaping in C
+ * strings or JSON, truncated to one short line
+ */
+static string escapeLabel(const string& text)
+{
+    string label;
+    for (size_t i = 0; i < text.size() && label.size() < 64; i++) {
+        char c = text[i];
+        if (c == '"') {
+            label += '\'';
+        } else if (c == '\\') {
+            label += '/';
+        } else if (c == '\t' || c == '\n') {
+            label += ' ';
+        } else {
+            label += c;
+        }
+    }
+    if (label.size() < text.size()) label += "...";
+    return label;
+}
+
+/**
+ * Returns the profiling label of a loop : what it computes, as given by the
+ * compiler when the loop was closed, or its index when there is none
+ */
+static string profileLabel(Loop* l)
+{
+    string label = (l->fLabel != "") ? l->fLabel : subst("loop $0", T(l->fProfileIndex));
+    return escapeLabel((l->fIsRecursive) ? "recursive : " + label : label);
+}
+
+/**
+ * Returns the labels of the profiling tables : the profiled loops followed by
+ * the profiled sections of the scalar loop
+ */
+static vector<string> profileLabels(const vector<Loop*>& loops, const vector<string>& sections)
+{
+    vector<string> labels;
+    for (size_t i = 0; i < loops.size(); i++) labels.push_back(profileLabel(loops[i]));
+    for (size_t i = 0; i < sections.size(); i++) labels.push_back(escapeLabel(sections[i]));
+    return labels;
+}
+
+/**
+ * Start a profiled section of the scalar loop : the code added until
+ * closeProfileSection() gets its own cycle counter. Sections follow the top
+ * loop (index 0) in the profiling tables.
+ * @param label what the section computes
+ */
+void Klass::openProfileSection(const string& label)
+{
+    fProfileSections.push_back(label);
+    addExecCode(subst("unsigned long long fProfileStart$0 = faustcycles();", T(int(fProfileSections.size()))));
+}
+
+/**
+ * End the profiled section opened last
+ */
+void Klass::closeProfileSection()
+{
+    int index = int(fProfileSections.size());
+    addExecCode(subst("fProfileCycles[$0] += faustcycles() - fProfileStart$0;", T(index)));
+    addExecCode(subst("fProfileCount[$0]++;", T(index)));
+}
+
+/**
+ * Give an index in the profiling tables to each loop that will be printed, in
+ * execution order. In scalar mode there is only one loop, the top one, and
+ * its sections opened by the compiler.
+ */
+void Klass::numberProfiledLoops()
+{
+    fProfileLoops.clear();
+
+    if (gVectorSwitch) {
+        lgraph G;
+        sortGraph(fTopLoop, G);
+        for (int l=(int)G.size()-1; l>=0; l--) {
+            for (lset::const_iterator p =G[l].begin(); p!=G[l].end(); p++) {
+                if ((*p)->fPreCode.size()+(*p)->fExecCode.size()+(*p)->fPostCode.size() > 0) {
+                    (*p)->fProfileIndex = (int)fProfileLoops.size();
+                    fProfileLoops.push_back(*p);
+                }
+            }
+        }
+    } else {
+        fTopLoop->fProfileIndex = 0;
+        if (fTopLoop->fLabel == "") fTopLoop->fLabel = "compute";
+        fProfileLoops.push_back(fTopLoop);
+    }
+
+    int size = max(1, (int)(fProfileLoops.size() + fProfileSections.size()));
+    addDeclCode(subst("unsigned long long fProfileCycles[$0];", T(size)));
+    addDeclCode(subst("unsigned long long fProfileCount[$0];", T(size)));
+    addClearCode("resetProfile();");
+}
+
+/**
+ * Print the methods giving access to the per instance profiling tables
+ */
+void Klass::printProfileMethods(int n, ostream& fout)
+{
+    vector<string> labels = profileLabels(fProfileLoops, fProfileSections);
+    int size = (int)labels.size();
+
+    tab(n+1,fout); fout << "int getProfileSize() {";
+        tab(n+2,fout); fout << "return " << size << ";";
+    tab(n+1,fout); fout << "}";
+
+    tab(n+1,fout); fout << "const char* getProfileLabel(int index) {";
+        tab(n+2,fout); fout << "static const char* labels[" << max(1, size) << "] = {";
+        for (int i = 0; i < size; i++) {
+            tab(n+3,fout); fout << "\"" << labels[i] << "\"" << ((i < size-1) ? "," : "");
+        }
+        tab(n+2,fout); fout << "};";
+        tab(n+2,fout); fout << "return (index >= 0 && index < " << size << ") ? labels[index] : 0;";
+    tab(n+1,fout); fout << "}";
+
+    tab(n+1,fout); fout << "unsigned long long getProfileCycles(int index) {";
+        tab(n+2,fout); fout << "return fProfileCycles[index];";
+    tab(n+1,fout); fout << "}";
+
+    tab(n+1,fout); fout << "unsigned long long getProfileCount(int index) {";
+        tab(n+2,fout); fout << "return fProfileCount[index];";
+    tab(n+1,fout); fout << "}";
+
+    tab(n+1,fout); fout << "void resetProfile() {";
+        tab(n+2,fout); fout << "for (int i=0; i<" << max(1, size) << "; i++) {";
+            tab(n+3,fout); fout << "fProfileCycles[i] = 0;";
+            tab(n+3,fout); fout << "fProfileCount[i] = 0;";
+        tab(n+2,fout); fout << "}";
+    tab(n+1,fout); fout << "}";
+
+    tab(n+1,fout); fout << "void printProfile(FILE* out) {";
+        tab(n+2,fout); fout << "fprintf(out, \"{\\n\\t\\\"name\\\": \\\"" << fKlassName << "\\\",\\n\\t\\\"loops\\\": [\\n\");";
+        tab(n+2,fout); fout << "for (int i=0; i<" << size << "; i++) {";
+            tab(n+3,fout); fout << "fprintf(out, \"\\t\\t{ \\\"index\\\": %d, \\\"label\\\": \\\"%s\\\", \\\"count\\\": %llu, \\\"cycles\\\": %llu }%s\\n\", "
+                                << "i, getProfileLabel(i), fProfileCount[i], fProfileCycles[i], (i < " << size-1 << ") ? \",\" : \"\");";
+        tab(n+2,fout); fout << "}";
+        tab(n+2,fout); fout << "fprintf(out, \"\\t]\\n}\\n\");";
+    tab(n+1,fout); fout << "}";
+}
+
+/**
+ * Print the description of the profiled loops in JSON format : their index
+ * in the profiling tables, their label and the loops they depend on. The
+ * sections of the scalar loop follow, without dependencies.
+ */
+void Klass::printProfileDescription(ostream& fout)
+{
+    vector<string> labels = profileLabels(fProfileLoops, fProfileSections);
+
+    fout << "{" << endl;
+    fout << "\t\"name\": \"" << fKlassName << "\"," << endl;
+    fout << "\t\"loops\": [" << endl;
+    for (size_t i = 0; i < labels.size(); i++) {
+        Loop* l = (i < fProfileLoops.size()) ? fProfileLoops[i] : 0;
+        fout << "\t\t{ \"index\": " << i
+             << ", \"recursive\": " << ((l && l->fIsRecursive) ? "true" : "false")
+             << ", \"label\": \"" << labels[i] << "\""
+             << ", \"dependencies\": [";
+        string sep = "";
+        if (l) {
+            for (lset::const_iterator p = l->fBackwardLoopDependencies.begin(); p != l->fBackwardLoopDependencies.end(); p++) {
+                if ((*p)->fProfileIndex >= 0) {
+                    fout << sep << (*p)->fProfileIndex;
+                    sep = ", ";
+                }
+            }
+        }
+        fout << "] }" << ((i < labels.size()-1) ? "," : "") << endl;
+    }
+    fout << "\t]" << endl;
+    fout << "}" << endl;
+}
+
 /**
  * Print the loop graph (used for internals classes)
  */
@@ -763,6 +1010,219 @@ void Klass::printLoopLevelScheduler(int n, int lnum, const lset& L, ostream& fou
     }
 }
 
+// fields bigger than this size (in bytes) are considered as big buffers by the -hcl layout
+static const int kBigFieldSize = 256;
+
+/**
+ * Size in bytes of the fields of a given C type (0 if unknown). FAUSTFLOAT
+ * fields are counted as float fields, their default type, and pointers as
+ * 64 bits pointers.
+ */
+static int typeSize(const string& type)
+{
+    if (type.size() > 0 && type[type.size()-1] == '*') return 8;
+    if (type == "int" || type == "float" || type == "FAUSTFLOAT") return 4;
+    if (type == "double" || type == "unsigned long long") return 8;
+    if (type == "quad" || type == "long double") return 16;
+    return 0;
+}
+
+/**
+ * Analyze a field declaration of the form "type \tname[n1][n2];" and returns
+ * its type and its size in bytes (0 if unknown). The dimensions can be sums
+ * of constants like [32+7].
+ */
+static void analyzeField(const string& decl, string& type, int& size)
+{
+    size_t e = decl.find_last_not_of(" \t;");
+    size_t b = decl.find_last_of(" \t", e);
+    if (e == string::npos || b == string::npos) {
+        type = ""; size = 0;
+        return;
+    }
+    type = decl.substr(0, decl.find_last_not_of(" \t", b)+1);
+    size = typeSize(type);
+
+    string name = decl.substr(b+1, e-b);
+    for (size_t i = name.find('['); size > 0 && i != string::npos; i = name.find('[', i+1)) {
+        int     dim = 0;
+        size_t  j = i+1;
+        while (j < name.size() && name[j] != ']') {
+            if (!isdigit(name[j])) { size = 0; break; }
+            dim += atoi(name.c_str()+j);
+            while (j < name.size() && isdigit(name[j])) j++;
+            if (j < name.size() && name[j] == '+') j++;
+        }
+        size *= dim;
+    }
+}
+
+/**
+ * Print the fields of the class grouped by access pattern (-hcl) : first the
+ * small state used at each sample, then the user interface zones, then the
+ * big buffers (delay lines, tables) each one aligned on a cache line. The
+ * fields of unknown size (objects like the FIR convolvers) are big buffers
+ * too. A comment gives the size of each group.
+ */
+void Klass::printFieldLayout(int n, ostream& fout)
+{
+    list<string>    statics, hot, ui, big;
+    int             hotsize = 0, uisize = 0, bigsize = 0;
+
+    for (list<string>::iterator p = fDeclCode.begin(); p != fDeclCode.end(); p++) {
+        string  type;
+        int     size;
+        analyzeField(*p, type, size);
+        if (p->compare(0, 6, "static") == 0) {
+            statics.push_back(*p);
+        } else if (type == "FAUSTFLOAT") {
+            ui.push_back(*p);
+            uisize += size;
+        } else if (size > kBigFieldSize || size == 0) {
+            big.push_back("FAUSTALIGN " + *p);
+            bigsize += size;
+        } else {
+            hot.push_back(*p);
+            hotsize += size;
+        }
+    }
+
+    tab(n,fout); fout << "// hot state : " << hotsize + 4 << " bytes, user interface : " << uisize
+                      << " bytes, big buffers : " << bigsize << " bytes (" << big.size() << ")"
+                      << ", instance size : about " << hotsize + 4 + uisize + bigsize << " bytes";
+    printlines(n, statics, fout);
+    printlines(n, hot, fout);
+    tab(n,fout); fout << "int fSamplingFreq;";
+    printlines(n, ui, fout);
+    printlines(n, big, fout);
+    fAlignedFields = (int)big.size();
+}
+
+/**
+ * Print the operators new and delete, and their array forms, of a class with
+ * FAUSTALIGN fields (-hcl) : before C++17 'new' ignores the alignment of the
+ * class and only gives the alignment of malloc. The class specific versions
+ * are also used in C++17.
+ */
+void Klass::printAlignedNewMethods(int n, ostream& fout)
+{
+    tab(n,fout); fout << "static void* operator new(size_t size) {";
+        tab(n+1,fout); fout << "void* mem = malloc(size + 64 + sizeof(void*));";
+        tab(n+1,fout); fout << "if (!mem) throw std::bad_alloc();";
+        tab(n+1,fout); fout << "void* ptr = (void*)(((size_t)mem + sizeof(void*) + 63) & ~(size_t)63);";
+        tab(n+1,fout); fout << "((void**)ptr)[-1] = mem;";
+        tab(n+1,fout); fout << "return ptr;";
+    tab(n,fout); fout << "}";
+    tab(n,fout); fout << "static void operator delete(void* ptr) {";
+        tab(n+1,fout); fout << "if (ptr) free(((void**)ptr)[-1]);";
+    tab(n,fout); fout << "}";
+    tab(n,fout); fout << "static void* operator new[](size_t size) { return operator new(size); }";
+    tab(n,fout); fout << "static void operator delete[](void* ptr) { operator delete(ptr); }";
+    tab(n,fout); fout << "static void* operator new(size_t size, void* place) { return place; }";
+    tab(n,fout); fout << "static void operator delete(void* ptr, void* place) {}";
+    tab(n,fout); fout << "static void* operator new[](size_t size, void* place) { return place; }";
+    tab(n,fout); fout << "static void operator delete[](void* ptr, void* place) {}";
+}
+
+/**
+ * Replace the big buffers of the class (-mem) by pointers allocated by the
+ * constructor through the memory manager. The static fields are already
+ * shared by all the instances and are kept unchanged. The table generator
+ * classes use the memory manager of the top class, in which they are nested.
+ */
+void Klass::extractMemoryBuffers()
+{
+    for (list<string>::iterator p = fDeclCode.begin(); p != fDeclCode.end(); p++) {
+        string  type;
+        int     size;
+        analyzeField(*p, type, size);
+        if (p->compare(0, 6, "static") != 0 && size > kBigFieldSize) {
+            size_t  e = p->find_last_not_of(" \t;");
+            size_t  b = p->find_last_of(" \t", e);
+            string  name = p->substr(b+1, p->find('[', b) - b - 1);
+            fMemoryAllocCode.push_back(subst("$0 = static_cast<$1*>(memoryAllocate(sizeof($1) * $2));", name, type, T(size/typeSize(type))));
+            fMemoryFreeCode.push_back(subst("memoryFree($0);", name));
+            fMemoryBufferSize[name] = subst("sizeof($0) * $1", type, T(size/typeSize(type)));
+            *p = subst("$0* \t$1;", type, name);
+        }
+    }
+}
+
+/**
+ * True if big buffers have been extracted from the class or from the classes nested in it (-mem)
+ */
+bool Klass::hasMemoryBuffers()
+{
+    for (list<Klass*>::iterator k = fSubClassList.begin(); k != fSubClassList.end(); k++) {
+        if ((*k)->hasMemoryBuffers()) return true;
+    }
+    return fMemoryAllocCode.size() > 0;
+}
+
+/**
+ * The instances owning buffers allocated by the constructor (-mem) can't be copied
+ */
+void Klass::printMemoryCopyDeclarations(int n, ostream& fout)
+{
+    tab(n,fout); fout << fKlassName << "(const " << fKlassName << "&);";
+    tab(n,fout); fout << fKlassName << "& operator=(const " << fKlassName << "&);\n";
+}
+
+/**
+ * Print the constructor and the destructor allocating and deallocating the
+ * big buffers (-mem), which also start and stop the thread pool of the top
+ * class with -sch.
+ */
+void Klass::printMemoryMethods(int n, ostream& fout)
+{
+    bool pool = gSchedulerSwitch && fParentKlass == 0;
+
+    tab(n,fout); fout << fKlassName << "() {";
+        printlines(n+1, fMemoryAllocCode, fout);
+        if (pool) { tab(n+1,fout); fout << "fThreadPool = DSPThreadPool::Init();"; }
+    tab(n,fout); fout << "}";
+    tab(n,fout); fout << ((fParentKlass == 0) ? "virtual ~" : "~") << fKlassName << "() {";
+        printlines(n+1, fMemoryFreeCode, fout);
+        if (pool) { tab(n+1,fout); fout << "DSPThreadPool::Destroy();"; }
+    tab(n,fout); fout << "}";
+}
+
+/**
+ * Print the copyState and cloneState methods : the state of an initialized
+ * instance (constants, controls, delay lines...) is copied field by field,
+ * which is much faster than running 'init' on a new instance
+ */
+void Klass::printCopyStateMethods(int n, ostream& fout)
+{
+    tab(n,fout); fout << "virtual bool copyState(" << fSuperKlassName << "* src) {";
+    tab(n+1,fout); fout << fKlassName << "* dsp = dynamic_cast<" << fKlassName << "*>(src);";
+    tab(n+1,fout); fout << "if (!dsp) return false;";
+    for (list<string>::iterator p = fDeclCode.begin(); p != fDeclCode.end(); p++) {
+        size_t e = p->find_last_not_of(" \t;");
+        size_t b = p->find_last_of(" \t", e);
+        if (p->compare(0, 6, "static") == 0 || e == string::npos || b == string::npos) continue;
+        string name = p->substr(b+1, e-b);
+        size_t i = name.find('[');
+        if (i != string::npos) {
+            name = name.substr(0, i);
+            tab(n+1,fout); fout << subst("memcpy($0, dsp->$0, sizeof($0));", name);
+        } else if (fMemoryBufferSize.count(name) > 0) {
+            tab(n+1,fout); fout << subst("memcpy($0, dsp->$0, $1);", name, fMemoryBufferSize[name]);
+        } else {
+            tab(n+1,fout); fout << subst("$0 = dsp->$0;", name);
+        }
+    }
+    tab(n+1,fout); fout << "fSamplingFreq = dsp->fSamplingFreq;";
+    tab(n+1,fout); fout << "return true;";
+    tab(n,fout); fout << "}";
+
+    tab(n,fout); fout << "virtual " << fKlassName << "* cloneState() {";
+    tab(n+1,fout); fout << fKlassName << "* dsp = new " << fKlassName << "();";
+    tab(n+1,fout); fout << "dsp->copyState(this);";
+    tab(n+1,fout); fout << "return dsp;";
+    tab(n,fout); fout << "}";
+}
+
 /**
  * Print a full C++ class corresponding to a Faust dsp
  */
@@ -788,15 +1248,39 @@ void Klass::println(int n, ostream& fout)
 
     for (k = fSubClassList.begin(); k != fSubClassList.end(); k++) 	(*k)->println(n+1, fout);
 
-    printlines(n+1, fDeclCode, fout);
-    
-    tab(n+1,fout); fout << "int fSamplingFreq;\n";
+    if (gProfileSwitch) numberProfiledLoops();
+    if (gMemoryManager) extractMemoryBuffers();
+
+    if (gFieldLayoutSwitch) {
+        printFieldLayout(n+1, fout);
+        fout << "\n";
+    } else {
+        printlines(n+1, fDeclCode, fout);
+        tab(n+1,fout); fout << "int fSamplingFreq;\n";
+    }
+
+    if (gMemoryManager && hasMemoryBuffers()) {
+        tab(n+1,fout); fout << "static void* memoryAllocate(size_t size) { return (fManager) ? fManager->allocate(size) : malloc(size); }";
+        tab(n+1,fout); fout << "static void memoryFree(void* ptr) { if (fManager) { fManager->destroy(ptr); } else { free(ptr); } }";
+        if (fMemoryAllocCode.size() > 0) {
+            printMemoryCopyDeclarations(n+1, fout);
+        } else {
+            fout << "\n";
+        }
+    }
 
     tab(n,fout); fout << "  public:";
 
+    if (gMemoryManager) {
+        tab(n+1,fout); fout << "static dsp_memory_manager* fManager;\n";
+        fStaticFields.push_back(subst("dsp_memory_manager* \t$0::fManager = 0;", getFullClassName()));
+    }
+    if (fMemoryAllocCode.size() > 0) printMemoryMethods(n+1, fout);
+    if (fAlignedFields > 0) printAlignedNewMethods(n+1, fout);
+
     printMetadata(n+1, gMetaDataSet, fout);
 
-    if (gSchedulerSwitch) {
+    if (gSchedulerSwitch && fMemoryAllocCode.size() == 0) {
         tab(n+1,fout); fout << fKlassName << "() { "
                             << "fThreadPool = DSPThreadPool::Init(); }";
         
@@ -843,6 +1327,8 @@ void Klass::println(int n, ostream& fout)
     tab(n+1,fout); fout << "virtual "<< fKlassName <<"* clone() {";
         tab(n+2,fout); fout << "return new " << fKlassName << "();";
     tab(n+1,fout); fout << "}";
+
+    if (gCopyStateSwitch) printCopyStateMethods(n+1, fout);
     
     tab(n+1,fout); fout << "virtual int getSampleRate() {";
         tab(n+2,fout); fout << "return fSamplingFreq;";
@@ -852,6 +1338,8 @@ void Klass::println(int n, ostream& fout)
         printlines (n+2, fUICode, fout);
     tab(n+1,fout); fout << "}";
 
+    if (gProfileSwitch) printProfileMethods(n, fout);
+
     printComputeMethod(n, fout);
 
 	tab(n,fout); fout << "};\n" << endl;
@@ -1203,10 +1691,14 @@ void SigIntGenKlass::println(int n, ostream& fout)
 
 		for (k = fSubClassList.begin(); k != fSubClassList.end(); k++) 	(*k)->println(n+1, fout);
 
+		if (gMemoryManager) extractMemoryBuffers();
 		printlines(n+1, fDeclCode, fout);
+		if (fMemoryAllocCode.size() > 0) printMemoryCopyDeclarations(n+1, fout);
 
 	tab(n,fout); fout << "  public:";
 
+		if (fMemoryAllocCode.size() > 0) printMemoryMethods(n+1, fout);
+
 		tab(n+1,fout); fout 	<< "int getNumInputs() { "
 						<< "return " << fNumInputs << "; }";
 		tab(n+1,fout); fout 	<< "int getNumOutputs() { "
@@ -1243,10 +1735,14 @@ void SigFloatGenKlass::println(int n, ostream& fout)
 
 		for (k = fSubClassList.begin(); k != fSubClassList.end(); k++) 	(*k)->println(n+1, fout);
 
+		if (gMemoryManager) extractMemoryBuffers();
 		printlines(n+1, fDeclCode, fout);
+		if (fMemoryAllocCode.size() > 0) printMemoryCopyDeclarations(n+1, fout);
 
 	tab(n,fout); fout << "  public:";
 
+		if (fMemoryAllocCode.size() > 0) printMemoryMethods(n+1, fout);
+
 		tab(n+1,fout); fout 	<< "int getNumInputs() { "
 						<< "return " << fNumInputs << "; }";
 		tab(n+1,fout); fout 	<< "int getNumOutputs() { "
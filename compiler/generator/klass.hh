@@ -41,6 +41,7 @@ using namespace std;
 #include <list>
 #include <set>
 #include <map>
+#include <vector>
 #include "sigtype.hh"
 #include "smartpointer.hh"
 #include "tlib.hh"
@@ -59,6 +60,7 @@ protected:
     // we make it global because several classes may need
     // power def but we want the code to be generated only once
     static bool     fNeedPowerDef;              ///< true when faustpower definition is needed
+    static bool     fNeedFIRConvolver;          ///< true when the fir_convolver definition is needed
 
 
  protected:
@@ -84,6 +86,10 @@ protected:
     list<string>		fClearCode;
 	list<string>		fUICode;
 	list<string>		fUIMacro;
+    list<string>        fMemoryAllocCode;       ///< allocation of the big buffers (-mem)
+    list<string>        fMemoryFreeCode;        ///< deallocation of the big buffers (-mem)
+    map<string, string> fMemoryBufferSize;      ///< size expression of the big buffers (-mem)
+    int                 fAlignedFields;         ///< number of fields aligned on a cache line (-hcl)
 
 #if 0
     list<string>        fSlowDecl;
@@ -103,6 +109,8 @@ protected:
   
     Loop*               fTopLoop;               ///< active loops currently open
     property<Loop*>     fLoopProperty;          ///< loops used to compute some signals
+    vector<Loop*>       fProfileLoops;          ///< loops instrumented with cycle counters (-profile)
+    vector<string>      fProfileSections;       ///< labels of the profiled sections of the scalar loop (-profile)
 
     bool                fVec;
 
@@ -111,7 +119,7 @@ protected:
 	Klass (const string& name, const string& super, int numInputs, int numOutputs, bool __vec = false)
       : 	fParentKlass(0), fKlassName(name), fSuperKlassName(super), fNumInputs(numInputs), fNumOutputs(numOutputs),
             fNumActives(0), fNumPassives(0),
-            fTopLoop(new Loop(0, "count")), fVec(__vec)
+            fAlignedFields(0), fTopLoop(new Loop(0, "count")), fVec(__vec)
 	{}
 
 	virtual ~Klass() 						{}
@@ -125,7 +133,10 @@ protected:
 
     void    openLoop(const string& size);
     void    openLoop(Tree recsymbol, const string& size);
-    void    closeLoop(Tree sig);
+    void    closeLoop(Tree sig, const string& label = "");
+
+    void    openProfileSection(const string& label);   ///< start a profiled section of the scalar loop (-profile)
+    void    closeProfileSection();                      ///< end the profiled section opened last
 
     void    setLoopProperty(Tree sig, Loop* l);     ///< Store the loop used to compute a signal
     bool    getLoopProperty(Tree sig, Loop*& l);    ///< Returns the loop used to compute a signal
@@ -142,6 +153,8 @@ protected:
 
     void rememberNeedPowerDef ()            { fNeedPowerDef = true; }
 
+    void rememberNeedFIRConvolver ()        { fNeedFIRConvolver = true; }
+
 	void collectIncludeFile(set<string>& S);
 
 	void collectLibrary(set<string>& S);
@@ -194,6 +207,17 @@ protected:
     virtual void printLoopGraphInternal(int n, ostream& fout);
     virtual void printGraphDotFormat(ostream& fout);
 
+    virtual void numberProfiledLoops();
+    virtual void printProfileMethods(int n, ostream& fout);
+    virtual void printProfileDescription(ostream& fout);
+    virtual void printFieldLayout(int n, ostream& fout);
+    virtual void printAlignedNewMethods(int n, ostream& fout);
+    virtual void extractMemoryBuffers();
+    virtual bool hasMemoryBuffers();
+    virtual void printMemoryCopyDeclarations(int n, ostream& fout);
+    virtual void printMemoryMethods(int n, ostream& fout);
+    virtual void printCopyStateMethods(int n, ostream& fout);
+
     // experimental
 	virtual void printLoopDeepFirst(int n, ostream& fout, Loop* l, set<Loop*>& visited);
 
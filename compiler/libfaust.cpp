@@ -0,0 +1,317 @@
+/************************************************************************
+ ************************************************************************
+    FAUST compiler
+	Copyright (C) 2003-2017 GRAME, Centre National de Creation Musicale
+    ---------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ ************************************************************************
+ ************************************************************************/
+
+/**
+ * @file libfaust.cpp
+ * The subprocess wrapper of faust/dsp/libfaust.h. Each compilation runs the faust
+ * binary in a new process, created by posix_spawn (CreateProcess on Windows),
+ * which can be called from any thread of the host. The source, the generated
+ * code, the JSON description and the messages of the compiler are files of a
+ * private temporary directory, removed at the end of the compilation.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <spawn.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#endif
+
+#include "faust/dsp/libfaust.h"
+
+using namespace std;
+
+#ifndef WIN32
+extern char** environ;
+#endif
+
+static string readFile(const string& filename)
+{
+    ifstream file(filename.c_str(), ios::binary);
+    stringstream content;
+    content << file.rdbuf();
+    return content.str();
+}
+
+static string toString(int n)
+{
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "%d", n);
+    return buffer;
+}
+
+// base name of a file, without its directory and its extension
+static string baseName(const string& name)
+{
+    size_t slash = name.find_last_of("/\\");
+    string base = (slash == string::npos) ? name : name.substr(slash + 1);
+    size_t dot = base.rfind('.');
+    return (dot == string::npos) ? base : base.substr(0, dot);
+}
+
+static vector<string> commandLine(const faust_options& options)
+{
+    vector<string> args;
+    for (size_t i = 0; i < options.fImportDirs.size(); i++) {
+        args.push_back("-I");
+        args.push_back(options.fImportDirs[i]);
+    }
+    args.push_back("-cn");
+    args.push_back(options.fClassName);
+    if (options.fVectorize) {
+        args.push_back("-vec");
+        args.push_back("-vs");
+        args.push_back(toString(options.fVecSize));
+    }
+    if (options.fScheduler) args.push_back("-sch");
+    if (options.fOpenMP) args.push_back("-omp");
+    if (options.fFloatSize == 2) args.push_back("-double");
+    if (options.fFloatSize == 3) args.push_back("-quad");
+    if (options.fJSON) args.push_back("-json");
+    args.push_back("-t");
+    args.push_back(toString(options.fTimeout));
+    args.insert(args.end(), options.fOptions.begin(), options.fOptions.end());
+    return args;
+}
+
+#ifndef WIN32
+
+/*****************************************************************************
+                                POSIX systems
+*****************************************************************************/
+
+static bool makeDirectory(string& dir)
+{
+    const char* tmp = getenv("TMPDIR");
+    string path = string((tmp && *tmp) ? tmp : "/tmp") + "/faust-XXXXXX";
+    vector<char> buffer(path.begin(), path.end());
+    buffer.push_back(0);
+    if (!mkdtemp(&buffer[0])) return false;
+    dir = &buffer[0];
+    return true;
+}
+
+// remove dir and the files written in it by the compiler
+static void removeDirectory(const string& dir)
+{
+    DIR* d = opendir(dir.c_str());
+    if (d) {
+        struct dirent* entry;
+        while ((entry = readdir(d))) {
+            string name = entry->d_name;
+            if (name == "." || name == "..") continue;
+            string path = dir + "/" + name;
+            struct stat st;
+            if (lstat(path.c_str(), &st) == 0 && S_ISDIR(st.st_mode)) {
+                removeDirectory(path);
+            } else {
+                unlink(path.c_str());
+            }
+        }
+        closedir(d);
+    }
+    rmdir(dir.c_str());
+}
+
+/**
+ * Run the compiler with the arguments args, its output and error output being
+ * written in the files out and err, and return its exit status (-1 if it can't
+ * be run).
+ */
+static int runCompiler(const string& compiler, const vector<string>& args, const string& out, const string& err)
+{
+    vector<char*> argv;
+    argv.push_back(const_cast<char*>(compiler.c_str()));
+    for (size_t i = 0; i < args.size(); i++) argv.push_back(const_cast<char*>(args[i].c_str()));
+    argv.push_back(0);
+
+    posix_spawn_file_actions_t actions;
+    posix_spawnattr_t attributes;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawnattr_init(&attributes);
+    posix_spawn_file_actions_addopen(&actions, 0, "/dev/null", O_RDONLY, 0);
+    posix_spawn_file_actions_addopen(&actions, 1, out.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    posix_spawn_file_actions_addopen(&actions, 2, err.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+    // the compiler doesn't inherit the other file descriptors of the host
+#if defined(POSIX_SPAWN_CLOEXEC_DEFAULT)
+    posix_spawnattr_setflags(&attributes, POSIX_SPAWN_CLOEXEC_DEFAULT);
+#elif defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 34))
+    posix_spawn_file_actions_addclosefrom_np(&actions, 3);
+#endif
+
+    pid_t pid;
+    int res = posix_spawnp(&pid, compiler.c_str(), &actions, &attributes, &argv[0], environ);
+    posix_spawn_file_actions_destroy(&actions);
+    posix_spawnattr_destroy(&attributes);
+    if (res != 0) return -1;
+
+    int status;
+    while (waitpid(pid, &status, 0) < 0) {
+        if (errno != EINTR) return -1;
+    }
+    return (WIFEXITED(status)) ? WEXITSTATUS(status) : -1;
+}
+
+#else
+
+/*****************************************************************************
+                                    Windows
+*****************************************************************************/
+
+static bool makeDirectory(string& dir)
+{
+    static volatile LONG gCount = 0;
+    char tmp[MAX_PATH];
+    if (GetTempPathA(MAX_PATH, tmp) == 0) return false;
+    for (int i = 0; i < 100; i++) {
+        dir = string(tmp) + "faust-" + toString(int(GetCurrentProcessId())) + "-" + toString(int(InterlockedIncrement(&gCount)));
+        if (CreateDirectoryA(dir.c_str(), NULL)) return true;
+        if (GetLastError() != ERROR_ALREADY_EXISTS) return false;
+    }
+    return false;
+}
+
+static void removeDirectory(const string& dir)
+{
+    WIN32_FIND_DATAA entry;
+    HANDLE d = FindFirstFileA((dir + "\\*").c_str(), &entry);
+    if (d != INVALID_HANDLE_VALUE) {
+        do {
+            string name = entry.cFileName;
+            if (name == "." || name == "..") continue;
+            string path = dir + "\\" + name;
+            if (entry.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+                removeDirectory(path);
+            } else {
+                DeleteFileA(path.c_str());
+            }
+        } while (FindNextFileA(d, &entry));
+        FindClose(d);
+    }
+    RemoveDirectoryA(dir.c_str());
+}
+
+// quote an argument for CommandLineToArgvW and the C runtime
+static string quote(const string& arg)
+{
+    string res = "\"";
+    size_t backslashes = 0;
+    for (size_t i = 0; i < arg.size(); i++) {
+        if (arg[i] == '\\') {
+            backslashes++;
+        } else {
+            if (arg[i] == '"') res.append(backslashes + 1, '\\');
+            backslashes = 0;
+        }
+        res += arg[i];
+    }
+    res.append(backslashes, '\\');
+    return res + "\"";
+}
+
+static HANDLE openFile(const string& filename, DWORD access, DWORD creation)
+{
+    SECURITY_ATTRIBUTES security = { sizeof(SECURITY_ATTRIBUTES), NULL, TRUE };
+    return CreateFileA(filename.c_str(), access, FILE_SHARE_READ | FILE_SHARE_WRITE, &security, creation, FILE_ATTRIBUTE_NORMAL, NULL);
+}
+
+static int runCompiler(const string& compiler, const vector<string>& args, const string& out, const string& err)
+{
+    string command = quote(compiler);
+    for (size_t i = 0; i < args.size(); i++) command += " " + quote(args[i]);
+    vector<char> buffer(command.begin(), command.end());
+    buffer.push_back(0);
+
+    HANDLE input = openFile("NUL", GENERIC_READ, OPEN_EXISTING);
+    HANDLE output = openFile(out, GENERIC_WRITE, CREATE_ALWAYS);
+    HANDLE error = openFile(err, GENERIC_WRITE, CREATE_ALWAYS);
+
+    STARTUPINFOA startup;
+    PROCESS_INFORMATION process;
+    ZeroMemory(&startup, sizeof(startup));
+    startup.cb = sizeof(startup);
+    startup.dwFlags = STARTF_USESTDHANDLES;
+    startup.hStdInput = input;
+    startup.hStdOutput = output;
+    startup.hStdError = error;
+
+    BOOL created = CreateProcessA(NULL, &buffer[0], NULL, NULL, TRUE, CREATE_NO_WINDOW, NULL, NULL, &startup, &process);
+    CloseHandle(input);
+    CloseHandle(output);
+    CloseHandle(error);
+    if (!created) return -1;
+
+    DWORD status = DWORD(-1);
+    WaitForSingleObject(process.hProcess, INFINITE);
+    GetExitCodeProcess(process.hProcess, &status);
+    CloseHandle(process.hProcess);
+    CloseHandle(process.hThread);
+    return int(status);
+}
+
+#endif
+
+/*****************************************************************************
+                                compileFaustDSP
+*****************************************************************************/
+
+bool compileFaustDSP(const string& name, const string& source, const faust_options& options, faust_result& result)
+{
+    string dir;
+    result = faust_result();
+    if (!makeDirectory(dir)) {
+        result.fMessages = "ERROR : can't create a temporary directory\n";
+        return false;
+    }
+
+    string base = baseName(name);
+    string file = dir + "/" + ((base == "") ? "process" : base) + ".dsp";
+    string code = dir + "/code.cpp";
+    string messages = dir + "/messages.txt";
+    ofstream(file.c_str(), ios::binary) << source;
+
+    vector<string> args = commandLine(options);
+    args.push_back(file);
+    int res = runCompiler(options.fCompiler, args, code, messages);
+
+    result.fCode = readFile(code);
+    result.fJSON = readFile(file + ".json");
+    result.fMessages = readFile(messages);
+    if (res < 0) result.fMessages += "ERROR : can't run the Faust compiler " + options.fCompiler + "\n";
+    removeDirectory(dir);
+    return res == 0;
+}
@@ -113,6 +113,7 @@ bool			gHelpSwitch 	= false;
 bool			gVersionSwitch 	= false;
 bool            gDetailsSwitch  = false;
 bool            gTimingSwitch   = false;
+string          gTraceFile      = "";           // write the compilation phases as a Chrome trace JSON file
 bool            gDrawSignals    = false;
 bool            gShadowBlur     = false;	// note: svg2pdf doesn't like the blur filter
 bool            gScaledSVG      = false;	// to draw scaled SVG files
@@ -121,6 +122,7 @@ bool            gDrawPSSwitch 	= false;
 bool            gDrawSVGSwitch 	= false;
 bool            gPrintXMLSwitch = false;
 bool            gPrintJSONSwitch = false;
+bool            gPrintBinarySwitch = false;
 bool            gPrintDocSwitch = false;
 bool            gLatexDocSwitch = true;		// Only LaTeX outformat is handled for the moment.
 bool			gStripDocSwitch = false;	// Strip <mdoc> content from doc listings.
@@ -131,6 +133,10 @@ bool			gSimpleNames 	= false;
 bool            gSimplifyDiagrams = false;
 bool			gLessTempSwitch = false;
 int				gMaxCopyDelay	= 16;
+int				gMaxStaticTable	= 65536;
+int				gMinMatrixSize	= 64;
+int				gMinFIRSize		= 256;
+int				gFIRBlockSize	= 0;
 string			gArchFile;
 string			gOutputFile;
 list<string>	gInputFiles;
@@ -163,6 +169,11 @@ bool            gExportDSP      = false;
 list<string>    gImportDirList;                 // dir list enrobage.cpp/fopensearch() searches for imports, etc.
 string          gOutputDir;                     // output directory for additionnal generated ressources : -SVG, XML...etc...
 bool            gInPlace        = false;        // add cache to input for correct in-place computations
+bool            gProfileSwitch  = false;        // instrument the generated loops with cycle counters
+bool            gFieldLayoutSwitch = false;     // group the fields of the generated class by access pattern
+bool            gMemoryManager  = false;        // allocate the big buffers with a dsp_memory_manager
+bool            gCopyStateSwitch = false;       // generate the copyState and cloneState methods
+bool            gServerSwitch   = false;        // compile the requests read on the standard input
 
 // source file injection
 bool            gInjectFlag     = false;        // inject an external source file into the architecture file
@@ -251,6 +262,10 @@ bool process_cmdline(int argc, char* argv[])
             gPrintJSONSwitch = true;
             i += 1;
 
+        } else if (isCmd(argv[i], "-fdesc", "--binary-description")) {
+            gPrintBinarySwitch = true;
+            i += 1;
+
         } else if (isCmd(argv[i], "-tg", "--task-graph")) {
             gGraphSwitch = true;
             i += 1;
@@ -303,6 +318,22 @@ bool process_cmdline(int argc, char* argv[])
             gMaxCopyDelay = atoi(argv[i+1]);
             i += 2;
 
+        } else if (isCmd(argv[i], "-mst", "--max-static-table") && (i+1 < argc)) {
+            gMaxStaticTable = atoi(argv[i+1]);
+            i += 2;
+
+        } else if (isCmd(argv[i], "-mms", "--min-matrix-size") && (i+1 < argc)) {
+            gMinMatrixSize = atoi(argv[i+1]);
+            i += 2;
+
+        } else if (isCmd(argv[i], "-mfs", "--min-fir-size") && (i+1 < argc)) {
+            gMinFIRSize = atoi(argv[i+1]);
+            i += 2;
+
+        } else if (isCmd(argv[i], "-fbs", "--fir-block-size") && (i+1 < argc)) {
+            gFIRBlockSize = atoi(argv[i+1]);
+            i += 2;
+
         } else if (isCmd(argv[i], "-sd", "--simplify-diagrams")) {
             gSimplifyDiagrams = true;
             i += 1;
@@ -350,6 +381,10 @@ bool process_cmdline(int argc, char* argv[])
         } else if (isCmd(argv[i], "-time", "--compilation-time")) {
             gTimingSwitch = true;
             i += 1;
+
+        } else if (isCmd(argv[i], "-trace", "--trace-file") && (i+1 < argc)) {
+            gTraceFile = argv[i+1];
+            i += 2;
             
         // double float options
         } else if (isCmd(argv[i], "-single", "--single-precision-floats")) {
@@ -426,6 +461,26 @@ bool process_cmdline(int argc, char* argv[])
              gInPlace = true;
              i += 1;
 
+         } else if (isCmd(argv[i], "-profile", "--profile")) {
+             gProfileSwitch = true;
+             i += 1;
+
+         } else if (isCmd(argv[i], "-hcl", "--hot-cold-layout")) {
+             gFieldLayoutSwitch = true;
+             i += 1;
+
+         } else if (isCmd(argv[i], "-mem", "--memory-manager")) {
+             gMemoryManager = true;
+             i += 1;
+
+         } else if (isCmd(argv[i], "-cs", "--copy-state")) {
+             gCopyStateSwitch = true;
+             i += 1;
+
+         } else if (isCmd(argv[i], "-server", "--compile-server")) {
+             gServerSwitch = true;
+             i += 1;
+
         } else if (argv[i][0] != '-') {
             const char* url = argv[i];
             if (check_url(url)) {
@@ -449,6 +504,17 @@ bool process_cmdline(int argc, char* argv[])
         exit(-1);
     }   
 
+    if (gProfileSwitch && (gOpenMPSwitch || gSchedulerSwitch)) {
+        std::cerr << "ERROR : 'profile' option can only be used in scalar or vector mode" << endl;
+        exit(-1);
+    }
+
+    // The scheduler thread pool is started by 'init', so it can't be copied
+    if (gCopyStateSwitch && gSchedulerSwitch) {
+        std::cerr << "ERROR : 'copy-state' option can't be used in scheduler mode" << endl;
+        exit(-1);
+    }
+
     return err == 0;
 }
 
@@ -492,17 +558,23 @@ void printhelp()
 	cout << "-sn \t\tuse --simple-names (without arguments) during block-diagram generation\n";
     cout << "-xml \t\tgenerate an XML description file\n";
     cout << "-json \t\tgenerate a JSON description file\n";
+    cout << "-fdesc \t\t--binary-description generate a binary '.fdesc' description file (see faust/gui/BinaryUI.h)\n";
     cout << "-blur \t\tadd a --shadow-blur to SVG boxes\n";
 	cout << "-lb \t\tgenerate --left-balanced expressions\n";
 	cout << "-mb \t\tgenerate --mid-balanced expressions (default)\n";
 	cout << "-rb \t\tgenerate --right-balanced expressions\n";
 	cout << "-lt \t\tgenerate --less-temporaries in compiling delays\n";
 	cout << "-mcd <n> \t--max-copy-delay <n> threshold between copy and ring buffer implementation (default 16 samples)\n";
+	cout << "-mst <n> \t--max-static-table <n> largest read only table computed at compile time as a static const array (default 65536, 0 to disable)\n";
+	cout << "-mms <n> \t--min-matrix-size <n> smallest matrix of constant weights combining signals into several outputs computed by a single multiply-accumulate kernel (default 64, 0 to disable)\n";
+	cout << "-mfs <n> \t--min-fir-size <n> smallest number of taps of the FIR filters of constant coefficients computed by FFT convolution (default 256, 0 to disable)\n";
+	cout << "-fbs <n> \t--fir-block-size <n> block size of the FFT convolution of the FIR filters, a power of 2 : the larger, the longer the computation done every n samples (default depends on the number of taps)\n";
 	cout << "-a <file> \tC++ architecture file\n";
 	cout << "-i \t\t--inline-architecture-files \n";
 	cout << "-cn <name> \t--class-name <name> specify the name of the dsp class to be used instead of mydsp \n";
 	cout << "-t <sec> \t--timeout <sec>, abort compilation after <sec> seconds (default 120)\n";
 	cout << "-time \t\t--compilation-time, flag to display compilation phases timing information\n";
+	cout << "-trace <file> \t--trace-file <file>, write the compilation phases with their time and memory use as a Chrome trace JSON file\n";
     cout << "-o <file> \tC++ output file\n";
     cout << "-vec    \t--vectorize generate easier to vectorize code\n";
     cout << "-vs <n> \t--vec-size <n> size of the vector (default 32 samples)\n";
@@ -523,6 +595,11 @@ void printhelp()
     cout << "-e       \t--export-dsp export expanded DSP (all included libraries) \n";
     cout << "-inpl    \t--in-place generates code working when input and output buffers are the same (in scalar mode only) \n";
     cout << "-inj <f> \t--inject source file <f> into architecture file instead of compile a dsp file\n";
+    cout << "-profile \t--profile instrument each generated loop (each output in scalar mode) with cycle counters and write a -profile.json loop description file\n";
+    cout << "-hcl     \t--hot-cold-layout group the per sample state, the user interface zones and the big buffers (cache line aligned) in the generated class\n";
+    cout << "-mem     \t--memory-manager allocate the big buffers (delay lines) in the constructor with the dsp_memory_manager given in the static 'fManager' field\n";
+    cout << "-cs      \t--copy-state generate the copyState and cloneState methods, which copy the state of an initialized instance of the class\n";
+    cout << "-server  \t--compile-server compile the requests read on the standard input, after the parsing and evaluation of the given files\n";
   	cout << "\nexample :\n";
 	cout << "---------\n";
 
@@ -612,26 +689,16 @@ static void initFaustDirectories()
 
 
 
-int main (int argc, char* argv[])
+/**
+ * Compile the input files with the current options, phases 1.5 to 10
+ * of the compilation. Errors exit the process.
+ */
+static int compileDSP()
 {
     ostream*    dst;
     ifstream*   injcode=0;
     istream*    enrobage=0;
 
-
-	/****************************************************************
-	 1 - process command line
-	*****************************************************************/
-
-	process_cmdline(argc, argv);
-
-	if (gHelpSwitch) 		{ printhelp(); exit(0); }
-	if (gVersionSwitch) 	{ printversion(); exit(0); }
-
-    initFaustDirectories();
-    alarm(gTimeout);
-
-
     /****************************************************************
      1.5 - Check and open some input files
     *****************************************************************/
@@ -675,7 +742,7 @@ int main (int argc, char* argv[])
             streamCopy(*injcode, *dst);
             streamCopyUntilEnd(*enrobage, *dst);
         }
-        exit(0);
+        return 0;
     }
 
     /****************************************************************
@@ -870,7 +937,384 @@ int main (int argc, char* argv[])
         ofstream dotfile(subst("$0.dot", makeDrawPath()).c_str());
         C->getClass()->printGraphDotFormat(dotfile);
     }
+
+    /****************************************************************
+     10 - generate the profiled loops description in JSON format
+    *****************************************************************/
+
+    if (gProfileSwitch) {
+        ofstream profile(subst("$0-profile.json", makeDrawPath()).c_str());
+        C->getClass()->printProfileDescription(profile);
+    }
 	
 	delete C;
 	return 0;
 }
+
+
+#ifndef WIN32
+
+/****************************************************************
+ 					 		COMPILE SERVER
+*****************************************************************/
+
+/**
+ * The compile server reads compile requests on its standard input and
+ * writes the results on its standard output. A request is a header line :
+ *
+ *     compile|learn <name> <size> [option ...]
+ *
+ * followed by the <size> bytes of the source of the Faust program <name>.
+ * The options are separated by spaces and apply in addition to the ones
+ * given to the server. The response is the line :
+ *
+ *     <ok|error> <cpp-size> <json-size> <log-size>
+ *
+ * followed by the generated C++ code, the JSON description (when -json is
+ * used) and the messages written on the error output. 'quit' or the end of
+ * the input stops the server.
+ *
+ * The server parses the libraries, and evaluates the 'process' of the
+ * files given on its command line, once at startup. Each request is then
+ * compiled by a child process which inherits this state and the memoized
+ * evaluations, so that only the new definitions are parsed and evaluated,
+ * and an error only ends the request. A 'learn' request compiled without
+ * error is also evaluated again by the server once answered, to keep its
+ * evaluations for the next requests (typically the successive versions of
+ * the program being edited). As the children then start from a bigger
+ * process, which is slower to fork and to modify, the other programs are
+ * better compiled with 'compile' requests. The library files are checked for modifications at
+ * each request by the incremental source reader.
+ */
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <dirent.h>
+#include <errno.h>
+
+// The response to a request, and the inputs of its compilation for 'learnRequest'
+struct compile_result {
+    string fCode;
+    string fJSON;
+    string fMessages;
+    string fDir;
+    list<string> fInputFiles;
+    list<string> fImportDirs;
+};
+
+static string readFile(const string& filename)
+{
+    ifstream file(filename.c_str(), ios::binary);
+    stringstream content;
+    content << file.rdbuf();
+    return content.str();
+}
+
+static void removeDirectory(const string& path)
+{
+    DIR* dir = opendir(path.c_str());
+    if (dir) {
+        struct dirent* entry;
+        while ((entry = readdir(dir))) {
+            string name = entry->d_name;
+            if (name == "." || name == "..") continue;
+            string sub = path + "/" + name;
+            struct stat st;
+            if (lstat(sub.c_str(), &st) == 0 && S_ISDIR(st.st_mode)) {
+                removeDirectory(sub);
+            } else {
+                unlink(sub.c_str());
+            }
+        }
+        closedir(dir);
+    }
+    rmdir(path.c_str());
+}
+
+static bool definesProcess(Tree eqlist)
+{
+    for (Tree l = eqlist; !isNil(l); l = tl(l)) {
+        if (hd(hd(l)) == boxIdent("process")) return true;
+    }
+    return false;
+}
+
+/**
+ * The compiler errors call exit() : in a child, skip the atexit handlers
+ * and the destructors of the static objects, which belong to the parent.
+ */
+static void childExit()
+{
+    closeTrace();
+    fflush(stdout);
+    fflush(stderr);
+    _exit(1);
+}
+
+/**
+ * Compile the source 'file' of the directory 'dir' in a child process, and
+ * return its exit status. The child writes the C++ code in 'dir/.cpp', its
+ * error output in 'dir/.log', and its input files and import directories
+ * in 'dir/.inputs' for 'learnRequest'.
+ */
+static int compileRequest(const string& dir, const string& file, const vector<string>& options)
+{
+    fflush(stdout);
+    fflush(stderr);
+    pid_t pid = fork();
+
+    if (pid < 0) {
+        return -1;
+
+    } else if (pid == 0) {
+        atexit(childExit);
+        freopen((dir + "/.cpp").c_str(), "w", stdout);
+        freopen((dir + "/.log").c_str(), "w", stderr);
+
+        // forget the state of the server warm-up
+        gInputFiles.clear();
+        gMetaDataSet.clear();
+        gDocVector.clear();
+        gReader.init();
+        gTraceFile = "";
+
+        vector<char*> argv;
+        argv.push_back((char*)"faust");
+        for (size_t i = 0; i < options.size(); i++) argv.push_back((char*)options[i].c_str());
+        argv.push_back((char*)file.c_str());
+        process_cmdline(int(argv.size()), &argv[0]);
+
+        // the results are read from the standard output and next to the source
+        gOutputFile = "";
+        gOutputDir = "";
+
+        ofstream inputs((dir + "/.inputs").c_str());
+        for (list<string>::iterator f = gInputFiles.begin(); f != gInputFiles.end(); f++) inputs << "file " << *f << endl;
+        for (list<string>::iterator d = gImportDirList.begin(); d != gImportDirList.end(); d++) inputs << "import " << *d << endl;
+        inputs.close();
+
+        initFaustDirectories();
+        alarm(gTimeout);
+        int res = compileDSP();
+        closeTrace();
+        cout.flush();
+        fflush(stdout);
+        fflush(stderr);
+        _exit(res);
+
+    } else {
+        int status;
+        while (waitpid(pid, &status, 0) < 0) {
+            if (errno != EINTR) return -1;
+        }
+        return (WIFEXITED(status)) ? WEXITSTATUS(status) : -1;
+    }
+}
+
+/**
+ * Parse and evaluate in the server a 'learn' request which has been
+ * compiled without error, with the same input files and import
+ * directories, so that the next requests reuse its evaluations. An
+ * error ends the process (see compileServer).
+ */
+static void learnRequest(const compile_result& result)
+{
+    list<string> importdirs = gImportDirList;
+
+    gInputFiles = result.fInputFiles;
+    gImportDirList = result.fImportDirs;
+
+    if (!gInputFiles.empty()) {
+        initFaustDirectories();
+        Tree eqlist = nil;
+        for (list<string>::iterator f = gInputFiles.begin(); f != gInputFiles.end(); f++) {
+            eqlist = cons(importFile(tree(f->c_str())), eqlist);
+        }
+        eqlist = gReader.expandlist(eqlist);
+        if (definesProcess(eqlist)) evalprocess(eqlist);
+    }
+
+    gInputFiles.clear();
+    gImportDirList = importdirs;
+}
+
+/**
+ * Compile the source of the program 'name' in a child process, in a new
+ * temporary directory, and return true if the compilation succeeded. The
+ * directory, which holds the source, has to be removed by the caller.
+ */
+static bool compileSource(const string& name, const string& source, const vector<string>& options, compile_result& result)
+{
+    char dirname[] = "/tmp/faust-XXXXXX";
+    if (!mkdtemp(dirname)) {
+        result.fMessages = "ERROR : can't create a temporary directory\n";
+        return false;
+    }
+    string dir = dirname;
+    result.fDir = dir;
+    string base = fxname(name);
+    string file = dir + "/" + ((base == "") ? "process" : base) + ".dsp";
+    ofstream(file.c_str(), ios::binary) << source;
+
+    int res = compileRequest(dir, file, options);
+    result.fCode = readFile(dir + "/.cpp");
+    result.fJSON = readFile(file + ".json");
+    result.fMessages = readFile(dir + "/.log");
+
+    ifstream inputs((dir + "/.inputs").c_str());
+    string kind, path;
+    while ((inputs >> kind) && getline(inputs, path)) {
+        path = path.substr(1);
+        if (kind == "file") result.fInputFiles.push_back(path);
+        if (kind == "import") result.fImportDirs.push_back(path);
+    }
+    inputs.close();
+    return res == 0;
+}
+
+static bool readBytes(FILE* in, string& bytes, size_t size)
+{
+    bytes.resize(size);
+    return (size == 0) || (fread(&bytes[0], 1, size, in) == size);
+}
+
+/**
+ * Parse the files given to the server, evaluate their libraries and their
+ * 'process' definition if any.
+ */
+static void warmServer()
+{
+    gReader.setIncremental(true);
+    for (list<string>::iterator f = gInputFiles.begin(); f != gInputFiles.end(); f++) {
+        startTiming("warm-up");
+        Tree eqlist = gReader.expandlist(gReader.getlist(f->c_str()));
+        evallibraries(eqlist);
+        if (definesProcess(eqlist)) evalprocess(eqlist);
+        endTiming("warm-up");
+    }
+    if (gErrorCount > 0) {
+        cerr << "Total of " << gErrorCount << " errors during the server warm-up" << endl;
+        exit(1);
+    }
+}
+
+// The directory of the 'learn' request being evaluated, removed if the evaluation fails
+static string gLearnDir;
+
+static void learnExit()
+{
+    if (gLearnDir != "") removeDirectory(gLearnDir);
+}
+
+static int serveRequests()
+{
+    string line;
+    while (getline(cin, line)) {
+        istringstream header(line);
+        string command, name, option, source;
+        size_t size = 0;
+        vector<string> options;
+        compile_result result;
+
+        header >> command;
+        if (command == "quit") break;
+        if (command == "") continue;
+
+        // a malformed compile request can't be skipped
+        bool compile = (command == "compile") || (command == "learn");
+        if (!compile || !(header >> name >> size) || !readBytes(stdin, source, size)) {
+            string log = "ERROR : incorrect request \"" + command + "\"\n";
+            printf("error 0 0 %lu\n%s", (unsigned long)log.size(), log.c_str());
+            fflush(stdout);
+            if (compile) break;
+            continue;
+        }
+        while (header >> option) options.push_back(option);
+
+        bool ok = compileSource(name, source, options, result);
+        printf("%s %lu %lu %lu\n", ok ? "ok" : "error", (unsigned long)result.fCode.size(),
+               (unsigned long)result.fJSON.size(), (unsigned long)result.fMessages.size());
+        fwrite(result.fCode.data(), 1, result.fCode.size(), stdout);
+        fwrite(result.fJSON.data(), 1, result.fJSON.size(), stdout);
+        fwrite(result.fMessages.data(), 1, result.fMessages.size(), stdout);
+        fflush(stdout);
+
+        if (ok && command == "learn") {
+            gLearnDir = result.fDir;
+            learnRequest(result);
+            gLearnDir = "";
+        }
+        if (result.fDir != "") removeDirectory(result.fDir);
+    }
+
+    return 0;
+}
+
+/**
+ * The requests are served by a child process : the evaluation of a 'learn'
+ * request may fail, for instance if a library has been modified since its
+ * compilation, and the errors call exit(). The child then ends, and a new one
+ * starts again from the warm-up state, without the learned evaluations. The
+ * standard input isn't buffered, so that the next requests are not lost.
+ */
+static int compileServer()
+{
+    warmServer();
+    setvbuf(stdin, 0, _IONBF, 0);
+
+    while (true) {
+        fflush(stdout);
+        fflush(stderr);
+        pid_t pid = fork();
+        if (pid < 0) {
+            cerr << "ERROR : can't start the compile server" << endl;
+            return 1;
+
+        } else if (pid == 0) {
+            atexit(childExit);
+            atexit(learnExit);
+            gTraceFile = "";
+            int res = serveRequests();
+            fflush(stdout);
+            fflush(stderr);
+            _exit(res);
+        }
+
+        int status;
+        while (waitpid(pid, &status, 0) < 0) {
+            if (errno != EINTR) return 1;
+        }
+        if (WIFEXITED(status) && WEXITSTATUS(status) == 0) return 0;
+        cerr << "ERROR : the compile server restarts, the evaluations of the 'learn' requests are forgotten" << endl;
+    }
+}
+
+#endif
+
+
+int main (int argc, char* argv[])
+{
+	/****************************************************************
+	 1 - process command line
+	*****************************************************************/
+
+	process_cmdline(argc, argv);
+
+	if (gHelpSwitch) 		{ printhelp(); exit(0); }
+	if (gVersionSwitch) 	{ printversion(); exit(0); }
+
+    initFaustDirectories();
+
+    if (gServerSwitch) {
+#ifndef WIN32
+        return compileServer();
+#else
+        cerr << "ERROR : the compile server is not available on this platform" << endl;
+        exit(1);
+#endif
+    }
+
+    alarm(gTimeout);
+    return compileDSP();
+}
@@ -1,5 +1,8 @@
 #include "aterm.hh"
 #include "ppsig.hh"
+#include <math.h>
+#include <set>
+#include <vector>
 //static void collectMulTerms (Tree& coef, map<Tree,int>& M, Tree t, bool invflag=false);
 
 #undef TRACE
@@ -250,22 +253,75 @@ const aterm& aterm::operator -= (const mterm& m)
 	return *this;
 }
 	
+/**
+ * Add the pairs (i,j), i<j, of the mterms of index L
+ */
+static void addPairs(const vector<int>& L, set<pair<int,int> >& pairs)
+{
+	for (size_t a = 0; a < L.size(); a++) {
+		for (size_t b = a+1; b < L.size(); b++) {
+			pairs.insert(make_pair(L[a], L[b]));
+		}
+	}
+}
+
+/**
+ * The magnitude of a numerical coefficient
+ */
+static bool coefMagnitude(Tree k, double& v)
+{
+	int		i;
+	double	r;
+
+	if (isInt(k->node(), &i))		{ v = fabs(double(i)); return true; }
+	if (isDouble(k->node(), &r))	{ v = fabs(r); return v == v; }
+	return false;
+}
+
+/**
+ * Return the greatest divisor of any two mterms. The gcd of two mterms is
+ * not trivial only if they have a common factor, or coefficients of the same
+ * magnitude (other than 1) : the mterms are indexed by factor and magnitude,
+ * and only the pairs found in the same index are tried, in the order of the
+ * mterms. Long sums of unrelated terms (like FIR filters) are thus not
+ * quadratic.
+ */
 mterm aterm::greatestDivisor() const
 {
 	int maxComplexity = 0;
 	mterm maxGCD(1);
     //cerr << "greatestDivisor of " << *this << endl;
-    
-	for (SM::const_iterator p1 = fSig2MTerms.begin(); p1 != fSig2MTerms.end(); p1++) {
-		for (SM::const_iterator p2 = p1; p2 != fSig2MTerms.end(); p2++) {
-			if (p2 != p1) {
-				mterm g = gcd(p1->second,p2->second);
-                //cerr << "TRYING " << g << " of complexity " << g.complexity() << " (max complexity so far " << maxComplexity << ")" << endl;
-				if (g.complexity()>maxComplexity) {
-					maxComplexity = g.complexity();
-					maxGCD = g;
-				}
-			}
+
+	vector<const mterm*>		terms;
+	map<Tree,vector<int> >		byFactor;
+	map<double,vector<int> >	byMagnitude;
+	set<pair<int,int> >			pairs;
+	double						v;
+
+	for (SM::const_iterator p = fSig2MTerms.begin(); p != fSig2MTerms.end(); p++) {
+		const mterm& m = p->second;
+		int i = terms.size();
+		terms.push_back(&m);
+		for (map<Tree,int>::const_iterator f = m.fFactors.begin(); f != m.fFactors.end(); f++) {
+			byFactor[f->first].push_back(i);
+		}
+		if (coefMagnitude(m.fCoef, v) && !isOne(m.fCoef) && !isMinusOne(m.fCoef)) {
+			byMagnitude[v].push_back(i);
+		}
+	}
+	for (map<Tree,vector<int> >::const_iterator f = byFactor.begin(); f != byFactor.end(); f++) {
+		addPairs(f->second, pairs);
+	}
+	for (map<double,vector<int> >::const_iterator k = byMagnitude.begin(); k != byMagnitude.end(); k++) {
+		addPairs(k->second, pairs);
+	}
+
+	for (set<pair<int,int> >::const_iterator p = pairs.begin(); p != pairs.end(); p++) {
+		mterm g = gcd(*terms[p->first], *terms[p->second]);
+		//cerr << "TRYING " << g << " of complexity " << g.complexity() << " (max complexity so far " << maxComplexity << ")" << endl;
+		if (g.complexity()>maxComplexity) {
+			maxComplexity = g.complexity();
+			maxGCD = g;
 		}
 	}
 	//cerr << "greatestDivisor of " << *this << " --> " << maxGCD << endl;
@@ -445,16 +445,16 @@ Tree mterm::normalizedTree(bool signatureMode, bool negativeMode) const
 		// it's not a pure number, it has factors
 		Tree A[4], B[4];
 		
-		// group by order
+		// group by order (in the order of the factors for each order)
 		for (int order = 0; order < 4; order++) {
 			A[order] = 0; B[order] = 0;
-			for (MP::const_iterator p = fFactors.begin(); p != fFactors.end(); p++) {
-				Tree 	f = p->first;		// f = factor
-				int		q = p->second;		// q = power of f
-				if (f && q && getSigOrder(f)==order) {
-					
-					combineMulDiv (A[order], B[order], f, q);
-				}
+		}
+		for (MP::const_iterator p = fFactors.begin(); p != fFactors.end(); p++) {
+			Tree 	f = p->first;		// f = factor
+			int		q = p->second;		// q = power of f
+			int		order = (f && q) ? getSigOrder(f) : -1;
+			if (order >= 0 && order < 4) {
+				combineMulDiv (A[order], B[order], f, q);
 			}
 		}
 		if (A[0] != 0) cerr << "A[0] == " << *A[0] << endl; 
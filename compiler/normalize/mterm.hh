@@ -57,6 +57,7 @@ class mterm
 
 	bool hasDivisor (const mterm& n) const;		///< return true if this can be divided by n
     friend mterm gcd (const mterm& m1, const mterm& m2);	/// greatest common divisor of two mterms
+    friend class aterm;							/// aterm::greatestDivisor indexes the factors
 };
 
 inline ostream& operator << (ostream& s, const mterm& m) { return m.print(s); }
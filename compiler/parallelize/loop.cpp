@@ -2,6 +2,7 @@
 extern bool gVectorSwitch;
 extern bool gOpenMPSwitch;
 extern bool gOpenMPLoop;
+extern bool gProfileSwitch;
 
 using namespace std;
 
@@ -39,7 +40,7 @@ static void printlines (int n, list<string>& lines, ostream& fout)
  * @param size the number of iterations of the loop
  */
 Loop::Loop(Tree recsymbol, Loop* encl, const string& size)
-        : fIsRecursive(true), fRecSymbolSet(singleton(recsymbol)), fEnclosingLoop(encl), fSize(size), fOrder(-1), fIndex(-1), fUseCount(0), fPrinted(0)
+        : fIsRecursive(true), fRecSymbolSet(singleton(recsymbol)), fEnclosingLoop(encl), fSize(size), fOrder(-1), fIndex(-1), fUseCount(0), fPrinted(0), fProfileIndex(-1), fLabel("")
 {}
 
 
@@ -49,7 +50,7 @@ Loop::Loop(Tree recsymbol, Loop* encl, const string& size)
  * @param size the number of iterations of the loop
  */
 Loop::Loop(Loop* encl, const string& size) 
-        : fIsRecursive(false), fRecSymbolSet(nil), fEnclosingLoop(encl), fSize(size), fOrder(-1), fIndex(-1), fUseCount(0), fPrinted(0)
+        : fIsRecursive(false), fRecSymbolSet(nil), fEnclosingLoop(encl), fSize(size), fOrder(-1), fIndex(-1), fUseCount(0), fPrinted(0), fProfileIndex(-1), fLabel("")
 {}
 
 
@@ -144,6 +145,7 @@ void Loop::println(int n, ostream& fout)
         }*/
 
         tab(n,fout); fout << "// LOOP " << this ;
+        printProfileStart(n, fout);
         if (fPreCode.size()>0) {
             tab(n,fout); fout << "// pre processing";
             printlines(n, fPreCode, fout);
@@ -158,6 +160,7 @@ void Loop::println(int n, ostream& fout)
             tab(n,fout); fout << "// post processing";
             printlines(n, fPostCode, fout);
         }
+        printProfileStop(n, fout);
         tab(n,fout);
     }
 }
@@ -219,6 +222,7 @@ void Loop::printoneln(int n, ostream& fout)
             fout << ((fIsRecursive) ? "// recursive loop" : "// vectorizable loop");
         }*/
             
+        printProfileStart(n, fout);
         tab(n,fout); fout << "for (int i=0; i<" << fSize << "; i++) {";
         if (fPreCode.size()>0) {
             tab(n+1,fout); fout << "// pre processing";
@@ -230,6 +234,32 @@ void Loop::printoneln(int n, ostream& fout)
             printlines(n+1, fPostCode, fout);
         }
         tab(n,fout); fout << "}";
+        printProfileStop(n, fout);
+    }
+}
+
+/**
+ * Print the reading of the cycle counter before the code of a profiled loop
+ * @param n number of tabs of indentation
+ * @param fout output stream
+ */
+void Loop::printProfileStart(int n, ostream& fout)
+{
+    if (gProfileSwitch && fProfileIndex >= 0) {
+        tab(n,fout); fout << "unsigned long long fProfileStart" << fProfileIndex << " = faustcycles();";
+    }
+}
+
+/**
+ * Print the accumulation of the elapsed cycles after the code of a profiled loop
+ * @param n number of tabs of indentation
+ * @param fout output stream
+ */
+void Loop::printProfileStop(int n, ostream& fout)
+{
+    if (gProfileSwitch && fProfileIndex >= 0) {
+        tab(n,fout); fout << "fProfileCycles[" << fProfileIndex << "] += faustcycles() - fProfileStart" << fProfileIndex << ";";
+        tab(n,fout); fout << "fProfileCount[" << fProfileIndex << "]++;";
     }
 }
 
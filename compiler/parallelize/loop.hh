@@ -69,6 +69,8 @@ struct Loop
     list<Loop*>			fExtraLoops;		///< extra loops that where in sequences
 
     int                 fPrinted;           ///< true when loop has been printed (to track multi-print errors)
+    int                 fProfileIndex;      ///< index in the profiling tables (-profile), -1 when not profiled
+    string              fLabel;             ///< what the loop computes, given by the compiler (profiling and traces)
 
 public:
     Loop(Tree recsymbol, Loop* encl, const string& size);   ///< create a recursive loop
@@ -85,6 +87,9 @@ public:
 
     void printoneln (int n, ostream& fout);    ///< print the loop in scalar mode
 
+    void printProfileStart (int n, ostream& fout);  ///< print the cycle counter start (-profile)
+    void printProfileStop (int n, ostream& fout);   ///< print the cycle counter accumulation (-profile)
+
     void absorb(Loop* l);                   ///< absorb a loop inside this one
     // new method
     void concat(Loop* l);
@@ -9,6 +9,7 @@
 #include <map>
 #include <list>
 #include <string>
+#include <sys/stat.h>
 
 
 #include "sourcereader.hh"
@@ -31,6 +32,8 @@ extern bool gLatexDocSwitch;
 int yyparse();
 void yyrestart( FILE *new_file );
 struct yy_buffer_state* yy_scan_string (const char *yy_str  ); // In principle YY_BUFFER_STATE
+struct yy_buffer_state* yy_scan_bytes (const char *bytes, size_t len);
+void yy_delete_buffer (struct yy_buffer_state* b);
 
 extern int 		yyerr;
 extern int 		yydebug;
@@ -259,6 +262,12 @@ Tree SourceReader::parse(const char* fname)
             cerr << "ERROR : Unable to open file " << yyfilename << endl;
             exit(1);
         }
+        if (fIncremental) {
+            Tree ldef = parseIncremental(tmp_file, fullpath);
+            fFilePathnames.push_back(fullpath);
+            fclose(tmp_file);
+            return ldef;
+        }
         yyrestart(yyin);	// make sure we scan from file again (in case we scanned a string just before)
         yylineno = 1;
         int r = yyparse();
@@ -278,6 +287,101 @@ Tree SourceReader::parse(const char* fname)
 }
 
 
+/**
+ * Hash of a file content (FNV-1a)
+ */
+static unsigned long long hashContent(const string& content)
+{
+    unsigned long long h = 14695981039346656037ULL;
+    for (size_t i = 0; i < content.size(); i++) {
+        h = (h ^ (unsigned char)content[i]) * 1099511628211ULL;
+    }
+    return h;
+}
+
+/**
+ * File being parsed in incremental mode, collects the metadata it declares
+ */
+static ParsedFile* gParsedFile = 0;
+
+/**
+ * Parse an opened source file in incremental mode : the definitions of a
+ * file parsed by a previous compilation are reused if its modification time
+ * and size, or else its content, did not change. The metadata it declared
+ * are declared again.
+ *
+ * @param file the opened file
+ * @param fullpath its full pathname
+ * @return the list of definitions it contains
+ */
+Tree SourceReader::parseIncremental(FILE* file, const string& fullpath)
+{
+    struct stat st;
+    if (fstat(fileno(file), &st) != 0) {
+        cerr << "ERROR : Unable to stat file " << fullpath << endl;
+        exit(1);
+    }
+
+    map<string, ParsedFile>::iterator p = fParsedFiles.find(fullpath);
+    bool known = (p != fParsedFiles.end()) && !p->second.fDoc && (p->second.fSize == st.st_size);
+    // a file modified in the same second as a previous parse keeps its modification time
+    bool recent = (time(0) - st.st_mtime) < 2;
+    string content;
+
+    if (!(known && p->second.fModified == st.st_mtime && !recent)) {
+        char buffer[4096];
+        size_t n;
+        while ((n = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+            content.append(buffer, n);
+        }
+        known = known && (p->second.fHash == hashContent(content));
+    }
+
+    if (known) {
+        ParsedFile& parsed = p->second;
+        parsed.fModified = st.st_mtime;
+        for (size_t i = 0; i < parsed.fMetadata.size(); i++) {
+            declareMetadata(parsed.fMetadata[i].first, parsed.fMetadata[i].second);
+        }
+        return parsed.fDefs;
+    }
+
+    ParsedFile& parsed = fParsedFiles[fullpath];
+    parsed.fModified = st.st_mtime;
+    parsed.fSize = st.st_size;
+    parsed.fHash = hashContent(content);
+    parsed.fMetadata.clear();
+    parsed.fDoc = false;
+
+    gParsedFile = &parsed;
+    struct yy_buffer_state* buffer = yy_scan_bytes(content.data(), content.size());
+    yylineno = 1;
+    int r = yyparse();
+    yy_delete_buffer(buffer);
+    gParsedFile = 0;
+    if (r) {
+        cerr << "ERROR (file " << yyfilename << ":" << yylineno << ") : Parse error code " << r << endl;
+    }
+    if (yyerr > 0) {
+        exit(1);
+    }
+    parsed.fDefs = gResult;
+    return gResult;
+}
+
+
+/**
+ * Forget the files read by a previous compilation, the files parsed in
+ * incremental mode are kept
+ */
+
+void SourceReader::init()
+{
+	fFileCache.clear();
+	fFilePathnames.clear();
+}
+
+
 /**
  * Check if a file as been read and is in the "cache"
  * 
@@ -368,6 +472,7 @@ Tree SourceReader::expandrec(Tree ldef, set<string>& visited, Tree lresult)
 
 void declareMetadata(Tree key, Tree value)
 {
+    if (gParsedFile) gParsedFile->fMetadata.push_back(make_pair(key, value));
     if (gMasterDocument == yyfilename) {
         // inside master document, no prefix needed to declare metadata
         gMetaDataSet[key].insert(value);
@@ -384,5 +489,6 @@ void declareMetadata(Tree key, Tree value)
 void declareDoc(Tree t)
 {
 	//gLatexDocSwitch = true;
+	if (gParsedFile) gParsedFile->fDoc = true;
 	gDocVector.push_back(t);
 }
@@ -5,6 +5,9 @@
 #include <string>
 #include <set>
 #include <vector>
+#include <map>
+#include <sys/types.h>
+#include <time.h>
 
 using namespace std;
 
@@ -13,15 +16,35 @@ Tree checkRulelist (Tree lrules);
 void declareMetadata(Tree key, Tree value);
 void declareDoc(Tree t);
 
+/**
+ * A source file parsed in incremental mode, reused by the following
+ * compilations of the process as long as the file is unchanged
+ */
+struct ParsedFile
+{
+	time_t					fModified;		// modification time of the parsed file
+	off_t					fSize;
+	unsigned long long		fHash;			// hash of the file content
+	Tree					fDefs;			// list of definitions
+	vector<pair<Tree,Tree> >	fMetadata;		// metadata declared by the file, replayed when reused
+	bool					fDoc;			// the file contains documentation, always parsed
+};
+
 class SourceReader 
 {
 	map<string, Tree>	fFileCache;
 	vector<string>		fFilePathnames;
+	map<string, ParsedFile>	fParsedFiles;	// by full pathname, kept between compilations
+	bool				fIncremental;
 	Tree parse(const char* fname);
+	Tree parseIncremental(FILE* file, const string& fullpath);
 	Tree expandrec(Tree ldef, set<string>& visited, Tree lresult);
 	bool cached(string fname);
 	
 public:
+	SourceReader() : fIncremental(false) {}
+	void init();
+	void setIncremental(bool incremental) { fIncremental = incremental; }
 	Tree getlist(const char* fname);
 	Tree expandlist(Tree ldef);
 	vector<string>	listSrcFiles();
@@ -14,6 +14,7 @@ using namespace std;
 #include <list>
 #include <set>
 #include <utility>
+#include <algorithm>
 
 /* Uncomment for debugging output. */
 //#define DEBUG
@@ -182,46 +183,91 @@ Trans& Trans::operator = (const Trans& trans)
   return *this;
 }
 
-/* the automaton */
+/* the automaton, compiled to decision tables: each state indexes its
+   successors by constant and by operation symbol, so that a transition is
+   found by binary search instead of a scan of the transition list */
+
+struct Decision {
+  int var; // successor on a variable (-1 if none)
+  vector< pair<Tree, int> > cst; // successors on constants, sorted
+  vector< pair<Sym, int> > op; // successors on operation symbols, sorted
+  vector<int> rules; // rules still active in this state
+  vector<bool> active; // the same as a set of rule numbers
+  vector< pair<int, Tree> > vars; // (rule, variable) bound to the subterm
+  bool match_num; // whether state has a transition on a numeric constant
+
+  Decision(int n_rules) :
+    var(-1), active(n_rules, false), match_num(false) {}
+
+  int cst_trans(Tree x) const
+  {
+    vector< pair<Tree, int> >::const_iterator t =
+      lower_bound(cst.begin(), cst.end(), make_pair(x, -1));
+    return (t != cst.end() && t->first == x) ? t->second : -1;
+  }
+  int op_trans(Sym n) const
+  {
+    vector< pair<Sym, int> >::const_iterator t =
+      lower_bound(op.begin(), op.end(), make_pair(n, -1));
+    return (t != op.end() && t->first == n) ? t->second : -1;
+  }
+};
 
 struct Automaton {
-  vector<State*> state;
+  vector<Decision> state;
   vector<Tree> rhs;
 
-  Automaton() : state(vector<State*>()), rhs(vector<Tree>()), s(0) {}
+  Automaton() : state(vector<Decision>()), rhs(vector<Tree>()) {}
 
   // number of rules
   int n_rules() { return (int)rhs.size(); }
-  // markers of rules still active in state s
-  const list<Rule>& rules(int s) { return state[s]->rules; }
-  // transitions in state s
-  const list<Trans>& trans(int s) { return state[s]->trans; }
+  // numbers of the rules still active in state s
+  const vector<int>& rules(int s) { return state[s].rules; }
   // is s a final state?
-  bool final(int s) { return trans(s).empty(); }
+  bool final(int s)
+  { return state[s].var < 0 && state[s].cst.empty() && state[s].op.empty(); }
 
-  // assign state numbers and build the state table
-  int s;
-  void build(State *st);
+  // assign state numbers and build the decision table of the trie rooted
+  // at st, returns the number of st
+  int build(State *st);
 
 #ifdef DEBUG
   ostream& print(ostream& fout) const;
 #endif
 };
 
-void Automaton::build(State *st)
+int Automaton::build(State *st)
 {
-  state.push_back(st);
-  st->s = s++;
+  int s = (int)state.size();
+  state.push_back(Decision(n_rules()));
+  st->s = s;
+  list<Rule>::const_iterator r;
+  for (r = st->rules.begin(); r != st->rules.end(); r++) {
+    state[s].rules.push_back(r->r);
+    state[s].active[r->r] = true;
+    if (r->id != NULL)
+      state[s].vars.push_back(make_pair(r->r, r->id));
+  }
   list<Trans>::const_iterator t;
   for (t = st->trans.begin(); t != st->trans.end(); t++) {
     Tree x;
+    Node op(0);
     double f; 
     int i;
-    if (t->is_cst_trans(x) &&
-	(isBoxInt(x, &i) || isBoxReal(x, &f)))
-      st->match_num = true;
-    build(t->state);
+    // 'state' may be reallocated by the recursive call
+    int next = build(t->state);
+    if (t->is_var_trans())
+      state[s].var = next;
+    else if (t->is_cst_trans(x)) {
+      if (isBoxInt(x, &i) || isBoxReal(x, &f))
+	state[s].match_num = true;
+      state[s].cst.push_back(make_pair(x, next));
+    } else if (t->is_op_trans(op))
+      state[s].op.push_back(make_pair(op.getSym(), next));
   }
+  sort(state[s].cst.begin(), state[s].cst.end());
+  sort(state[s].op.begin(), state[s].op.end());
+  return s;
 }
 
 /* Debugging output. */
@@ -275,8 +321,19 @@ ostream& Automaton::print(ostream& fout) const
   for (i = 0; i < n; i++)
     fout << "rule #" << i << ": " << *rhs[i] << endl;
   n = state.size();
-  for (i = 0; i < n; i++)
-    fout << *state[i];
+  for (i = 0; i < n; i++) {
+    const Decision& d = state[i];
+    fout << "state " << i << ":";
+    for (size_t k = 0; k < d.rules.size(); k++)
+      fout << " #" << d.rules[k];
+    fout << endl;
+    if (d.var >= 0)
+      fout << "\tvar _: state " << d.var << endl;
+    for (size_t k = 0; k < d.cst.size(); k++)
+      fout << "\tcst " << *d.cst[k].first << ": state " << d.cst[k].second << endl;
+    for (size_t k = 0; k < d.op.size(); k++)
+      fout << "\top  " << Node(d.op[k].first) << ": state " << d.op[k].second << endl;
+  }
   return fout;
 }
 #endif
@@ -523,6 +580,8 @@ Automaton *make_pattern_matcher(Tree R)
     }
   }
   A->build(start);
+  /* the tables are built, the trie is no longer needed */
+  delete start;
   /* Check for shadowed rules. Note that because of potential nonlinearities
      it is *not* enough to just check the rule lists of final states and
      determine whether they have multiple matched rules. */
@@ -535,15 +594,15 @@ Automaton *make_pattern_matcher(Tree R)
       s = apply_pattern_matcher(A, s, testpats[r][i], C, E);
       if (s < 0) break;
     }
-    if (A->final(s)) {
-      list<Rule>::const_iterator ru;
+    if (s >= 0 && A->final(s)) {
+      vector<int>::const_iterator ru;
       for (ru = A->rules(s).begin(); ru != A->rules(s).end(); ru++)
-      if (!isBoxError(E[ru->r])) {
-          if (ru->r < r) {
+      if (!isBoxError(E[*ru])) {
+          if (*ru < r) {
             /* Lhs of rule #r matched a higher-priority rule, so rule #r may
                be shadowed. */
             Tree lhs1, rhs1, lhs2, rhs2;
-            if (isCons(rules[ru->r], lhs1, rhs1) &&  isCons(rules[r], lhs2, rhs2)) {
+            if (isCons(rules[*ru], lhs1, rhs1) &&  isCons(rules[r], lhs2, rhs2)) {
                 cerr 	<< "WARNING : shadowed pattern-matching rule: "
                     << boxpp(reverse(lhs2)) << " => " << boxpp(rhs2) << ";"
                     << " previous rule was: " 
@@ -553,7 +612,7 @@ Automaton *make_pattern_matcher(Tree R)
                 cerr << "INTERNAL ERROR : " << __FILE__ << ":" << __LINE__ << endl;
                 exit(1);
             }
-          } else if (ru->r >= r) {
+          } else if (*ru >= r) {
             break;
           }
        }
@@ -566,89 +625,62 @@ Automaton *make_pattern_matcher(Tree R)
 }
 
 /* Helper type to represent variable substitutions which are recorded during
-   matching. Each variable is associated with the path pointing at the subterm
-   of the argument where the substitution of the matched variable is to be
-   found. */
+   matching. Each variable is associated with the subterm of the argument
+   which was at its position, in the order in which they were encountered. */
 
 struct Assoc {
+  int r;
   Tree id;
-  Path p;
-  Assoc(Tree _id, const Path& _p) : id(_id), p(_p) {}
+  Tree value;
+  Assoc(int _r, Tree _id, Tree _value) : r(_r), id(_id), value(_value) {}
 };
-typedef list<Assoc> Subst;
-
-/* add all substitutions for a given state */
-
-static void add_subst(vector<Subst>& subst, Automaton *A, int s)
-{
-  list<Rule> rules = A->rules(s);
-  list<Rule>::const_iterator r;
-  for (r = rules.begin(); r != rules.end(); r++)
-    if (r->id != NULL)
-      subst[r->r].push_back(Assoc(r->id, r->p));
-}
+typedef vector<Assoc> Subst;
 
 /* Process a given term tree X starting from state s, modify variable
    substitutions accordingly. Returns the resulting state, or -1 if no
    match. This does all the grunt work of matching. */
 
 static int apply_pattern_matcher_internal(Automaton *A, int s, Tree X,
-					  vector<Subst>& subst)
+					  Subst& subst)
 {
-  /* FIXME: rewrite this non-recursively? */
   if (s >= 0) {
-    list<Trans>::const_iterator t;
-    if (A->state[s]->match_num)
+    const Decision& d = A->state[s];
+    Tree Y = X;
+    int next;
+    /* variables are bound to the subterm as given */
+    vector< pair<int, Tree> >::const_iterator v;
+    for (v = d.vars.begin(); v != d.vars.end(); v++)
+      subst.push_back(Assoc(v->first, v->second, X));
+    if (d.match_num)
       /* simplify possible numeric argument on the fly */
-      X = simplifyPattern(X);
+      Y = simplifyPattern(X);
     /* first check for applicable non-variable transitions */
-    for (t = A->trans(s).begin(); t != A->trans(s).end(); t++) {
-      Tree x;
-      Node op(0), op1(0);
-      if (t->is_var_trans())
-	continue;
-      else if (t->is_cst_trans(x)) {
-	if (X==x) {
-	  /* transition on constant */
-#ifdef DEBUG
-      cerr << "state " << s << ", " << *x << ": goto state " << t->state->s << endl;
-#endif
-	  add_subst(subst, A, s);
-	  s = t->state->s;
-	  return s;
-	}
-      } else if (t->is_op_trans(op)) {
-	Tree x0, x1;
-	if (isBoxPatternOp(X, op1, x0, x1) && op == op1) {
-	  /* transition on operation symbol */
+    if (!d.cst.empty() && (next = d.cst_trans(Y)) >= 0) {
+      /* transition on constant */
 #ifdef DEBUG
-      cerr << "state " << s << ", " << op << ": goto state " << t->state->s << endl;
+      cerr << "state " << s << ", " << *Y << ": goto state " << next << endl;
 #endif
-	  add_subst(subst, A, s);
-	  s = t->state->s;
-	  if (s >= 0)
-	    s = apply_pattern_matcher_internal(A, s, x0, subst);
-	  if (s >= 0)
-	    s = apply_pattern_matcher_internal(A, s, x1, subst);
-	  return s;
-	}
-      }
+      return next;
     }
-    /* check for variable transition (is always first in the list of
-       transitions) */
-    t = A->trans(s).begin();
-    if (t->is_var_trans()) {
+    if (!d.op.empty() && Y->arity() == 2 && isSym(Y->node()) &&
+	(next = d.op_trans(Y->node().getSym())) >= 0) {
+      /* transition on operation symbol, only BDA ops are in the table */
 #ifdef DEBUG
-      cerr << "state " << s << ", _: goto state " << t->state->s << endl;
+      cerr << "state " << s << ", " << Y->node() << ": goto state " << next << endl;
 #endif
-      add_subst(subst, A, s);
-      s = t->state->s;
-    } else {
+      s = apply_pattern_matcher_internal(A, next, Y->branch(0), subst);
+      if (s >= 0)
+	s = apply_pattern_matcher_internal(A, s, Y->branch(1), subst);
+      return s;
+    }
+    /* check for variable transition */
 #ifdef DEBUG
+    if (d.var >= 0)
+      cerr << "state " << s << ", _: goto state " << d.var << endl;
+    else
       cerr << "state " << s << ", *** match failed ***" << endl;
 #endif
-      s = -1;
-    }
+    s = d.var;
   }
   return s;
 }
@@ -665,8 +697,7 @@ int apply_pattern_matcher(Automaton *A,		// automaton
 			  Tree& C,		// output closure (if any)
 			  vector<Tree>& E)	// modified output environments
 {
-  int n = A->n_rules();
-  vector<Subst> subst(n, Subst());
+  Subst subst;
   /* perform matching, record variable substitutions */
 #ifdef DEBUG
   cerr << "automaton " << A << ", state " << s << ", start match on arg: " << *X << endl;
@@ -676,45 +707,44 @@ int apply_pattern_matcher(Automaton *A,		// automaton
   if (s < 0)
     /* failed match */
     return s;
-  /* process variable substitutions */
-  list<Rule>::const_iterator r;
-  for (r = A->rules(s).begin(); r != A->rules(s).end(); r++) {
-    // all rules still active in state s
-    if (!isBoxError(E[r->r])) { // and still viable
-      Subst::const_iterator assoc;
-      for (assoc = subst[r->r].begin(); assoc != subst[r->r].end(); assoc++) {
-	Tree Z, Z1 = subtree(X, 0, assoc->p);
-	if (searchIdDef(assoc->id, Z, E[r->r])) {
-	  if (Z != Z1) {
-	    /* failed nonlinearity, add to the set of nonviable rules */
+  /* process variable substitutions of all rules still active in state s */
+  const Decision& d = A->state[s];
+  Subst::const_iterator assoc;
+  for (assoc = subst.begin(); assoc != subst.end(); assoc++) {
+    int r = assoc->r;
+    if (d.active[r] && !isBoxError(E[r])) { // and still viable
+      Tree Z, Z1 = assoc->value;
+      if (searchIdDef(assoc->id, Z, E[r])) {
+	if (Z != Z1) {
+	  /* failed nonlinearity, add to the set of nonviable rules */
 #ifdef DEBUG
-      cerr << "state " << s << ", rule #" << r->r << ": " <<
+      cerr << "state " << s << ", rule #" << r << ": " <<
 	    *assoc->id << " := " << *Z1 << " *** failed *** old value: " <<
 	    *Z << endl;
 #endif
-	    E[r->r] = boxError();
-	  }
-	} else {
-	  /* bind a variable for the current rule */
+	  E[r] = boxError();
+	}
+      } else {
+	/* bind a variable for the current rule */
 #ifdef DEBUG
-      cerr << "state " << s << ", rule #" << r->r << ": " <<
+      cerr << "state " << s << ", rule #" << r << ": " <<
 	    *assoc->id << " := " << *Z1 << endl;
 #endif
-	  E[r->r] = pushValueDef(assoc->id, Z1, E[r->r]);
-	}
+	E[r] = pushValueDef(assoc->id, Z1, E[r]);
       }
     }
   }
   if (A->final(s)) {
     /* if in a final state then return the right-hand side together with the
        corresponding variable environment */
-    for (r = A->rules(s).begin(); r != A->rules(s).end(); r++) // all rules matched in state s
-      if (!isBoxError(E[r->r])) { // and still viable
+    vector<int>::const_iterator r;
+    for (r = d.rules.begin(); r != d.rules.end(); r++) // all rules matched in state s
+      if (!isBoxError(E[*r])) { // and still viable
 	/* return the rhs of the matched rule */
-	C = closure(A->rhs[r->r], nil, nil, E[r->r]);
+	C = closure(A->rhs[*r], nil, nil, E[*r]);
 #ifdef DEBUG
-    cerr << "state " << s << ", complete match yields rhs #" << r->r <<
-	  ": " << *A->rhs[r->r] << endl;
+    cerr << "state " << s << ", complete match yields rhs #" << *r <<
+	  ": " << *A->rhs[*r] << endl;
 #endif
 	return s;
       }
@@ -0,0 +1,469 @@
+/************************************************************************
+ ************************************************************************
+    FAUST compiler
+	Copyright (C) 2016 GRAME, Centre National de Creation Musicale
+    ---------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ ************************************************************************
+ ************************************************************************/
+
+#include <math.h>
+#include <limits.h>
+#include <map>
+#include "sigcompute.hh"
+#include "sigtyperules.hh"
+#include "binop.hh"
+#include "xtended.hh"
+#include "floats.hh"
+
+using namespace std;
+
+extern int gFloatSize;
+
+/**
+ * @file sigcompute.cpp
+ * Compile time computation of the content of tables. The signal graph of a
+ * table generator is flattened into a list of nodes sorted such that the
+ * arguments of a node needed at the same instant are computed before it.
+ * All the nodes are then computed sample by sample, like the code of the
+ * generator class would do at init time. Delayed arguments are read from a
+ * small history kept by each node. Real values are rounded to the precision
+ * of the generated code so that recursive generators give the same results.
+ */
+
+// the maximum amount of computation (number of nodes x table size) we accept to do
+#define MAX_COMPUTE_COST 100000000.0
+
+enum { kNodeConst, kNodeBinOp, kNodeXtended, kNodeIntCast, kNodeFloatCast, kNodeSelect2,
+       kNodeSelect3, kNodeFixDelay, kNodeVarDelay, kNodePrefix, kNodeProj, kNodeTable, kNodeWaveform };
+
+struct SigNode
+{
+    Tree            fSig;
+    int             fKind;
+    bool            fIsInt;
+    int             fOp;        ///< binop opcode or fixed delay
+    double          fValue;     ///< value of constants
+    vector<int>     fArgs;      ///< index of the arguments
+    vector<double>  fTable;     ///< content of tables and waveforms
+    vector<double>  fHistory;   ///< the last computed values (at least the current one)
+};
+
+class SigTableComputer
+{
+    int                 fSize;
+    vector<SigNode>     fNodes;
+    map<Tree, int>      fIndex;
+    vector<bool>        fDone;
+    vector<int>         fOrder;     ///< evaluation order of the nodes
+
+  public:
+
+    SigTableComputer(int size) : fSize(size) {}
+
+    bool compute(Tree sig, vector<double>& values);
+
+  private:
+
+    int     visit(Tree sig, bool sameTime);
+    bool    fill(int node);
+    int     addArg(int node, Tree arg, bool sameTime = true);
+    void    needHistory(int node, int delay);
+    bool    computeNode(SigNode& n, int t, double& v);
+
+    double  value(int node, int t)
+    {
+        SigNode& a = fNodes[node];
+        return a.fHistory[t % a.fHistory.size()];
+    }
+
+    double  delayed(int node, int t, int d)
+    {
+        return (t < d) ? 0 : value(node, t-d);
+    }
+
+    bool    isInt(int node) { return fNodes[node].fIsInt; }
+};
+
+/**
+ * Round a real value to the precision of the generated code
+ */
+static double real(double x)
+{
+    return (gFloatSize == 1) ? double(float(x)) : x;
+}
+
+/**
+ * Convert a value to the type of a node, as a C assignment would do
+ */
+static double convert(double x, bool fromInt, bool toInt)
+{
+    if (toInt) {
+        return (fromInt) ? x : double(int(x));
+    } else {
+        return real(x);
+    }
+}
+
+/**
+ * Compute a primitive of the extended library. The computation is done
+ * directly on numbers, computeSigOutput would create a tree for each value.
+ */
+static bool computeXtended(const string& name, const vector<double>& args, double& v)
+{
+    if (args.size() == 1) {
+        double x = args[0];
+        if      (name == "abs")     v = fabs(x);
+        else if (name == "acos")    v = acos(x);
+        else if (name == "asin")    v = asin(x);
+        else if (name == "atan")    v = atan(x);
+        else if (name == "ceil")    v = ceil(x);
+        else if (name == "cos")     v = cos(x);
+        else if (name == "exp")     v = exp(x);
+        else if (name == "floor")   v = floor(x);
+        else if (name == "log")     v = log(x);
+        else if (name == "log10")   v = log10(x);
+        else if (name == "rint")    v = rint(x);
+        else if (name == "sin")     v = sin(x);
+        else if (name == "sqrt")    v = sqrt(x);
+        else if (name == "tan")     v = tan(x);
+        else return false;
+    } else if (args.size() == 2) {
+        double x = args[0], y = args[1];
+        if      (name == "atan2")       v = atan2(x, y);
+        else if (name == "fmod")        v = fmod(x, y);
+        else if (name == "max")         v = max(x, y);
+        else if (name == "min")         v = min(x, y);
+        else if (name == "pow")         v = pow(x, y);
+        else if (name == "remainder")   v = remainder(x, y);
+        else return false;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool SigTableComputer::compute(Tree sig, vector<double>& values)
+{
+    int root = visit(sig, true);
+    if (root < 0) return false;
+    if (double(fNodes.size()) * double(fSize) > MAX_COMPUTE_COST) return false;
+
+    for (size_t i = 0; i < fNodes.size(); i++) {
+        fNodes[i].fHistory.resize(max(size_t(1), fNodes[i].fHistory.size()), 0);
+    }
+
+    values.resize(fSize);
+    for (int t = 0; t < fSize; t++) {
+        for (size_t i = 0; i < fOrder.size(); i++) {
+            SigNode& n = fNodes[fOrder[i]];
+            double v;
+            if (!computeNode(n, t, v)) return false;
+            n.fHistory[t % n.fHistory.size()] = v;
+        }
+        values[t] = value(root, t);
+        if (isnan(values[t]) || isinf(values[t])) return false;
+    }
+    return true;
+}
+
+/**
+ * Add a signal to the graph and returns its index (or -1 if it can't be
+ * computed). Signals needed at the same instant must not be recursive.
+ */
+int SigTableComputer::visit(Tree sig, bool sameTime)
+{
+    map<Tree, int>::iterator p = fIndex.find(sig);
+    if (p != fIndex.end()) {
+        return (sameTime && !fDone[p->second]) ? -1 : p->second;
+    }
+
+    int node = fNodes.size();
+    fNodes.push_back(SigNode());
+    fDone.push_back(false);
+    fIndex[sig] = node;
+
+    fNodes[node].fSig = sig;
+    fNodes[node].fIsInt = (getCertifiedSigType(sig)->nature() == kInt);
+    fNodes[node].fOp = 0;
+    fNodes[node].fValue = 0;
+    if (!fill(node)) return -1;
+
+    fDone[node] = true;
+    fOrder.push_back(node);
+    return node;
+}
+
+int SigTableComputer::addArg(int node, Tree arg, bool sameTime)
+{
+    int a = visit(arg, sameTime);
+    if (a >= 0) fNodes[node].fArgs.push_back(a);
+    return a;
+}
+
+void SigTableComputer::needHistory(int node, int delay)
+{
+    vector<double>& h = fNodes[node].fHistory;
+    if (int(h.size()) < delay+1) h.resize(delay+1, 0);
+}
+
+/**
+ * Analyze a signal and collect its arguments
+ */
+bool SigTableComputer::fill(int node)
+{
+    Tree    sig = fNodes[node].fSig;
+    bool    isint = fNodes[node].fIsInt;
+    int     i, op;
+    double  r;
+    Tree    sel, x, y, z, id, size, gen, content, var, le;
+
+    if (isSigInt(sig, &i)) {
+        fNodes[node].fKind = kNodeConst; fNodes[node].fValue = convert(i, true, isint);
+        return true;
+
+    } else if (isSigReal(sig, &r)) {
+        fNodes[node].fKind = kNodeConst; fNodes[node].fValue = convert(r, false, isint);
+        return true;
+
+    } else if (getUserData(sig)) {
+        fNodes[node].fKind = kNodeXtended;
+        for (int k = 0; k < sig->arity(); k++) {
+            if (addArg(node, sig->branch(k)) < 0) return false;
+        }
+        return true;
+
+    } else if (isSigWaveform(sig)) {
+        fNodes[node].fKind = kNodeWaveform;
+        for (int k = 0; k < sig->arity(); k++) {
+            if (isSigInt(sig->branch(k), &i)) {
+                fNodes[node].fTable.push_back(convert(i, true, isint));
+            } else if (isSigReal(sig->branch(k), &r)) {
+                fNodes[node].fTable.push_back(convert(r, false, isint));
+            } else {
+                return false;
+            }
+        }
+        return sig->arity() > 0;
+
+    } else if (isSigBinOp(sig, &op, x, y)) {
+        fNodes[node].fKind = kNodeBinOp;
+        fNodes[node].fOp = op;
+        return (addArg(node, x) >= 0) && (addArg(node, y) >= 0);
+
+    } else if (isSigIntCast(sig, x)) {
+        fNodes[node].fKind = kNodeIntCast;
+        return addArg(node, x) >= 0;
+
+    } else if (isSigFloatCast(sig, x)) {
+        fNodes[node].fKind = kNodeFloatCast;
+        return addArg(node, x) >= 0;
+
+    } else if (isSigSelect2(sig, sel, x, y)) {
+        fNodes[node].fKind = kNodeSelect2;
+        return (addArg(node, sel) >= 0) && (addArg(node, x) >= 0) && (addArg(node, y) >= 0);
+
+    } else if (isSigSelect3(sig, sel, x, y, z)) {
+        fNodes[node].fKind = kNodeSelect3;
+        return (addArg(node, sel) >= 0) && (addArg(node, x) >= 0) && (addArg(node, y) >= 0) && (addArg(node, z) >= 0);
+
+    } else if (isSigFixDelay(sig, x, y)) {
+        if (isSigInt(y, &op)) {
+            // fixed delay, the delayed signal is not needed at the same instant
+            if (op < 0) return false;
+            fNodes[node].fKind = kNodeFixDelay;
+            fNodes[node].fOp = op;
+            int a = addArg(node, x, op == 0);
+            if (a < 0) return false;
+            needHistory(a, op);
+        } else {
+            // variable delay, bounded by the interval of the delay signal
+            interval d = getCertifiedSigType(y)->getInterval();
+            if (!d.valid || d.lo < 0 || d.hi > fSize) return false;
+            fNodes[node].fKind = kNodeVarDelay;
+            fNodes[node].fOp = int(d.hi);
+            int a = addArg(node, x);
+            if (a < 0 || addArg(node, y) < 0) return false;
+            needHistory(a, int(d.hi));
+        }
+        return true;
+
+    } else if (isSigPrefix(sig, x, y)) {
+        fNodes[node].fKind = kNodePrefix;
+        if (addArg(node, x) < 0) return false;
+        int a = addArg(node, y, false);
+        if (a < 0) return false;
+        needHistory(a, 1);
+        return true;
+
+    } else if (isProj(sig, &i, x)) {
+        fNodes[node].fKind = kNodeProj;
+        return isRec(x, var, le) && (addArg(node, nth(le, i)) >= 0);
+
+    } else if (isSigRDTbl(sig, x, y)) {
+        // read only table used by the generator, computed first
+        int             tsize;
+        vector<double>  table;
+        if (!isSigTable(x, id, size, gen) || !isSigGen(gen, content) || !isSigInt(size, &tsize)) return false;
+        if (!computeSigTable(content, tsize, table)) return false;
+        bool tint = (getCertifiedSigType(content)->nature() == kInt);
+        for (size_t k = 0; k < table.size(); k++) table[k] = convert(table[k], tint, isint);
+        fNodes[node].fKind = kNodeTable;
+        fNodes[node].fTable = table;
+        return addArg(node, y) >= 0;
+
+    } else if (isSigAttach(sig, x, y)) {
+        fNodes[node].fKind = kNodeProj;
+        return addArg(node, x) >= 0;
+
+    } else {
+        // inputs, sample rate, user interface, foreign functions...
+        return false;
+    }
+}
+
+/**
+ * Compute the value of a node at instant t, its arguments being already computed
+ */
+bool SigTableComputer::computeNode(SigNode& n, int t, double& v)
+{
+    switch (n.fKind) {
+
+        case kNodeConst :
+            v = n.fValue;
+            return true;
+
+        case kNodeBinOp : {
+            double  a = value(n.fArgs[0], t);
+            double  b = value(n.fArgs[1], t);
+            bool    ia = isInt(n.fArgs[0]);
+            bool    ib = isInt(n.fArgs[1]);
+
+            if (n.fOp == kDiv) {
+                // always a float division, like in the generated code
+                v = real(convert(a, ia, false) / convert(b, ib, false));
+            } else if (n.fOp >= kGT && n.fOp <= kNE) {
+                if (!(ia && ib)) { a = convert(a, ia, false); b = convert(b, ib, false); }
+                switch (n.fOp) {
+                    case kGT : v = a > b; break;
+                    case kLT : v = a < b; break;
+                    case kGE : v = a >= b; break;
+                    case kLE : v = a <= b; break;
+                    case kEQ : v = a == b; break;
+                    default  : v = a != b; break;
+                }
+            } else if (n.fOp == kAdd || n.fOp == kSub || n.fOp == kMul) {
+                if (n.fIsInt) {
+                    // wraps around like the int arithmetic of the generated code
+                    unsigned int ua = (unsigned int)int(a), ub = (unsigned int)int(b);
+                    unsigned int ur = (n.fOp == kAdd) ? ua + ub : (n.fOp == kSub) ? ua - ub : ua * ub;
+                    v = int(ur);
+                } else {
+                    a = convert(a, ia, false); b = convert(b, ib, false);
+                    v = real((n.fOp == kAdd) ? a + b : (n.fOp == kSub) ? a - b : a * b);
+                }
+            } else {
+                // integer only operations
+                if (!(ia && ib)) return false;
+                int x = int(a), y = int(b);
+                switch (n.fOp) {
+                    case kRem : if (y == 0) return false; v = x % y; break;
+                    case kLsh : if (y < 0 || y > 31) return false; v = int((unsigned int)x << y); break;
+                    case kRsh : if (y < 0 || y > 31) return false; v = x >> y; break;
+                    case kAND : v = x & y; break;
+                    case kOR  : v = x | y; break;
+                    case kXOR : v = x ^ y; break;
+                    default   : return false;
+                }
+            }
+            return true;
+        }
+
+        case kNodeXtended : {
+            vector<double> args;
+            for (size_t k = 0; k < n.fArgs.size(); k++) {
+                args.push_back(convert(value(n.fArgs[k], t), isInt(n.fArgs[k]), false));
+            }
+            if (!computeXtended(((xtended*)getUserData(n.fSig))->name(), args, v)) return false;
+            if (n.fIsInt && v != floor(v)) return false;
+            v = convert(v, false, n.fIsInt);
+            return true;
+        }
+
+        case kNodeIntCast : {
+            double a = value(n.fArgs[0], t);
+            if (!(a > double(INT_MIN)-1 && a < double(INT_MAX)+1)) return false;
+            v = int(a);
+            return true;
+        }
+
+        case kNodeFloatCast :
+            v = convert(value(n.fArgs[0], t), isInt(n.fArgs[0]), false);
+            return true;
+
+        case kNodeSelect2 : {
+            int a = (int(value(n.fArgs[0], t)) != 0) ? n.fArgs[2] : n.fArgs[1];
+            v = convert(value(a, t), isInt(a), n.fIsInt);
+            return true;
+        }
+
+        case kNodeSelect3 : {
+            int s = int(value(n.fArgs[0], t));
+            int a = (s == 0) ? n.fArgs[1] : (s == 1) ? n.fArgs[2] : n.fArgs[3];
+            v = convert(value(a, t), isInt(a), n.fIsInt);
+            return true;
+        }
+
+        case kNodeFixDelay :
+            v = delayed(n.fArgs[0], t, n.fOp);
+            return true;
+
+        case kNodeVarDelay : {
+            int d = int(value(n.fArgs[1], t));
+            if (d < 0 || d > n.fOp) return false;
+            v = delayed(n.fArgs[0], t, d);
+            return true;
+        }
+
+        case kNodePrefix :
+            v = (t == 0) ? convert(value(n.fArgs[0], t), isInt(n.fArgs[0]), n.fIsInt) : delayed(n.fArgs[1], t, 1);
+            return true;
+
+        case kNodeProj :
+            v = convert(value(n.fArgs[0], t), isInt(n.fArgs[0]), n.fIsInt);
+            return true;
+
+        case kNodeTable : {
+            int i = int(value(n.fArgs[0], t));
+            if (i < 0 || i >= int(n.fTable.size())) return false;
+            v = n.fTable[i];
+            return true;
+        }
+
+        case kNodeWaveform :
+            v = n.fTable[t % n.fTable.size()];
+            return true;
+
+        default :
+            return false;
+    }
+}
+
+bool computeSigTable(Tree sig, int size, vector<double>& values)
+{
+    if (size <= 0) return false;
+    SigTableComputer C(size);
+    return C.compute(sig, values);
+}
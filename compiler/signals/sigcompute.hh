@@ -0,0 +1,38 @@
+/************************************************************************
+ ************************************************************************
+    FAUST compiler
+	Copyright (C) 2016 GRAME, Centre National de Creation Musicale
+    ---------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ ************************************************************************
+ ************************************************************************/
+
+
+
+#ifndef _SIGCOMPUTE_
+#define _SIGCOMPUTE_
+
+#include <vector>
+#include "signals.hh"
+
+/**
+ * Compute at compile time the first samples of a (typed) table generator
+ * signal. Returns false if the signal depends on something that is not
+ * known at compile time (inputs, sample rate, user interface, foreign
+ * functions...) in which case the table must be filled at init time.
+ */
+bool computeSigTable(Tree sig, int size, std::vector<double>& values);
+
+#endif
@@ -0,0 +1,206 @@
+/************************************************************************
+ ************************************************************************
+    FAUST compiler
+	Copyright (C) 2016 GRAME, Centre National de Creation Musicale
+    ---------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ ************************************************************************
+ ************************************************************************/
+
+#include <map>
+#include <set>
+#include "sigmatrix.hh"
+#include "sigtyperules.hh"
+#include "binop.hh"
+
+using namespace std;
+
+/**
+ * @file sigmatrix.cpp
+ * Detection of the linear combinations of signals with constant weights. Each
+ * signal is decomposed into a weighted sum of terms, going through the additions,
+ * subtractions and multiplications by a constant of real signals, and of integer
+ * signals whose interval excludes overflows.
+ * For the outputs computed as a matrix-vector product, the terms common to the
+ * outputs form the vector, shared by all the outputs, and the weights the matrix.
+ * For the FIR filters, the terms are the delays of the same signal.
+ */
+
+// a weighted sum : the terms in order of appearance and their weights
+struct weightedSum
+{
+    vector<Tree>        fTerms;
+    map<Tree,double>    fWeights;
+};
+
+// the additions and multiplications replaced by the kernel, shared between the outputs
+typedef set<Tree> operations;
+
+static bool constantValue(Tree sig, double& v)
+{
+    int     i;
+    double  r;
+
+    if (isSigInt(sig, &i))  { v = i; return true; }
+    if (isSigReal(sig, &r)) { v = r; return true; }
+    return false;
+}
+
+/**
+ * True if the additions and multiplications of sig can be computed by the
+ * kernel : the real signals, and the integer signals that can't overflow.
+ */
+static bool isLinearNode(Tree sig)
+{
+    Type        t = getCertifiedSigType(sig);
+    interval    i = t->getInterval();
+
+    return t->nature() == kReal || (i.valid && i.lo > -2147483648.0 && i.hi < 2147483647.0);
+}
+
+/**
+ * Add k * sig to the weighted sum s. Returns false if sig has a constant
+ * part, as the kernel only computes linear combinations.
+ */
+static bool addWeightedTerms(Tree sig, double k, weightedSum& s, operations& ops)
+{
+    int     op;
+    Tree    x, y;
+    double  v;
+
+    if (constantValue(sig, v)) {
+        return false;
+
+    } else if (isSigBinOp(sig, &op, x, y) && isLinearNode(sig)) {
+        if (op == kAdd) {
+            ops.insert(sig);
+            return addWeightedTerms(x, k, s, ops) && addWeightedTerms(y, k, s, ops);
+        } else if (op == kSub) {
+            ops.insert(sig);
+            return addWeightedTerms(x, k, s, ops) && addWeightedTerms(y, -k, s, ops);
+        } else if (op == kMul && constantValue(x, v)) {
+            ops.insert(sig);
+            return addWeightedTerms(y, k*v, s, ops);
+        } else if (op == kMul && constantValue(y, v)) {
+            ops.insert(sig);
+            return addWeightedTerms(x, k*v, s, ops);
+        }
+    }
+
+    // a term of the sum
+    if (s.fWeights.find(sig) == s.fWeights.end()) {
+        s.fTerms.push_back(sig);
+        s.fWeights[sig] = 0;
+    }
+    s.fWeights[sig] += k;
+    return true;
+}
+
+bool sigMatrix::isOutput(int i) const
+{
+    for (size_t j = 0; j < fOutputs.size(); j++) {
+        if (fOutputs[j] == i) return true;
+    }
+    return false;
+}
+
+bool findOutputMatrix(Tree L, int minsize, int mintaps, sigMatrix& matrix)
+{
+    vector<weightedSum> sums;
+    map<Tree,int>       index;      // index of the terms in matrix.fInputs
+    operations          ops;
+    int                 nonzero = 0;
+
+    if (minsize <= 0) return false;
+
+    // decompose the real outputs which are sums of at least two terms
+    for (int i = 0; isList(L); L = tl(L), i++) {
+        Tree        sig = hd(L);
+        weightedSum s;
+        operations  o;
+        sigFIR      fir;
+        if (findFIR(sig, mintaps, fir)) continue;
+        if (getCertifiedSigType(sig)->nature() == kReal && addWeightedTerms(sig, 1, s, o) && s.fTerms.size() > 1) {
+            ops.insert(o.begin(), o.end());
+            matrix.fOutputs.push_back(i);
+            matrix.fSignals.push_back(sig);
+            sums.push_back(s);
+            for (size_t k = 0; k < s.fTerms.size(); k++) {
+                if (index.find(s.fTerms[k]) == index.end()) {
+                    index[s.fTerms[k]] = matrix.fInputs.size();
+                    matrix.fInputs.push_back(s.fTerms[k]);
+                }
+                if (s.fWeights[s.fTerms[k]] != 0) nonzero++;
+            }
+        }
+    }
+
+    int outputs = matrix.fOutputs.size();
+    int inputs = matrix.fInputs.size();
+    if (outputs < 4 || inputs < 2 || outputs * inputs < minsize || 2 * nonzero < outputs * inputs) {
+        return false;
+    }
+
+    // the outputs may already share partial sums (like the sum of several terms
+    // with the same weights in all the outputs) : keep the scalar code when the
+    // kernel computes more products than the operations it replaces
+    if (outputs * inputs > int(ops.size())) {
+        return false;
+    }
+
+    matrix.fCoefs.assign(inputs, vector<double>(outputs, 0.0));
+    for (int j = 0; j < outputs; j++) {
+        for (map<Tree,double>::iterator p = sums[j].fWeights.begin(); p != sums[j].fWeights.end(); p++) {
+            matrix.fCoefs[index[p->first]][j] = p->second;
+        }
+    }
+    return true;
+}
+
+bool findFIR(Tree sig, int mintaps, sigFIR& fir)
+{
+    int         op, d;
+    Tree        x, y, delay;
+    weightedSum s;
+    operations  ops;
+    int         taps = 0;
+
+    if (mintaps <= 0 || getCertifiedSigType(sig)->variability() < kSamp) return false;
+    if (!isSigBinOp(sig, &op, x, y) || (op != kAdd && op != kSub)) return false;
+    if (!addWeightedTerms(sig, 1, s, ops) || int(s.fTerms.size()) < mintaps) return false;
+
+    fir.fInput = 0;
+    fir.fCoefs.clear();
+    for (size_t k = 0; k < s.fTerms.size(); k++) {
+        Tree t = s.fTerms[k];
+        d = 0;
+        if (isSigFixDelay(t, x, delay)) {
+            if (!isSigInt(delay, &d) || d < 0) return false;
+            t = x;
+        }
+        if (fir.fInput == 0) {
+            fir.fInput = t;
+        } else if (t != fir.fInput) {
+            return false;
+        }
+        if (d >= int(fir.fCoefs.size())) fir.fCoefs.resize(d+1, 0.0);
+        fir.fCoefs[d] += s.fWeights[s.fTerms[k]];
+    }
+
+    for (size_t d = 0; d < fir.fCoefs.size(); d++) {
+        if (fir.fCoefs[d] != 0) taps++;
+    }
+    return taps >= mintaps && getCertifiedSigType(fir.fInput)->variability() == kSamp;
+}
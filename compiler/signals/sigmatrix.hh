@@ -0,0 +1,69 @@
+/************************************************************************
+ ************************************************************************
+    FAUST compiler
+	Copyright (C) 2016 GRAME, Centre National de Creation Musicale
+    ---------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ ************************************************************************
+ ************************************************************************/
+
+
+
+#ifndef _SIGMATRIX_
+#define _SIGMATRIX_
+
+#include <vector>
+#include "signals.hh"
+
+/**
+ * Outputs computed as the product of a constant matrix by a vector of signals :
+ * output fOutputs[j] is the sum of fCoefs[k][j] * fInputs[k] for all k.
+ */
+struct sigMatrix
+{
+    std::vector<int>                    fOutputs;   ///< index of the outputs
+    std::vector<Tree>                   fSignals;   ///< the signals of these outputs
+    std::vector<Tree>                   fInputs;    ///< the signals they combine
+    std::vector<std::vector<double> >   fCoefs;     ///< fCoefs[k][j] : weight of fInputs[k] in fOutputs[j]
+
+    bool isOutput(int i) const;
+};
+
+/**
+ * Find, in the list of (typed) output signals L, the outputs that are weighted
+ * sums of common signals with constant weights, like the mixing matrices or the
+ * ambisonic decoders. Returns false unless the matrix has at least minsize
+ * coefficients, at least half of them are not zero, and the kernel does not
+ * compute more products than the scalar code does operations. The outputs which
+ * are FIR filters of at least mintaps taps are not part of the matrix.
+ */
+bool findOutputMatrix(Tree L, int minsize, int mintaps, sigMatrix& matrix);
+
+/**
+ * A FIR filter of constant coefficients : the sum of fCoefs[d] * fInput@d for all d.
+ */
+struct sigFIR
+{
+    Tree                    fInput;     ///< the filtered signal
+    std::vector<double>     fCoefs;     ///< fCoefs[d] : weight of fInput delayed by d samples
+};
+
+/**
+ * Test if the (typed) signal sig is a sum of at least mintaps delays of the same
+ * signal with constant weights, like the filters of fi.fir.
+ */
+bool findFIR(Tree sig, int mintaps, sigFIR& fir);
+
+#endif
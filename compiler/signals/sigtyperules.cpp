@@ -26,6 +26,9 @@
 #include <iostream>
 #include <fstream>
 #include <time.h>
+#include <map>
+#include <set>
+#include <list>
 
 
 #include "sigtype.hh"
@@ -81,6 +84,21 @@ static int countMaximal;
 
 
 
+/**
+ * Dependency graph of the type inference : the users of a signal are the
+ * signals whose inferred type was computed from its type. It is recorded by
+ * T() during the first typing pass of typeAnnotation, and used to only
+ * re-type the signals whose inputs have changed while the types of the
+ * recursive groups converge.
+ */
+static map<Tree, vector<Tree> > gTypeUsers;
+static vector<Tree>     gTypeInferring;     // signals being typed, innermost last
+static bool             gRecordTypeUsers = false;
+
+static int countReinferences;
+static int countUpdates;
+
+
 /**
  * Fully annotate every subtree of term with type information.
  * @param sig the signal term tree to annotate
@@ -92,7 +110,6 @@ void typeAnnotation(Tree sig)
     int             n = len(sl);
 
     vector<Tree>    vrec, vdef;
-    vector<Type>    vtype;
 
     //cerr << "Symlist " << *sl << endl;
     for (Tree l=sl; isList(l); l=tl(l)) {
@@ -106,37 +123,49 @@ void typeAnnotation(Tree sig)
         vdef.push_back(body);
     }
 
-    // init recursive types
-    for (int i=0; i<n; i++) {
-        vtype.push_back(initialRecType(vdef[i]));
-    }
-
     assert (int(vrec.size())==n);
     assert (int(vdef.size())==n);
-    assert (int(vtype.size())==n);
 
-    // find least fixpoint
-    for (bool finished = false; !finished; ) {
+    // init recursive types
+    CTree::startNewVisit();
+    for (int i=0; i<n; i++) {
+        setSigType(vrec[i], initialRecType(vdef[i]));
+        vrec[i]->setVisited();
+    }
 
-        // init recursive types
-        CTree::startNewVisit();
-        for (int i=0; i<n; i++) {
-            setSigType(vrec[i], vtype[i]);
-            vrec[i]->setVisited();
-        }
+    // type the recursive definitions a first time, recording the dependencies
+    gTypeUsers.clear();
+    gRecordTypeUsers = true;
+    for (int i=0; i<n; i++) {
+        T(vdef[i], NULLTYPEENV);
+        gTypeUsers[vdef[i]].push_back(vrec[i]);
+    }
+    gRecordTypeUsers = false;
 
-        // compute recursive types
-        for (int i=0; i<n; i++) {
-            vtype[i] = T(vdef[i], NULLTYPEENV);
-        }
+    // find least fixpoint : re-type the users of every signal whose type changed,
+    // starting with the recursive symbols, until no type changes anymore
+    list<Tree>  worklist(vrec.begin(), vrec.end());
+    set<Tree>   queued(vrec.begin(), vrec.end());
 
-        // check finished
-        finished = true;
-        for (int i=0; i<n; i++) {
-            //cerr << i << "-" << *vrec[i] << ":" << *getSigType(vrec[i]) << " => " << *vtype[i] << endl;
-            finished =  finished & (getSigType(vrec[i]) == vtype[i]);
+    while (!worklist.empty()) {
+        Tree    sig = worklist.front();
+        Tree    id, body;
+        worklist.pop_front();
+        queued.erase(sig);
+        countReinferences++;
+
+        Type    ty = (isRec(sig, id, body)) ? getSigType(body) : infereSigType(sig, NULLTYPEENV);
+        if (ty == getSigType(sig)) continue;
+
+        //cerr << *sig << ":" << *getSigType(sig) << " => " << *ty << endl;
+        countUpdates++;
+        setSigType(sig, ty);
+        const vector<Tree>& users = gTypeUsers[sig];
+        for (size_t i=0; i<users.size(); i++) {
+            if (queued.insert(users[i]).second) worklist.push_back(users[i]);
         }
     }
+    gTypeUsers.clear();
 
     // type full term
     T(sig, NULLTYPEENV);
@@ -146,6 +175,7 @@ void typeAnnotation(Tree sig)
 void annotationStatistics()
 {
     cerr << TABBER << "COUNT INFERENCE  " << countInferences << " AT TIME " << clock()/CLOCKS_PER_SEC << 's' << endl;
+    cerr << TABBER << "COUNT REINFERENCE " << countReinferences << " (" << countUpdates << " TYPE UPDATES)" << endl;
     cerr << TABBER << "COUNT ALLOCATION " << AudioType::gAllocationCount << endl;
     cerr << TABBER << "COUNT MAXIMAL " << countMaximal << endl;
 }
@@ -224,13 +254,19 @@ static Type T(Tree term, Tree ignoreenv)
 {
     TRACE(cerr << ++TABBER << "ENTER T() " << *term << endl;)
 
+    if (gRecordTypeUsers && !gTypeInferring.empty()) {
+        gTypeUsers[term].push_back(gTypeInferring.back());
+    }
+
     if (term->isAlreadyVisited()) {
         Type    ty =  getSigType(term);
         TRACE(cerr << --TABBER << "EXIT 1 T() " << *term << " AS TYPE " << *ty << endl);
         return ty;
 
     } else {
+        gTypeInferring.push_back(term);
         Type ty = infereSigType(term, ignoreenv);
+        gTypeInferring.pop_back();
         setSigType(term,ty);
         term->setVisited();
         TRACE(cerr << --TABBER << "EXIT 2 T() " << *term << " AS TYPE " << *ty << endl);
@@ -99,6 +99,9 @@ static void error(const char * s, Tree t)
 Tree CTree::gHashTable[kHashTableSize];
 bool CTree::gDetails = false;
 unsigned int  CTree::gVisitTime = 0;
+int CTree::gTreeCount = 0;
+int CTree::gUsedEntries = 0;
+long CTree::gPropertyCount = 0;
 
 // Constructor : add the tree to the hash table
 CTree::CTree (unsigned int hk, const Node& n, const tvec& br) 
@@ -113,6 +116,8 @@ CTree::CTree (unsigned int hk, const Node& n, const tvec& br)
    	int j = hk % kHashTableSize;
 	fNext = gHashTable[j];
 	gHashTable[j] = this;
+	gTreeCount++;
+	if (!fNext) gUsedEntries++;
 
 }
 
@@ -123,8 +128,11 @@ CTree::~CTree ()
 	Tree	t = gHashTable[i];
 	
 	//printf("Delete of "); this->print(); printf("\n");
+	gTreeCount--;
+	gPropertyCount -= fProperties.size();
 	if (t == this) {
 		gHashTable[i] = fNext;
+		if (!fNext) gUsedEntries--;
 	} else {
 		Tree p;
 		while (t != this) {
@@ -146,14 +154,28 @@ Sym PROCESS = symbol("process");
 		
 
 
+/**
+ * The hash key of a tree mixes the bits of the node (both words of a double,
+ * so that "round" values do not all have the same key) with the keys of the
+ * branches. The multiplication spreads each branch key over all bits, so that
+ * trees differing only by small integers or aligned pointers (like environment
+ * layers or evaluation keys) do not end up in the same buckets.
+ */
 unsigned int CTree::calcTreeHash( const Node& n, const tvec& br )
 {
 	unsigned int 			hk = n.type() ^ n.getInt();
 	tvec::const_iterator  b = br.begin();
 	tvec::const_iterator  z = br.end();
+
+	if (n.type() == kDoubleNode) {
+		double			f = n.getDouble();
+		unsigned int	w[2];
+		memcpy(w, &f, sizeof(w));
+		hk = n.type() ^ w[0] ^ w[1];
+	}
 	
 	while (b != z) {
-    	hk = (hk << 1) ^ (hk >> 20) ^ ((*b)->fHashKey);
+    	hk = ((hk << 5) ^ (hk >> 27) ^ ((*b)->fHashKey)) * 0x9E3779B1;
 		++b;
 	}
 	return hk;
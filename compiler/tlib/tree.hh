@@ -115,6 +115,9 @@ class CTree
  public:
 	static bool			gDetails;					///< Ctree::print() print with more details when true
     static unsigned int gVisitTime;                 ///< Should be incremented for each new visit to keep track of visited tree.
+    static int          gTreeCount;                 ///< number of trees in the hash table
+    static int          gUsedEntries;               ///< number of non empty entries of the hash table
+    static long         gPropertyCount;             ///< number of properties attached to the trees
 
  private:
 	// fields
@@ -152,6 +155,7 @@ class CTree
 	// Print a tree and the hash table (for debugging purposes)
 	ostream& 	print (ostream& fout) const; 					///< print recursively the content of a tree on a stream
 	static void control ();										///< print the hash table content (for debug purpose)
+	static int 	hashTableSize() 	{ return kHashTableSize; }	///< number of entries of the hash table
 
 	// type information
 	void		setType(void* t) 	{ fType = t; }
@@ -164,9 +168,9 @@ class CTree
 
 
 	// Property list of a tree
-	void		setProperty(Tree key, Tree value) { fProperties[key] = value; }
-	void		clearProperty(Tree key) { fProperties.erase(key); }
-	void		clearProperties()		{ fProperties = plist(); }
+	void		setProperty(Tree key, Tree value) { size_t n = fProperties.size(); fProperties[key] = value; gPropertyCount += fProperties.size() - n; }
+	void		clearProperty(Tree key) { gPropertyCount -= fProperties.erase(key); }
+	void		clearProperties()		{ gPropertyCount -= fProperties.size(); fProperties = plist(); }
 
 	void		exportProperties(vector<Tree>& keys, vector<Tree>& values);
 
@@ -0,0 +1,89 @@
+/*
+ * DSP instantiation benchmark : clone + init versus cloneState and dsp_pool
+ * (their output is checked by the cloneState and dsp_pool modes of the impulse tests)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include <vector>
+
+using namespace std;
+
+#include "faust/gui/UI.h"
+#include "faust/gui/meta.h"
+#include "faust/dsp/dsp.h"
+#include "faust/dsp/dsp-pool.h"
+
+#include "freeverb.h"
+
+static double now()
+{
+    struct timeval tv;
+    gettimeofday(&tv, 0);
+    return tv.tv_sec * 1e6 + tv.tv_usec;
+}
+
+static void deleteAll(vector<dsp*>& instances)
+{
+    for (size_t i = 0; i < instances.size(); i++) {
+        delete instances[i];
+    }
+    instances.clear();
+}
+
+int main(int argc, char* argv[])
+{
+    int instances = 1000;
+    int sample_rate = 44100;
+
+    for (int i = 1; i < argc - 1; i++) {
+        if (strcmp(argv[i], "--instances") == 0) instances = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--sample-rate") == 0) sample_rate = atoi(argv[++i]);
+    }
+
+    freeverb prototype;
+    prototype.init(sample_rate);
+    vector<dsp*> list;
+    list.reserve(instances);
+
+    // clone + init
+    double t0 = now();
+    for (int i = 0; i < instances; i++) {
+        dsp* dsp = prototype.clone();
+        dsp->init(sample_rate);
+        list.push_back(dsp);
+    }
+    double init_time = now() - t0;
+    deleteAll(list);
+
+    // cloneState
+    t0 = now();
+    for (int i = 0; i < instances; i++) {
+        list.push_back(prototype.cloneState());
+    }
+    double clone_time = now() - t0;
+    deleteAll(list);
+
+    // dsp_pool : reserve, then acquire/release
+    t0 = now();
+    dsp_pool pool(new freeverb(), sample_rate, instances);
+    double reserve_time = now() - t0;
+    t0 = now();
+    for (int i = 0; i < instances; i++) {
+        list.push_back(pool.acquire());
+    }
+    double acquire_time = now() - t0;
+    for (size_t i = 0; i < list.size(); i++) {
+        pool.release(list[i]);
+    }
+    list.clear();
+
+    printf("%d instances of freeverb (%lu bytes each)\n", instances, (unsigned long)sizeof(freeverb));
+    printf("clone + init : %.2f usec per instance\n", init_time / instances);
+    printf("cloneState   : %.2f usec per instance\n", clone_time / instances);
+    printf("dsp_pool     : %.2f usec per instance to reserve, %.2f usec per acquire\n", reserve_time / instances, acquire_time / instances);
+    return 0;
+}
@@ -0,0 +1,156 @@
+/*
+ * DSP descriptor decoding benchmark: JSON (JSONUIDecoder) versus binary (BinaryUIDecoder)
+ * Both decoders are checked to give the same interface by impulse-tests/checks/descriptor.cpp.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include <fstream>
+#include <sstream>
+#include <string>
+
+using namespace std;
+
+#include "faust/dsp/proxy-dsp.h"
+
+static double now()
+{
+    struct timeval tv;
+    gettimeofday(&tv, 0);
+    return tv.tv_sec * 1e6 + tv.tv_usec;
+}
+
+// Counts the calls, used for timing
+class CountUI : public UI, public Meta
+{
+    public:
+
+        int fCount;
+
+        CountUI():fCount(0) {}
+
+        void openTabBox(const char* label) { fCount++; }
+        void openHorizontalBox(const char* label) { fCount++; }
+        void openVerticalBox(const char* label) { fCount++; }
+        void closeBox() { fCount++; }
+        void addButton(const char* label, FAUSTFLOAT* zone) { fCount++; }
+        void addCheckButton(const char* label, FAUSTFLOAT* zone) { fCount++; }
+        void addVerticalSlider(const char* label, FAUSTFLOAT* zone, FAUSTFLOAT init, FAUSTFLOAT min, FAUSTFLOAT max, FAUSTFLOAT step) { fCount++; }
+        void addHorizontalSlider(const char* label, FAUSTFLOAT* zone, FAUSTFLOAT init, FAUSTFLOAT min, FAUSTFLOAT max, FAUSTFLOAT step) { fCount++; }
+        void addNumEntry(const char* label, FAUSTFLOAT* zone, FAUSTFLOAT init, FAUSTFLOAT min, FAUSTFLOAT max, FAUSTFLOAT step) { fCount++; }
+        void addHorizontalBargraph(const char* label, FAUSTFLOAT* zone, FAUSTFLOAT min, FAUSTFLOAT max) { fCount++; }
+        void addVerticalBargraph(const char* label, FAUSTFLOAT* zone, FAUSTFLOAT min, FAUSTFLOAT max) { fCount++; }
+        void declare(FAUSTFLOAT* zone, const char* key, const char* val) { fCount++; }
+        void declare(const char* key, const char* value) { fCount++; }
+};
+
+// the same interface is given to the JSON and to the binary builders
+template <typename BUILDER>
+static void buildSyntheticUI(BUILDER& builder, int controls)
+{
+    builder.declare("name", "synthetic");
+    builder.declare("author", "GRAME");
+    builder.openVerticalBox("synthetic");
+    for (int i = 0; i < controls; i++) {
+        char label[64];
+        if (i % 16 == 0) {
+            if (i > 0) builder.closeBox();
+            snprintf(label, 64, "group%d", i / 16);
+            builder.openHorizontalBox(label);
+        }
+        snprintf(label, 64, "control%d", i);
+        builder.declare(0, "style", "knob");
+        builder.declare(0, "unit", "Hz");
+        switch (i % 8) {
+            case 0: builder.addButton(label, 0); break;
+            case 1: builder.addCheckButton(label, 0); break;
+            case 2: builder.addNumEntry(label, 0, i % 100, 0, 1000, 0.5); break;
+            case 3: builder.addHorizontalBargraph(label, 0, -1, 1); break;
+            default: builder.addHorizontalSlider(label, 0, i % 100, 0, 1000, 0.5); break;
+        }
+    }
+    builder.closeBox();
+    builder.closeBox();
+}
+
+static void buildSynthetic(int controls, string& json, string& binary)
+{
+    JSONUI json_builder("synthetic", 2, 2);
+    buildSyntheticUI(json_builder, controls);
+    json = json_builder.JSON();
+    BinaryUI binary_builder("synthetic", 2, 2, "");
+    buildSyntheticUI(binary_builder, controls);
+    binary = binary_builder.binary();
+}
+
+static bool readFile(const char* name, string& res)
+{
+    ifstream in(name, ios::binary);
+    if (!in) return false;
+    stringstream buffer;
+    buffer << in.rdbuf();
+    res = buffer.str();
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    int controls = 4096;
+    int runs = 100;
+    string json, binary;
+
+    if (argc == 3 && argv[1][0] != '-') {
+        if (!readFile(argv[1], json) || !readFile(argv[2], binary)) {
+            fprintf(stderr, "cannot read '%s' or '%s'\n", argv[1], argv[2]);
+            return 1;
+        }
+    } else {
+        for (int i = 1; i < argc - 1; i++) {
+            if (strcmp(argv[i], "--controls") == 0) controls = atoi(argv[++i]);
+            else if (strcmp(argv[i], "--runs") == 0) runs = atoi(argv[++i]);
+        }
+        buildSynthetic(controls, json, binary);
+    }
+
+    // The binary descriptor must be 8 bytes aligned, as when it is mmap'ed
+    vector<uint64_t> aligned((binary.size() + 7) / 8);
+    memcpy(&aligned[0], binary.data(), binary.size());
+    const char* descriptor = (const char*)&aligned[0];
+
+    if (!BinaryUIDecoder::isValid(descriptor, binary.size())) {
+        fprintf(stderr, "invalid binary descriptor\n");
+        return 1;
+    }
+
+    double json_time = 0, binary_time = 0;
+    int calls = 0;
+
+    for (int run = 0; run < runs; run++) {
+        CountUI ui1, ui2;
+        double t0 = now();
+        {
+            proxy_dsp proxy(json);
+            proxy.metadata(&ui1);
+            proxy.buildUserInterface(&ui1);
+        }
+        double t1 = now();
+        {
+            proxy_dsp proxy(descriptor, binary.size());
+            proxy.metadata(&ui2);
+            proxy.buildUserInterface(&ui2);
+        }
+        double t2 = now();
+        json_time += t1 - t0;
+        binary_time += t2 - t1;
+        calls = ui2.fCount;
+    }
+
+    printf("descriptor sizes : JSON %lu bytes, binary %lu bytes\n", (unsigned long)json.size(), (unsigned long)binary.size());
+    printf("UI calls : %d\n", calls);
+    printf("JSON   : %.1f usec per attach\n", json_time / runs);
+    printf("binary : %.1f usec per attach\n", binary_time / runs);
+    return 0;
+}
@@ -0,0 +1,142 @@
+/*
+ * libfaust benchmark : sequential and concurrent compilations with libfaust
+ * (checked by impulse-tests/checks/libfaust.cpp)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <pthread.h>
+#include <sys/time.h>
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+
+#include "faust/dsp/libfaust.h"
+
+static double now()
+{
+    struct timeval tv;
+    gettimeofday(&tv, 0);
+    return tv.tv_sec * 1e6 + tv.tv_usec;
+}
+
+static std::string readFile(const char* filename)
+{
+    std::ifstream file(filename);
+    std::stringstream content;
+    content << file.rdbuf();
+    return content.str();
+}
+
+// Some labels are made of tree addresses
+static std::string normalize(const std::string& code)
+{
+    std::string res;
+    for (size_t i = 0; i < code.size(); i++) {
+        if (code.compare(i, 2, "0x") == 0 && i + 2 < code.size() && isxdigit(code[i + 2])) {
+            res += "0x";
+            for (i += 2; i < code.size() && isxdigit(code[i]); i++) {}
+            i--;
+        } else {
+            res += code[i];
+        }
+    }
+    return res;
+}
+
+struct Job {
+    std::string fName;
+    std::string fSource;
+    faust_options fOptions;
+    faust_result fResult;
+    bool fSuccess;
+};
+
+static std::vector<Job> gJobs;
+static int gNext = 0;
+static pthread_mutex_t gLock = PTHREAD_MUTEX_INITIALIZER;
+
+static void compileJob(Job& job)
+{
+    job.fSuccess = compileFaustDSP(job.fName, job.fSource, job.fOptions, job.fResult);
+}
+
+// Thread pool worker : compiles the jobs until there are none left
+static void* worker(void* arg)
+{
+    while (true) {
+        pthread_mutex_lock(&gLock);
+        int job = gNext++;
+        pthread_mutex_unlock(&gLock);
+        if (job >= int(gJobs.size())) return 0;
+        compileJob(gJobs[job]);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    int threads = 4;
+    const char* libraries = "../../libraries";
+    const char* compiler = "../../compiler/faust";
+    std::vector<std::string> files;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) threads = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--libraries") == 0 && i + 1 < argc) libraries = argv[++i];
+        else if (strcmp(argv[i], "--faust") == 0 && i + 1 < argc) compiler = argv[++i];
+        else files.push_back(argv[i]);
+    }
+    if (files.empty()) {
+        printf("usage : libfaustbench [--threads <n>] [--libraries <dir>] [--faust <compiler>] file.dsp ...\n");
+        return 1;
+    }
+
+    for (size_t i = 0; i < files.size(); i++) {
+        Job job;
+        job.fName = files[i];
+        job.fSource = readFile(files[i].c_str());
+        // the source is compiled in a temporary directory : its own directory is searched for its imports
+        size_t slash = files[i].rfind('/');
+        job.fOptions.fImportDirs.push_back((slash == std::string::npos) ? "." : files[i].substr(0, slash));
+        job.fOptions.fImportDirs.push_back(libraries);
+        job.fOptions.fJSON = true;
+        job.fOptions.fCompiler = compiler;
+        gJobs.push_back(job);
+    }
+
+    // Sequential compilations, the references
+    double t0 = now();
+    for (size_t i = 0; i < gJobs.size(); i++) {
+        compileJob(gJobs[i]);
+    }
+    double sequential = now() - t0;
+    std::vector<Job> reference = gJobs;
+
+    // Concurrent compilations
+    t0 = now();
+    std::vector<pthread_t> pool(threads);
+    for (int i = 0; i < threads; i++) pthread_create(&pool[i], 0, worker, 0);
+    for (int i = 0; i < threads; i++) pthread_join(pool[i], 0);
+    double concurrent = now() - t0;
+
+    // The metadata, the terms of commutative operations and some names are ordered by tree address,
+    // so the code of a compilation may be a permutation of the one of another compilation
+    int failed = 0, reordered = 0;
+    for (size_t i = 0; i < gJobs.size(); i++) {
+        if (!gJobs[i].fSuccess) {
+            failed++;
+            printf("%s : %s", gJobs[i].fName.c_str(), gJobs[i].fResult.fMessages.c_str());
+        } else if (normalize(gJobs[i].fResult.fCode) != normalize(reference[i].fResult.fCode)
+                   || normalize(gJobs[i].fResult.fJSON) != normalize(reference[i].fResult.fJSON)) {
+            reordered++;
+        }
+    }
+
+    printf("%d files, %d failed, %d reordered\n", int(gJobs.size()), failed, reordered);
+    printf("sequential : %.1f ms, %d threads : %.1f ms\n", sequential / 1000, threads, concurrent / 1000);
+    return 0;
+}
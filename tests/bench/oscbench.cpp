@@ -0,0 +1,153 @@
+/*
+    Loopback UDP benchmark of the OSCUI values transmission
+    (one packet per value, OSC bundles, rate and change thresholds).
+    The reception of each change is checked by impulse-tests/checks/oscbundle.cpp.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/time.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <string>
+#include <vector>
+
+#include "faust/misc.h"
+#include "faust/gui/OSCUI.h"
+
+std::list<GUI*> GUI::fGuiList;
+ztimedmap GUI::gTimedZoneMap;
+
+static double now()
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return double(tv.tv_sec) + double(tv.tv_usec) * 1e-6;
+}
+
+static double threadTime()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return double(ts.tv_sec) + double(ts.tv_nsec) * 1e-9;
+}
+
+static int openReceiver(int port)
+{
+    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int size = 8 * 1024 * 1024;
+    setsockopt(sock, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (bind(sock, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        perror("bind");
+        exit(1);
+    }
+    fcntl(sock, F_SETFL, O_NONBLOCK);
+    return sock;
+}
+
+// count the messages of an OSC packet, bundles included
+static int countMessages(const char* data, int size)
+{
+    if (size >= 16 && strcmp(data, "#bundle") == 0) {
+        int count = 0;
+        for (int pos = 16; pos + 4 <= size; ) {
+            int len = ntohl(*(const unsigned int*)(data + pos));
+            count += countMessages(data + pos + 4, len);
+            pos += 4 + len;
+        }
+        return count;
+    }
+    return 1;
+}
+
+struct receiver_stats {
+    long fPackets, fMessages, fBytes;
+    receiver_stats() : fPackets(0), fMessages(0), fBytes(0) {}
+};
+
+static void drain(int sock, receiver_stats& stats)
+{
+    char buffer[65536];
+    int size;
+    while ((size = recv(sock, buffer, sizeof(buffer), 0)) > 0) {
+        stats.fPackets++;
+        stats.fBytes += size;
+        stats.fMessages += countMessages(buffer, size);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    int zones = int(lopt(argv, "--zones", 256));
+    int updates = int(lopt(argv, "--updates", 2000));
+    int tick = int(lopt(argv, "--tick", 0));
+    int port = 5600;
+
+    // the OSC options given on the command line come first, so that they override the defaults
+    std::vector<char*> args(argv, argv + argc);
+    const char* defaults[] = { "-xmit", "1", "-desthost", "127.0.0.1", "-outport", "5600" };
+    for (size_t i = 0; i < sizeof(defaults) / sizeof(char*); i++) {
+        args.push_back((char*)defaults[i]);
+    }
+    for (size_t i = 0; i + 1 < args.size(); i++) {
+        if (strcmp(args[i], "-outport") == 0) { port = atoi(args[i + 1]); break; }
+    }
+    int sock = openReceiver(port);
+
+    std::vector<FAUSTFLOAT> values(zones, 0);
+    OSCUI* ui = new OSCUI("oscbench", int(args.size()), &args[0]);
+    ui->openVerticalBox("oscbench");
+    for (int i = 0; i < zones; i++) {
+        char label[64];
+        sprintf(label, "meter%d", i);
+        ui->addHorizontalBargraph(label, &values[i], FAUSTFLOAT(0), FAUSTFLOAT(1));
+    }
+    ui->closeBox();
+    ui->run();
+    usleep(100000);
+
+    receiver_stats stats;
+    drain(sock, stats);
+    stats = receiver_stats();
+
+    double cpu = 0;
+    double t1 = now();
+    for (int u = 0; u < updates; u++) {
+        // slowly moving meters
+        for (int i = 0; i < zones; i++) {
+            values[i] = FAUSTFLOAT(0.5 + 0.5 * sin(0.01 * u + i));
+        }
+        double c1 = threadTime();
+        GUI::updateAllGuis();
+        cpu += threadTime() - c1;
+        drain(sock, stats);
+        if (tick) usleep(1000000 / tick);
+    }
+    usleep(100000);
+    drain(sock, stats);
+    double elapsed = now() - t1;
+
+    printf("%d zones, %d updates in %.2f s\n", zones, updates, elapsed);
+    printf("packets    : %ld (%.0f packets/s, %.1f bytes/packet)\n",
+           stats.fPackets, stats.fPackets / elapsed, stats.fPackets ? double(stats.fBytes) / stats.fPackets : 0.);
+    printf("messages   : %ld (%.1f messages/packet, %.1f%% of the changes)\n",
+           stats.fMessages, stats.fPackets ? double(stats.fMessages) / stats.fPackets : 0.,
+           100. * stats.fMessages / (double(zones) * updates));
+    printf("cpu/update : %.1f us (%.3f us/zone)\n", 1e6 * cpu / updates, 1e6 * cpu / (double(updates) * zones));
+
+    ui->stop();
+    delete ui;
+    close(sock);
+    return 0;
+}
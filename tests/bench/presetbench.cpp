@@ -0,0 +1,102 @@
+/*
+ * Preset morphing benchmark for PresetUI / preset_dsp
+ * The atomic recall and the morphing values are checked by impulse-tests/checks/presets.cpp.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include "faust/dsp/preset-dsp.h"
+
+static double now()
+{
+    struct timeval tv;
+    gettimeofday(&tv, 0);
+    return tv.tv_sec * 1e6 + tv.tv_usec;
+}
+
+// A DSP with 'controls' sliders
+class test_dsp : public dsp {
+
+    public:
+
+        std::vector<FAUSTFLOAT> fZones;
+
+        test_dsp(int controls):fZones(controls, 0) {}
+
+        virtual int getNumInputs() { return 0; }
+        virtual int getNumOutputs() { return 0; }
+        virtual void buildUserInterface(UI* ui)
+        {
+            ui->openVerticalBox("test");
+            for (size_t i = 0; i < fZones.size(); i++) {
+                char label[64];
+                snprintf(label, 64, "control%d", int(i));
+                ui->addHorizontalSlider(label, &fZones[i], 0, 0, 1e6, 1);
+            }
+            ui->closeBox();
+        }
+        virtual int getSampleRate() { return 44100; }
+        virtual void init(int samplingRate) {}
+        virtual void instanceInit(int samplingRate) {}
+        virtual void instanceConstants(int samplingRate) {}
+        virtual void instanceResetUserInterface() {}
+        virtual void instanceClear() {}
+        virtual dsp* clone() { return new test_dsp(int(fZones.size())); }
+        virtual void metadata(Meta* m) {}
+
+        virtual void compute(int count, FAUSTFLOAT** inputs, FAUSTFLOAT** outputs) {}
+};
+
+int main(int argc, char* argv[])
+{
+    int controls = 4096;
+    int presets = 8;
+    int blocks = 10000;
+
+    for (int i = 1; i < argc - 1; i++) {
+        if (strcmp(argv[i], "--controls") == 0) controls = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--presets") == 0) presets = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--blocks") == 0) blocks = atoi(argv[++i]);
+    }
+
+    test_dsp* test = new test_dsp(controls);
+    preset_dsp dsp(test);
+    PresetUI* ui = dsp.getPresets();
+
+    for (int p = 0; p < presets; p++) {
+        for (int i = 0; i < controls; i++) {
+            test->fZones[i] = FAUSTFLOAT(p * 1000 + i);
+        }
+        ui->storePreset();
+    }
+
+    // Morphing cost : new weights at each block
+    std::vector<FAUSTFLOAT> weights(presets);
+    double morph_time = 0;
+    for (int b = 0; b < blocks; b++) {
+        for (int p = 0; p < presets; p++) {
+            weights[p] = FAUSTFLOAT((b + p) % presets + 1);
+        }
+        ui->morph(weights);
+        double t0 = now();
+        ui->process();
+        morph_time += now() - t0;
+    }
+    printf("morph : %d controls, %d presets, %.2f usec per block\n", controls, presets, morph_time / blocks);
+
+    // Ramp cost : morph over 'blocks' blocks
+    ui->setMorphBlocks(blocks);
+    ui->recallPreset(0);
+    ui->process();
+    ui->morph(weights);
+    double t0 = now();
+    for (int b = 0; b < blocks; b++) {
+        ui->process();
+    }
+    printf("ramp : %.2f usec per block\n", (now() - t0) / blocks);
+
+    return 0;
+}
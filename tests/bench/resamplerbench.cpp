@@ -0,0 +1,113 @@
+/*
+ * CPU benchmark for dsp_resampler (its accuracy is checked by impulse-tests/checks/resampler.cpp)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include <vector>
+
+#include "faust/gui/UI.h"
+#include "faust/gui/meta.h"
+#include "faust/dsp/dsp-resampler.h"
+
+#define BLOCK 512
+
+static double now()
+{
+    struct timeval tv;
+    gettimeofday(&tv, 0);
+    return tv.tv_sec * 1e6 + tv.tv_usec;
+}
+
+// Copies its input, or runs a cascade of 'stages' resonant filters when 'stages' > 0
+class test_dsp : public dsp {
+
+    public:
+
+        int fStages;
+        int fSampleRate;
+        std::vector<double> fState;
+
+        test_dsp(int stages = 0):fStages(stages), fSampleRate(0), fState(stages * 2, 0) {}
+
+        virtual int getNumInputs() { return 1; }
+        virtual int getNumOutputs() { return 1; }
+        virtual void buildUserInterface(UI* ui) {}
+        virtual int getSampleRate() { return fSampleRate; }
+        virtual void init(int samplingRate) { fSampleRate = samplingRate; }
+        virtual void instanceInit(int samplingRate) { fSampleRate = samplingRate; }
+        virtual void instanceConstants(int samplingRate) { fSampleRate = samplingRate; }
+        virtual void instanceResetUserInterface() {}
+        virtual void instanceClear() {}
+        virtual dsp* clone() { return new test_dsp(fStages); }
+        virtual void metadata(Meta* m) {}
+
+        virtual void compute(int count, FAUSTFLOAT** inputs, FAUSTFLOAT** outputs)
+        {
+            for (int i = 0; i < count; i++) {
+                double x = inputs[0][i];
+                for (int s = 0; s < fStages; s++) {
+                    double y = x + 1.8 * fState[2 * s] - 0.81 * fState[2 * s + 1];
+                    fState[2 * s + 1] = fState[2 * s];
+                    fState[2 * s] = y;
+                    x = y * 0.01;
+                }
+                outputs[0][i] = FAUSTFLOAT(x);
+            }
+        }
+};
+
+// Runs 'dsp' on 'input' with blocks of BLOCK samples
+static std::vector<FAUSTFLOAT> run(dsp* dsp, const std::vector<FAUSTFLOAT>& input)
+{
+    std::vector<FAUSTFLOAT> output(input.size());
+    for (size_t pos = 0; pos < input.size(); ) {
+        int count = std::min(int(input.size() - pos), BLOCK);
+        FAUSTFLOAT* in = const_cast<FAUSTFLOAT*>(&input[pos]);
+        FAUSTFLOAT* out = &output[pos];
+        dsp->compute(count, &in, &out);
+        pos += count;
+    }
+    return output;
+}
+
+int main(int argc, char* argv[])
+{
+    int stages = 64;
+    int blocks = 2000;
+
+    for (int i = 1; i < argc - 1; i++) {
+        if (strcmp(argv[i], "--stages") == 0) stages = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--blocks") == 0) blocks = atoi(argv[++i]);
+    }
+
+    // CPU : an expensive DSP at the audio rate, and at a quarter of it
+    std::vector<FAUSTFLOAT> input(BLOCK * blocks);
+    for (size_t i = 0; i < input.size(); i++) {
+        input[i] = FAUSTFLOAT(rand()) / RAND_MAX - 0.5f;
+    }
+    test_dsp direct(stages);
+    direct.init(44100);
+    double t0 = now();
+    run(&direct, input);
+    double direct_time = now() - t0;
+
+    dsp_resampler reduced(new test_dsp(stages), 1, 4, BLOCK);
+    reduced.init(44100);
+    t0 = now();
+    run(&reduced, input);
+    double reduced_time = now() - t0;
+
+    dsp_resampler conversion(new test_dsp(0), 1, 4, BLOCK);
+    conversion.init(44100);
+    t0 = now();
+    run(&conversion, input);
+    double conversion_time = now() - t0;
+
+    printf("%d stages filter : %.2f usec per block at the audio rate, %.2f usec at 1 / 4 (%.2f for the rate conversions)\n",
+           stages, direct_time / blocks, reduced_time / blocks, conversion_time / blocks);
+    return 0;
+}
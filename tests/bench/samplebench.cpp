@@ -0,0 +1,118 @@
+/*
+    Microbenchmark of the sample format conversions of 'faust/audio/sample-format.h'
+    compared to the scalar per-sample loops previously used in the audio drivers.
+    Both versions are checked to give the same samples by impulse-tests/checks/sampleformat.cpp.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <sys/time.h>
+#include <vector>
+
+#include "faust/misc.h"
+#include "faust/audio/sample-format.h"
+
+static double now()
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return double(tv.tv_sec) + double(tv.tv_usec) * 1e-6;
+}
+
+// Previous driver code : interleaved loops, one sample at a time
+template <class FORMAT>
+static void scalarRead(const typename FORMAT::type* src, int channels, int frames, float** dst)
+{
+    for (int f = 0; f < frames; f++) {
+        for (int c = 0; c < channels; c++) {
+            dst[c][f] = FORMAT::toFloat(src[c + f * channels]);
+        }
+    }
+}
+
+template <class FORMAT>
+static void scalarWrite(float** src, int channels, int frames, typename FORMAT::type* dst)
+{
+    for (int f = 0; f < frames; f++) {
+        for (int c = 0; c < channels; c++) {
+            dst[c + f * channels] = FORMAT::fromFloat(src[c][f]);
+        }
+    }
+}
+
+template <class FORMAT>
+static void bench(const char* name, sample_format format, int channels, int frames, int count)
+{
+    typedef typename FORMAT::type type;
+    int size = sampleFormatSize(format);
+
+    std::vector<float> soft1(channels * frames), soft2(channels * frames);
+    std::vector<float*> chans1(channels), chans2(channels);
+    std::vector<char> card1(channels * frames * size), card2(channels * frames * size);
+
+    for (int c = 0; c < channels; c++) {
+        chans1[c] = &soft1[c * frames];
+        chans2[c] = &soft2[c * frames];
+        // signal going over [-1..1] to test clipping
+        for (int f = 0; f < frames; f++) {
+            chans1[c][f] = 1.2f * sinf(float(f * (c + 1)) * 0.01f);
+        }
+    }
+
+    writeSamples(format, &chans1[0], channels, frames, &card1[0]);
+
+    double samples = double(channels) * double(frames) * double(count) * 1e-6;
+    double t1, t2;
+
+    t1 = now();
+    for (int i = 0; i < count; i++) {
+        scalarRead<FORMAT>((const type*)&card1[0], channels, frames, &chans2[0]);
+    }
+    t2 = now();
+    double scalarIn = samples / (t2 - t1);
+
+    t1 = now();
+    for (int i = 0; i < count; i++) {
+        readSamples(format, &card1[0], channels, frames, &chans1[0]);
+    }
+    t2 = now();
+    double libIn = samples / (t2 - t1);
+
+    t1 = now();
+    for (int i = 0; i < count; i++) {
+        scalarWrite<FORMAT>(&chans1[0], channels, frames, (type*)&card2[0]);
+    }
+    t2 = now();
+    double scalarOut = samples / (t2 - t1);
+
+    t1 = now();
+    for (int i = 0; i < count; i++) {
+        writeSamples(format, &chans1[0], channels, frames, &card1[0]);
+    }
+    t2 = now();
+    double libOut = samples / (t2 - t1);
+
+    printf("%-10s : read %8.1f -> %8.1f Msamples/s (x%.1f), write %8.1f -> %8.1f Msamples/s (x%.1f)\n",
+           name, scalarIn, libIn, libIn / scalarIn, scalarOut, libOut, libOut / scalarOut);
+}
+
+int main(int argc, char* argv[])
+{
+    int channels = int(lopt(argv, "--channels", 64));
+    int frames = int(lopt(argv, "--frames", 512));
+    int count = int(lopt(argv, "--count", 2000));
+
+#ifdef SAMPLE_FORMAT_SSE2
+    printf("SSE2 version, %d channels, %d frames, %d buffers\n", channels, frames, count);
+#else
+    printf("scalar version, %d channels, %d frames, %d buffers\n", channels, frames, count);
+#endif
+
+    bench<sample_f32>("float", kSampleFloat32, channels, frames, count);
+    bench<sample_s16>("S16", kSampleS16, channels, frames, count);
+    bench<sample_s24>("S24", kSampleS24, channels, frames, count);
+    bench<sample_s24_packed>("S24 packed", kSampleS24Packed, channels, frames, count);
+    bench<sample_s32>("S32", kSampleS32, channels, frames, count);
+    return 0;
+}
@@ -0,0 +1,137 @@
+/*
+ * Hot swap benchmark for swap_dsp : DSPs are replaced while the audio thread runs
+ * (checked by impulse-tests/checks/swap.cpp)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include "faust/dsp/swap-dsp.h"
+
+static double now()
+{
+    struct timeval tv;
+    gettimeofday(&tv, 0);
+    return tv.tv_sec * 1e6 + tv.tv_usec;
+}
+
+// Stereo DSP outputting 'level' * 'gain' on both channels, with a 'gain' slider and a 'level' bargraph
+class test_dsp : public dsp {
+
+    public:
+
+        FAUSTFLOAT fLevel;
+        FAUSTFLOAT fGain;
+        FAUSTFLOAT fMeter;
+
+        test_dsp(FAUSTFLOAT level):fLevel(level), fGain(1), fMeter(0) {}
+
+        virtual int getNumInputs() { return 2; }
+        virtual int getNumOutputs() { return 2; }
+        virtual void buildUserInterface(UI* ui)
+        {
+            ui->openVerticalBox("test");
+            ui->addHorizontalSlider("gain", &fGain, 1, 0, 1, 0.01);
+            ui->addHorizontalBargraph("level", &fMeter, 0, 1);
+            ui->closeBox();
+        }
+        virtual int getSampleRate() { return 44100; }
+        virtual void init(int samplingRate) {}
+        virtual void instanceInit(int samplingRate) {}
+        virtual void instanceConstants(int samplingRate) {}
+        virtual void instanceResetUserInterface() { fGain = 1; }
+        virtual void instanceClear() {}
+        virtual dsp* clone() { return new test_dsp(fLevel); }
+        virtual void metadata(Meta* m) {}
+
+        virtual void compute(int count, FAUSTFLOAT** inputs, FAUSTFLOAT** outputs)
+        {
+            for (int i = 0; i < count; i++) {
+                outputs[0][i] = outputs[1][i] = fLevel * fGain;
+            }
+            fMeter = fLevel;
+        }
+};
+
+struct audio_state {
+    swap_dsp* fDSP;
+    int fBlockSize;
+    int fFade;
+    long fBlocks;
+    FAUSTFLOAT fMaxStep;
+    double fTime;
+};
+
+static volatile bool gRunning = true;
+
+static void* audioThread(void* arg)
+{
+    audio_state* state = (audio_state*)arg;
+    std::vector<FAUSTFLOAT> buffer(state->fBlockSize * 2, 0);
+    FAUSTFLOAT* channels[2] = { &buffer[0], &buffer[state->fBlockSize] };
+    FAUSTFLOAT last = 0;
+    bool first = true;
+    while (gRunning) {
+        // In-place computation, as some audio drivers do
+        double t0 = now();
+        state->fDSP->compute(state->fBlockSize, channels, channels);
+        state->fTime += now() - t0;
+        for (int i = 0; i < state->fBlockSize; i++) {
+            if (!first) state->fMaxStep = std::max(state->fMaxStep, FAUSTFLOAT(fabs(channels[0][i] - last)));
+            last = channels[0][i];
+            first = false;
+        }
+        state->fBlocks++;
+    }
+    return 0;
+}
+
+int main(int argc, char* argv[])
+{
+    audio_state state;
+    state.fBlockSize = 256;
+    state.fFade = 1024;
+    state.fBlocks = 0;
+    state.fMaxStep = 0;
+    state.fTime = 0;
+    double duration = 1;
+
+    for (int i = 1; i < argc - 1; i++) {
+        if (strcmp(argv[i], "--block") == 0) state.fBlockSize = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--fade") == 0) state.fFade = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--duration") == 0) duration = atof(argv[++i]);
+    }
+
+    // Each new DSP outputs 0 or 0.5 : without crossfade a swap would step by 0.5
+    int swaps = 0;
+    {
+        swap_dsp dsp(new test_dsp(0), state.fFade);
+        dsp.init(44100);
+        MapUI ui;
+        dsp.buildUserInterface(&ui);
+        state.fDSP = &dsp;
+
+        pthread_t thread;
+        pthread_create(&thread, 0, audioThread, &state);
+        ui.setParamValue("/test/gain", FAUSTFLOAT(0.5));
+        double end = now() + duration * 1e6;
+        while (now() < end) {
+            if (dsp.swap(new test_dsp(FAUSTFLOAT(++swaps % 2)))) {
+                usleep(200);
+            }
+        }
+        gRunning = false;
+        pthread_join(thread, 0);
+    }
+
+    // Without crossfade the largest step is 0.5, with a linear one it is about 0.5 / fade
+    printf("%d swaps, %ld blocks of %d samples, fade of %d samples\n", swaps, state.fBlocks, state.fBlockSize, state.fFade);
+    printf("compute : %.2f usec per block\n", state.fTime / state.fBlocks);
+    printf("largest step between samples : %g\n", state.fMaxStep);
+    return 0;
+}
@@ -0,0 +1,153 @@
+/*
+ * Check of the binary DSP descriptor (BinaryUIDecoder) : a proxy_dsp attached
+ * to the binary descriptor of a DSP must give the same user interface and
+ * the global metadata of a proxy_dsp attached to its JSON description. The files are
+ * the ones produced by 'faust -json -fdesc foo.dsp', or without files a
+ * synthetic interface using all the widgets is given to both builders.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <set>
+#include <algorithm>
+
+using namespace std;
+
+#include "faust/dsp/proxy-dsp.h"
+
+// Records the calls made by 'buildUserInterface' to compare both decoders
+class RecordUI : public UI, public Meta
+{
+    public:
+
+        stringstream fOut;
+
+        void openTabBox(const char* label) { fOut << "tgroup " << label << "\n"; }
+        void openHorizontalBox(const char* label) { fOut << "hgroup " << label << "\n"; }
+        void openVerticalBox(const char* label) { fOut << "vgroup " << label << "\n"; }
+        void closeBox() { fOut << "close\n"; }
+
+        void addButton(const char* label, FAUSTFLOAT* zone) { fOut << "button " << label << "\n"; }
+        void addCheckButton(const char* label, FAUSTFLOAT* zone) { fOut << "checkbox " << label << "\n"; }
+        void addVerticalSlider(const char* label, FAUSTFLOAT* zone, FAUSTFLOAT init, FAUSTFLOAT min, FAUSTFLOAT max, FAUSTFLOAT step)
+        {
+            fOut << "vslider " << label << " " << *zone << " " << init << " " << min << " " << max << " " << step << "\n";
+        }
+        void addHorizontalSlider(const char* label, FAUSTFLOAT* zone, FAUSTFLOAT init, FAUSTFLOAT min, FAUSTFLOAT max, FAUSTFLOAT step)
+        {
+            fOut << "hslider " << label << " " << *zone << " " << init << " " << min << " " << max << " " << step << "\n";
+        }
+        void addNumEntry(const char* label, FAUSTFLOAT* zone, FAUSTFLOAT init, FAUSTFLOAT min, FAUSTFLOAT max, FAUSTFLOAT step)
+        {
+            fOut << "nentry " << label << " " << *zone << " " << init << " " << min << " " << max << " " << step << "\n";
+        }
+        void addHorizontalBargraph(const char* label, FAUSTFLOAT* zone, FAUSTFLOAT min, FAUSTFLOAT max)
+        {
+            fOut << "hbargraph " << label << " " << min << " " << max << "\n";
+        }
+        void addVerticalBargraph(const char* label, FAUSTFLOAT* zone, FAUSTFLOAT min, FAUSTFLOAT max)
+        {
+            fOut << "vbargraph " << label << " " << min << " " << max << "\n";
+        }
+
+        void declare(FAUSTFLOAT* zone, const char* key, const char* val) { fOut << "declare " << key << " " << val << "\n"; }
+
+        // the JSON decoder gives the global metadata sorted by key, without 'name'
+        set<pair<string, string> > fMeta;
+        void declare(const char* key, const char* value) { fMeta.insert(make_pair(string(key), string(value))); }
+};
+
+// the same interface is given to the JSON and to the binary builders
+template <typename BUILDER>
+static void buildSyntheticUI(BUILDER& builder, int controls)
+{
+    builder.declare("name", "synthetic");
+    builder.declare("author", "GRAME");
+    builder.openVerticalBox("synthetic");
+    for (int i = 0; i < controls; i++) {
+        char label[64];
+        if (i % 16 == 0) {
+            if (i > 0) builder.closeBox();
+            snprintf(label, 64, "group%d", i / 16);
+            builder.openHorizontalBox(label);
+        }
+        snprintf(label, 64, "control%d", i);
+        builder.declare(0, "style", "knob");
+        builder.declare(0, "unit", "Hz");
+        switch (i % 8) {
+            case 0: builder.addButton(label, 0); break;
+            case 1: builder.addCheckButton(label, 0); break;
+            case 2: builder.addNumEntry(label, 0, i % 100, 0, 1000, 0.5); break;
+            case 3: builder.addHorizontalBargraph(label, 0, -1, 1); break;
+            default: builder.addHorizontalSlider(label, 0, i % 100, 0, 1000, 0.5); break;
+        }
+    }
+    builder.closeBox();
+    builder.closeBox();
+}
+
+static void buildSynthetic(int controls, string& json, string& binary)
+{
+    JSONUI json_builder("synthetic", 2, 2);
+    buildSyntheticUI(json_builder, controls);
+    json = json_builder.JSON();
+    BinaryUI binary_builder("synthetic", 2, 2, "");
+    buildSyntheticUI(binary_builder, controls);
+    binary = binary_builder.binary();
+}
+
+static bool readFile(const char* name, string& res)
+{
+    ifstream in(name, ios::binary);
+    if (!in) return false;
+    stringstream buffer;
+    buffer << in.rdbuf();
+    res = buffer.str();
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    string json, binary;
+
+    if (argc == 3) {
+        if (!readFile(argv[1], json) || !readFile(argv[2], binary)) {
+            fprintf(stderr, "ERROR : cannot read '%s' or '%s'\n", argv[1], argv[2]);
+            return 1;
+        }
+    } else {
+        buildSynthetic(256, json, binary);
+    }
+
+    // The binary descriptor must be 8 bytes aligned, as when it is mmap'ed
+    vector<uint64_t> aligned((binary.size() + 7) / 8 + 1);
+    memcpy(&aligned[0], binary.data(), binary.size());
+    const char* descriptor = (const char*)&aligned[0];
+
+    if (!BinaryUIDecoder::isValid(descriptor, binary.size())) {
+        fprintf(stderr, "ERROR : invalid binary descriptor\n");
+        return 1;
+    }
+
+    RecordUI json_ui, binary_ui;
+    proxy_dsp json_proxy(json);
+    proxy_dsp binary_proxy(descriptor, binary.size());
+    json_proxy.metadata(&json_ui);
+    json_proxy.buildUserInterface(&json_ui);
+    binary_proxy.metadata(&binary_ui);
+    binary_proxy.buildUserInterface(&binary_ui);
+
+    if (json_ui.fOut.str() != binary_ui.fOut.str()
+        || !includes(binary_ui.fMeta.begin(), binary_ui.fMeta.end(), json_ui.fMeta.begin(), json_ui.fMeta.end())
+        || json_proxy.getNumInputs() != binary_proxy.getNumInputs()
+        || json_proxy.getNumOutputs() != binary_proxy.getNumOutputs()) {
+        fprintf(stderr, "ERROR : the JSON and binary descriptors give different DSPs\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,113 @@
+/*
+    Check of the libfaust subprocess wrapper (faust/dsp/libfaust.h) : the
+    programs given on the command line are compiled concurrently from several
+    threads, each one must give a class named after 'fClassName' and its JSON
+    description. An incorrect program, or a compiler which can't be run, must
+    return an error instead of ending the host.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+
+#include "faust/dsp/libfaust.h"
+
+#define kThreads    4
+
+static std::string readFile(const char* filename)
+{
+    std::ifstream file(filename);
+    std::stringstream content;
+    content << file.rdbuf();
+    return content.str();
+}
+
+struct Job {
+    std::string fName;
+    std::string fSource;
+    faust_options fOptions;
+    faust_result fResult;
+    bool fSuccess;
+};
+
+static std::vector<Job> gJobs;
+static int gNext = 0;
+static pthread_mutex_t gLock = PTHREAD_MUTEX_INITIALIZER;
+
+// Thread pool worker : compiles the jobs until there are none left
+static void* worker(void* arg)
+{
+    while (true) {
+        pthread_mutex_lock(&gLock);
+        int job = gNext++;
+        pthread_mutex_unlock(&gLock);
+        if (job >= int(gJobs.size())) return 0;
+        gJobs[job].fSuccess = compileFaustDSP(gJobs[job].fName, gJobs[job].fSource, gJobs[job].fOptions, gJobs[job].fResult);
+    }
+}
+
+static bool checkError(const char* what, const faust_options& options, const std::string& message)
+{
+    faust_result result;
+    if (compileFaustDSP("error", "process = undefined;", options, result)) {
+        fprintf(stderr, "ERROR %s : the compilation succeeded\n", what);
+        return false;
+    }
+    if (result.fMessages.find(message) == std::string::npos) {
+        fprintf(stderr, "ERROR %s : the messages are '%s'\n", what, result.fMessages.c_str());
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    const char* compiler = "faust";
+    int first = 1;
+    if (argc > 2 && strcmp(argv[1], "--faust") == 0) {
+        compiler = argv[2];
+        first = 3;
+    }
+
+    for (int i = first; i < argc; i++) {
+        Job job;
+        job.fName = argv[i];
+        job.fSource = readFile(argv[i]);
+        // the source is compiled in a temporary directory : its own directory is searched for its imports
+        const char* slash = strrchr(argv[i], '/');
+        job.fOptions.fImportDirs.push_back((slash) ? std::string(argv[i], slash - argv[i]) : ".");
+        job.fOptions.fClassName = "checkdsp";
+        job.fOptions.fJSON = true;
+        job.fOptions.fCompiler = compiler;
+        gJobs.push_back(job);
+    }
+
+    pthread_t pool[kThreads];
+    for (int i = 0; i < kThreads; i++) pthread_create(&pool[i], 0, worker, 0);
+    for (int i = 0; i < kThreads; i++) pthread_join(pool[i], 0);
+
+    bool res = true;
+    for (size_t i = 0; i < gJobs.size(); i++) {
+        const Job& job = gJobs[i];
+        if (!job.fSuccess) {
+            fprintf(stderr, "ERROR %s : %s", job.fName.c_str(), job.fResult.fMessages.c_str());
+            res = false;
+        } else if (job.fResult.fCode.find("class checkdsp ") == std::string::npos || job.fResult.fJSON.find("\"ui\"") == std::string::npos) {
+            fprintf(stderr, "ERROR %s : missing class or JSON description\n", job.fName.c_str());
+            res = false;
+        }
+    }
+
+    faust_options options;
+    options.fCompiler = compiler;
+    res &= checkError("incorrect program", options, "undefined");
+    options.fCompiler = "faust-missing-compiler";
+    res &= checkError("missing compiler", options, "can't run the Faust compiler");
+    return (res) ? 0 : 1;
+}
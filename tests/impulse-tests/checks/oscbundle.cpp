@@ -0,0 +1,160 @@
+/*
+    Check of the OSCUI values transmission (-xmit 1) on a loopback UDP socket :
+    with one packet per value and with OSC bundles (-bundle 1), each change of
+    each bargraph must be received, and the last value received for each
+    address must be the value of its zone.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "faust/gui/OSCUI.h"
+
+std::list<GUI*> GUI::fGuiList;
+ztimedmap GUI::gTimedZoneMap;
+
+#define kZones      64
+#define kUpdates    20
+
+static int openReceiver(int port)
+{
+    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int size = 8 * 1024 * 1024;
+    setsockopt(sock, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (bind(sock, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        perror("bind");
+        exit(1);
+    }
+    fcntl(sock, F_SETFL, O_NONBLOCK);
+    return sock;
+}
+
+struct receiver {
+    std::map<std::string, float> fValues;   // last value received for each address
+    int fMessages, fBundles;
+    receiver() : fMessages(0), fBundles(0) {}
+
+    // size of an OSC string, with its padding
+    static int stringSize(const char* data, int size)
+    {
+        int len = int(strnlen(data, size));
+        return (len / 4 + 1) * 4;
+    }
+
+    void message(const char* data, int size)
+    {
+        int pos = stringSize(data, size);
+        if (pos + 8 > size || strcmp(data + pos, ",f") != 0) return;
+        pos += stringSize(data + pos, size - pos);
+        unsigned int bits = ntohl(*(const unsigned int*)(data + pos));
+        float value;
+        memcpy(&value, &bits, sizeof(value));
+        fValues[data] = value;
+        fMessages++;
+    }
+
+    void packet(const char* data, int size)
+    {
+        if (size >= 16 && strcmp(data, "#bundle") == 0) {
+            fBundles++;
+            for (int pos = 16; pos + 4 <= size; ) {
+                int len = ntohl(*(const unsigned int*)(data + pos));
+                packet(data + pos + 4, len);
+                pos += 4 + len;
+            }
+        } else {
+            message(data, size);
+        }
+    }
+
+    void drain(int sock)
+    {
+        char buffer[65536];
+        int size;
+        while ((size = recv(sock, buffer, sizeof(buffer), 0)) > 0) {
+            packet(buffer, size);
+        }
+    }
+};
+
+static bool check(const char* bundle, int port)
+{
+    char outport[16];
+    snprintf(outport, sizeof(outport), "%d", port);
+    const char* argv[] = { "oscbundle", "-xmit", "1", "-desthost", "127.0.0.1", "-outport", outport, "-port", "5610", "-bundle", bundle };
+    int sock = openReceiver(port);
+
+    std::vector<FAUSTFLOAT> values(kZones, 0);
+    OSCUI* ui = new OSCUI("oscbundle", sizeof(argv) / sizeof(char*), (char**)argv);
+    ui->openVerticalBox("oscbundle");
+    for (int i = 0; i < kZones; i++) {
+        char label[64];
+        snprintf(label, sizeof(label), "meter%d", i);
+        ui->addHorizontalBargraph(label, &values[i], FAUSTFLOAT(0), FAUSTFLOAT(1));
+    }
+    ui->closeBox();
+    ui->run();
+    usleep(100000);
+
+    receiver rec;
+    rec.drain(sock);
+    rec = receiver();
+
+    for (int u = 0; u < kUpdates; u++) {
+        for (int i = 0; i < kZones; i++) {
+            values[i] = FAUSTFLOAT(0.5 + 0.5 * sin(0.1 * u + i));
+        }
+        GUI::updateAllGuis();
+        usleep(10000);
+        rec.drain(sock);
+    }
+    usleep(100000);
+    rec.drain(sock);
+
+    bool res = true;
+    if (rec.fMessages != kZones * kUpdates) {
+        fprintf(stderr, "ERROR -bundle %s : %d messages received instead of %d\n", bundle, rec.fMessages, kZones * kUpdates);
+        res = false;
+    }
+    if ((strcmp(bundle, "1") == 0) != (rec.fBundles > 0)) {
+        fprintf(stderr, "ERROR -bundle %s : %d bundles received\n", bundle, rec.fBundles);
+        res = false;
+    }
+    for (int i = 0; i < kZones; i++) {
+        char address[64];
+        snprintf(address, sizeof(address), "/oscbundle/meter%d", i);
+        if (rec.fValues.count(address) == 0 || rec.fValues[address] != float(values[i])) {
+            fprintf(stderr, "ERROR -bundle %s : wrong last value for %s\n", bundle, address);
+            res = false;
+            break;
+        }
+    }
+
+    ui->stop();
+    delete ui;
+    close(sock);
+    return res;
+}
+
+int main(int argc, char* argv[])
+{
+    bool res = true;
+    res &= check("0", 5600);
+    res &= check("1", 5601);
+    return (res) ? 0 : 1;
+}
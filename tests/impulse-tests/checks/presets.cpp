@@ -0,0 +1,149 @@
+/*
+ * Check of the preset bank of PresetUI used through preset_dsp : presets
+ * recalled from another thread are applied atomically at the start of a
+ * block, morphing gives the normalized mix of the presets, and a ramp reaches
+ * the mix after the given number of blocks.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <pthread.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include "faust/dsp/preset-dsp.h"
+
+#define kControls   1024
+#define kPresets    8
+
+static double now()
+{
+    struct timeval tv;
+    gettimeofday(&tv, 0);
+    return tv.tv_sec * 1e6 + tv.tv_usec;
+}
+
+// A DSP with 'controls' sliders which checks, at each block, that they all come from the same preset
+class test_dsp : public dsp {
+
+    public:
+
+        std::vector<FAUSTFLOAT> fZones;
+        long fBlocks;
+        long fMixed;
+
+        test_dsp(int controls):fZones(controls, 0), fBlocks(0), fMixed(0) {}
+
+        virtual int getNumInputs() { return 0; }
+        virtual int getNumOutputs() { return 0; }
+        virtual void buildUserInterface(UI* ui)
+        {
+            ui->openVerticalBox("test");
+            for (size_t i = 0; i < fZones.size(); i++) {
+                char label[64];
+                snprintf(label, 64, "control%d", int(i));
+                ui->addHorizontalSlider(label, &fZones[i], 0, 0, 1e6, 1);
+            }
+            ui->closeBox();
+        }
+        virtual int getSampleRate() { return 44100; }
+        virtual void init(int samplingRate) {}
+        virtual void instanceInit(int samplingRate) {}
+        virtual void instanceConstants(int samplingRate) {}
+        virtual void instanceResetUserInterface() {}
+        virtual void instanceClear() {}
+        virtual dsp* clone() { return new test_dsp(int(fZones.size())); }
+        virtual void metadata(Meta* m) {}
+
+        // Preset 'p' sets control 'i' to p * 1000 + i
+        virtual void compute(int count, FAUSTFLOAT** inputs, FAUSTFLOAT** outputs)
+        {
+            int preset = int(fZones[0]) / 1000;
+            for (size_t i = 0; i < fZones.size(); i++) {
+                if (fZones[i] != FAUSTFLOAT(preset * 1000 + int(i))) {
+                    fMixed++;
+                    break;
+                }
+            }
+            fBlocks++;
+        }
+};
+
+static volatile bool gRunning = true;
+
+static void* audioThread(void* arg)
+{
+    preset_dsp* dsp = (preset_dsp*)arg;
+    while (gRunning) {
+        dsp->compute(0, 0, 0);
+    }
+    return 0;
+}
+
+// Checks that all the controls have the value 'expected(i)'
+static bool checkValues(test_dsp* test, const char* what, FAUSTFLOAT mix)
+{
+    for (int i = 0; i < kControls; i++) {
+        FAUSTFLOAT expected = mix * 1000 + i;
+        if (fabs(test->fZones[i] - expected) > 1e-3 * fabs(expected)) {
+            fprintf(stderr, "ERROR %s : control %d is %f instead of %f\n", what, i, float(test->fZones[i]), float(expected));
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    test_dsp* test = new test_dsp(kControls);
+    preset_dsp dsp(test);
+    PresetUI* ui = dsp.getPresets();
+    bool res = true;
+
+    for (int p = 0; p < kPresets; p++) {
+        for (int i = 0; i < kControls; i++) {
+            test->fZones[i] = FAUSTFLOAT(p * 1000 + i);
+        }
+        ui->storePreset();
+    }
+
+    // Recall presets from this thread while the audio thread runs
+    pthread_t thread;
+    pthread_create(&thread, 0, audioThread, &dsp);
+    int recalls = 0;
+    double end = now() + 2e5;
+    while (now() < end) {
+        ui->recallPreset(recalls++ % kPresets);
+        usleep(100);
+    }
+    gRunning = false;
+    pthread_join(thread, 0);
+    if (test->fMixed > 0) {
+        fprintf(stderr, "ERROR recall : %ld blocks with a partially applied preset\n", test->fMixed);
+        res = false;
+    }
+
+    // Recall, then morph presets 2 and 6 with the same weight : the mix is preset 4
+    ui->setMorphBlocks(0);
+    ui->recallPreset(1);
+    dsp.compute(0, 0, 0);
+    res &= checkValues(test, "recall", 1);
+    std::vector<FAUSTFLOAT> weights(kPresets, 0);
+    weights[2] = weights[6] = 3;
+    ui->morph(weights);
+    dsp.compute(0, 0, 0);
+    res &= checkValues(test, "morph", 4);
+
+    // Ramp from preset 4 to preset 0 over 10 blocks (a recall is immediate) : preset 2 after 5 blocks
+    ui->setMorphBlocks(10);
+    weights.assign(kPresets, 0);
+    weights[0] = 1;
+    ui->morph(weights);
+    for (int b = 0; b < 5; b++) dsp.compute(0, 0, 0);
+    res &= checkValues(test, "ramp", 2);
+    for (int b = 0; b < 5; b++) dsp.compute(0, 0, 0);
+    res &= checkValues(test, "ramp end", 0);
+
+    return (res) ? 0 : 1;
+}
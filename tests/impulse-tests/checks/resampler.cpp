@@ -0,0 +1,124 @@
+/*
+    Check of 'dsp_resampler' (faust/dsp/dsp-resampler.h) : for several up / down
+    ratios, a pass-through DSP run at the internal rate must give the input
+    signal delayed by the latency returned by 'getLatency', with a small error,
+    and blocks of random sizes must give the same output as fixed size blocks.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <vector>
+
+#include "faust/gui/UI.h"
+#include "faust/gui/meta.h"
+#include "faust/dsp/dsp-resampler.h"
+
+#define BLOCK 512
+#define PI 3.14159265358979323846
+
+// Copies its input
+class test_dsp : public dsp {
+
+    public:
+
+        int fSampleRate;
+
+        test_dsp():fSampleRate(0) {}
+
+        virtual int getNumInputs() { return 1; }
+        virtual int getNumOutputs() { return 1; }
+        virtual void buildUserInterface(UI* ui) {}
+        virtual int getSampleRate() { return fSampleRate; }
+        virtual void init(int samplingRate) { fSampleRate = samplingRate; }
+        virtual void instanceInit(int samplingRate) { fSampleRate = samplingRate; }
+        virtual void instanceConstants(int samplingRate) { fSampleRate = samplingRate; }
+        virtual void instanceResetUserInterface() {}
+        virtual void instanceClear() {}
+        virtual dsp* clone() { return new test_dsp(); }
+        virtual void metadata(Meta* m) {}
+
+        virtual void compute(int count, FAUSTFLOAT** inputs, FAUSTFLOAT** outputs)
+        {
+            memcpy(outputs[0], inputs[0], count * sizeof(FAUSTFLOAT));
+        }
+};
+
+// Runs 'dsp' on 'input' with blocks of random sizes (or of BLOCK samples if 'fixed')
+static std::vector<FAUSTFLOAT> run(dsp* dsp, const std::vector<FAUSTFLOAT>& input, bool fixed)
+{
+    std::vector<FAUSTFLOAT> output(input.size());
+    srand(1);
+    for (size_t pos = 0; pos < input.size(); ) {
+        int count = std::min(int(input.size() - pos), fixed ? BLOCK : 1 + rand() % BLOCK);
+        FAUSTFLOAT* in = const_cast<FAUSTFLOAT*>(&input[pos]);
+        FAUSTFLOAT* out = &output[pos];
+        dsp->compute(count, &in, &out);
+        pos += count;
+    }
+    return output;
+}
+
+static bool testRatio(int up, int down)
+{
+    int size = 44100;
+    std::vector<FAUSTFLOAT> input(size);
+    for (int i = 0; i < size; i++) {
+        // Not periodic within the lags searched below, and below the lowest cutoff
+        double t = 2 * PI * i / 44100.;
+        input[i] = FAUSTFLOAT(0.2 * (sin(313 * t) + sin(1009 * t) + sin(2503 * t) + sin(4001 * t)));
+    }
+
+    dsp_resampler dsp1(new test_dsp(), up, down, BLOCK);
+    dsp_resampler dsp2(new test_dsp(), up, down, BLOCK);
+    dsp1.init(44100);
+    dsp2.init(44100);
+    std::vector<FAUSTFLOAT> out1 = run(&dsp1, input, true);
+    std::vector<FAUSTFLOAT> out2 = run(&dsp2, input, false);
+    bool same = (out1 == out2);
+
+    // Best lag between input and output, and error at this lag once the filters have settled
+    int latency = dsp1.getLatency();
+    int best_lag = 0;
+    double best_error = 1e9;
+    for (int lag = 0; lag < 4 * latency + 8; lag++) {
+        double error = 0;
+        for (int i = 4096; i < size; i++) {
+            double e = out1[i] - input[i - lag];
+            error += e * e;
+        }
+        error = sqrt(error / (size - 4096)) / (0.4 / sqrt(2.));
+        if (error < best_error) {
+            best_error = error;
+            best_lag = lag;
+        }
+    }
+
+    bool ok = true;
+    if (abs(best_lag - latency) > 1) {
+        fprintf(stderr, "ERROR %d / %d : latency %d, measured %d\n", up, down, latency, best_lag);
+        ok = false;
+    }
+    if (best_error >= 0.05) {
+        fprintf(stderr, "ERROR %d / %d : error of %.1f dB\n", up, down, 20 * log10(best_error));
+        ok = false;
+    }
+    if (!same) {
+        fprintf(stderr, "ERROR %d / %d : blocks of random sizes give another output\n", up, down);
+        ok = false;
+    }
+    return ok;
+}
+
+int main(int argc, char* argv[])
+{
+    bool res = true;
+    res &= testRatio(2, 1);
+    res &= testRatio(4, 1);
+    res &= testRatio(1, 2);
+    res &= testRatio(160, 147);
+    res &= testRatio(147, 160);
+    return (res) ? 0 : 1;
+}
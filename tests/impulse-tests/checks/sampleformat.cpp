@@ -0,0 +1,86 @@
+/*
+    Check of the sample format conversions of 'faust/audio/sample-format.h' :
+    reading and writing interleaved card buffers must give the same samples as
+    the scalar per-sample loops previously used in the audio drivers, for any
+    number of channels and frames (SIMD loops and their scalar tails).
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <vector>
+
+#include "faust/audio/sample-format.h"
+
+// Previous driver code : interleaved loops, one sample at a time
+template <class FORMAT>
+static void scalarRead(const typename FORMAT::type* src, int channels, int frames, float** dst)
+{
+    for (int f = 0; f < frames; f++) {
+        for (int c = 0; c < channels; c++) {
+            dst[c][f] = FORMAT::toFloat(src[c + f * channels]);
+        }
+    }
+}
+
+template <class FORMAT>
+static void scalarWrite(float** src, int channels, int frames, typename FORMAT::type* dst)
+{
+    for (int f = 0; f < frames; f++) {
+        for (int c = 0; c < channels; c++) {
+            dst[c + f * channels] = FORMAT::fromFloat(src[c][f]);
+        }
+    }
+}
+
+template <class FORMAT>
+static bool check(const char* name, sample_format format, int channels, int frames)
+{
+    typedef typename FORMAT::type type;
+    int size = sampleFormatSize(format);
+
+    std::vector<float> soft1(channels * frames), soft2(channels * frames);
+    std::vector<float*> chans1(channels), chans2(channels);
+    std::vector<char> card1(channels * frames * size), card2(channels * frames * size);
+
+    for (int c = 0; c < channels; c++) {
+        chans1[c] = &soft1[c * frames];
+        chans2[c] = &soft2[c * frames];
+        // signal going over [-1..1] to test clipping
+        for (int f = 0; f < frames; f++) {
+            chans1[c][f] = 1.2f * sinf(float(f * (c + 1)) * 0.01f);
+        }
+    }
+
+    writeSamples(format, &chans1[0], channels, frames, &card1[0]);
+    scalarWrite<FORMAT>(&chans1[0], channels, frames, (type*)&card2[0]);
+    if (memcmp(&card1[0], &card2[0], card1.size()) != 0) {
+        fprintf(stderr, "ERROR %s, %d channels, %d frames : write differs from the scalar version\n", name, channels, frames);
+        return false;
+    }
+    readSamples(format, &card1[0], channels, frames, &chans1[0]);
+    scalarRead<FORMAT>((const type*)&card1[0], channels, frames, &chans2[0]);
+    if (memcmp(&soft1[0], &soft2[0], soft1.size() * sizeof(float)) != 0) {
+        fprintf(stderr, "ERROR %s, %d channels, %d frames : read differs from the scalar version\n", name, channels, frames);
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    static const int channels[] = { 1, 2, 3, 8, 64 };
+    static const int frames[] = { 1, 7, 64, 509 };
+
+    bool res = true;
+    for (int c = 0; c < 5; c++) {
+        for (int f = 0; f < 4; f++) {
+            res &= check<sample_f32>("float", kSampleFloat32, channels[c], frames[f]);
+            res &= check<sample_s16>("S16", kSampleS16, channels[c], frames[f]);
+            res &= check<sample_s24>("S24", kSampleS24, channels[c], frames[f]);
+            res &= check<sample_s24_packed>("S24 packed", kSampleS24Packed, channels[c], frames[f]);
+            res &= check<sample_s32>("S32", kSampleS32, channels[c], frames[f]);
+        }
+    }
+    return (res) ? 0 : 1;
+}
@@ -0,0 +1,205 @@
+/*
+    Check of 'swap_dsp' (faust/dsp/swap-dsp.h) : a DSP replaced with 'swap' is
+    crossfaded with the running one, it gets the control values set on the
+    'swap_dsp' user interface, and the replaced instances are all deleted.
+    The swaps are done first between blocks, then while an audio thread
+    computes the DSP in place.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include "faust/dsp/swap-dsp.h"
+
+#define kBlock  256
+#define kFade   1024
+
+static double now()
+{
+    struct timeval tv;
+    gettimeofday(&tv, 0);
+    return tv.tv_sec * 1e6 + tv.tv_usec;
+}
+
+static volatile int gInstances = 0;
+
+// DSP outputting 'level' * 'gain' on its 2 or 'outputs' channels, with a 'gain' slider and a 'level' bargraph
+class test_dsp : public dsp {
+
+    public:
+
+        FAUSTFLOAT fLevel;
+        FAUSTFLOAT fGain;
+        FAUSTFLOAT fMeter;
+        int fOutputs;
+
+        test_dsp(FAUSTFLOAT level, int outputs = 2):fLevel(level), fGain(1), fMeter(0), fOutputs(outputs) { __sync_fetch_and_add(&gInstances, 1); }
+        virtual ~test_dsp() { __sync_fetch_and_sub(&gInstances, 1); }
+
+        virtual int getNumInputs() { return 2; }
+        virtual int getNumOutputs() { return fOutputs; }
+        virtual void buildUserInterface(UI* ui)
+        {
+            ui->openVerticalBox("test");
+            ui->addHorizontalSlider("gain", &fGain, 1, 0, 1, 0.01);
+            ui->addHorizontalBargraph("level", &fMeter, 0, 1);
+            ui->closeBox();
+        }
+        virtual int getSampleRate() { return 44100; }
+        virtual void init(int samplingRate) {}
+        virtual void instanceInit(int samplingRate) {}
+        virtual void instanceConstants(int samplingRate) {}
+        virtual void instanceResetUserInterface() { fGain = 1; }
+        virtual void instanceClear() {}
+        virtual dsp* clone() { return new test_dsp(fLevel, fOutputs); }
+        virtual void metadata(Meta* m) {}
+
+        virtual void compute(int count, FAUSTFLOAT** inputs, FAUSTFLOAT** outputs)
+        {
+            for (int chan = 0; chan < fOutputs; chan++) {
+                for (int i = 0; i < count; i++) {
+                    outputs[chan][i] = fLevel * fGain;
+                }
+            }
+            fMeter = fLevel;
+        }
+};
+
+struct audio_state {
+    swap_dsp* fDSP;
+    std::vector<FAUSTFLOAT> fBuffer;
+    FAUSTFLOAT* fChannels[2];
+    FAUSTFLOAT fLast;
+    FAUSTFLOAT fMaxStep;
+    bool fFirst;
+
+    audio_state(swap_dsp* dsp):fDSP(dsp), fBuffer(kBlock * 2, 0), fLast(0), fMaxStep(0), fFirst(true)
+    {
+        fChannels[0] = &fBuffer[0];
+        fChannels[1] = &fBuffer[kBlock];
+    }
+
+    // In-place computation, as some audio drivers do
+    void compute()
+    {
+        fDSP->compute(kBlock, fChannels, fChannels);
+        for (int i = 0; i < kBlock; i++) {
+            if (!fFirst) fMaxStep = std::max(fMaxStep, FAUSTFLOAT(fabs(fChannels[0][i] - fLast)));
+            fLast = fChannels[0][i];
+            fFirst = false;
+        }
+    }
+};
+
+static volatile bool gRunning = true;
+
+static void* audioThread(void* arg)
+{
+    audio_state* state = (audio_state*)arg;
+    while (gRunning) {
+        state->compute();
+    }
+    return 0;
+}
+
+// Without crossfade a swap between levels 0 and 1 steps by 'gain', with the linear one by 'gain' / kFade
+static bool checkSmooth(const char* what, const audio_state& state, FAUSTFLOAT gain)
+{
+    if (state.fMaxStep > gain * 1.001f / kFade) {
+        fprintf(stderr, "ERROR %s : step of %g between two samples\n", what, state.fMaxStep);
+        return false;
+    }
+    return true;
+}
+
+static bool checkBlocks()
+{
+    bool res = true;
+    swap_dsp dsp(new test_dsp(0), kFade);
+    dsp.init(44100);
+    MapUI ui;
+    dsp.buildUserInterface(&ui);
+    ui.setParamValue("/test/gain", FAUSTFLOAT(0.5));
+    audio_state state(&dsp);
+    state.compute();
+
+    test_dsp* wrong = new test_dsp(1, 1);
+    if (dsp.swap(wrong)) {
+        fprintf(stderr, "ERROR swap of a DSP with other outputs\n");
+        res = false;
+    } else {
+        delete wrong;
+    }
+
+    for (int swaps = 1; swaps <= 4; swaps++) {
+        FAUSTFLOAT level = FAUSTFLOAT(swaps % 2);
+        dsp.swap(new test_dsp(level));
+        int blocks = 0;
+        do {
+            state.compute();
+        } while (dsp.isSwapping() && ++blocks < 100);
+        if (dsp.isSwapping() || blocks * kBlock < kFade - kBlock) {
+            fprintf(stderr, "ERROR swap %d done after %d blocks\n", swaps, blocks);
+            res = false;
+        }
+        state.compute();
+        if (state.fLast != level * FAUSTFLOAT(0.5) || ui.getParamValue("/test/level") != level) {
+            fprintf(stderr, "ERROR swap %d : output %g, level bargraph %g\n", swaps, state.fLast, ui.getParamValue("/test/level"));
+            res = false;
+        }
+    }
+    return res && checkSmooth("swaps between blocks", state, FAUSTFLOAT(0.5));
+}
+
+static bool checkThreads(double duration)
+{
+    bool res = true;
+    int swaps = 0;
+    swap_dsp* dsp = new swap_dsp(new test_dsp(0), kFade);
+    dsp->init(44100);
+    MapUI ui;
+    dsp->buildUserInterface(&ui);
+    audio_state state(dsp);
+
+    pthread_t thread;
+    pthread_create(&thread, 0, audioThread, &state);
+    // The gain set on the stable zones must be used by all new instances
+    ui.setParamValue("/test/gain", FAUSTFLOAT(0.5));
+    double end = now() + duration * 1e6;
+    while (now() < end) {
+        if (dsp->swap(new test_dsp(FAUSTFLOAT(++swaps % 2)))) {
+            usleep(200);
+        }
+    }
+    gRunning = false;
+    pthread_join(thread, 0);
+
+    if (ui.getParamValue("/test/gain") != FAUSTFLOAT(0.5)) {
+        fprintf(stderr, "ERROR gain changed to %g\n", ui.getParamValue("/test/gain"));
+        res = false;
+    }
+    FAUSTFLOAT level = ui.getParamValue("/test/level");
+    if (level != 0 && level != 1) {
+        fprintf(stderr, "ERROR level bargraph %g\n", level);
+        res = false;
+    }
+    delete dsp;
+    return res && checkSmooth("swaps while computing", state, FAUSTFLOAT(0.5));
+}
+
+int main(int argc, char* argv[])
+{
+    bool res = true;
+    res &= checkBlocks();
+    res &= checkThreads(0.2);
+    if (gInstances != 0) {
+        fprintf(stderr, "ERROR %d instances left\n", gInstances);
+        res = false;
+    }
+    return (res) ? 0 : 1;
+}
@@ -0,0 +1,5 @@
+declare name "fir";
+
+// A long FIR filter with constant coefficients, computed by FFT convolution.
+
+process = _ <: sum(i, 300, @(i) * (i%7 + 1) * (1 - 2*(i%2)) * 0.001);
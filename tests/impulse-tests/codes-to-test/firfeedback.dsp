@@ -0,0 +1,6 @@
+declare name "firfeedback";
+
+// A long FIR filter inside a recursion : it must stay direct, as its input
+// (the recursive signal) is only known after its output.
+
+process = + ~ (_ <: sum(i, 300, @(i) * 0.001));
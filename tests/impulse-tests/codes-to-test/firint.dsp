@@ -0,0 +1,6 @@
+declare name "firint";
+
+// A long FIR filter of an integer signal : it must stay direct, as the
+// convolver computes in floating point.
+
+process = (_ > 0) <: sum(i, 300, @(i) * (i%3 + 1));
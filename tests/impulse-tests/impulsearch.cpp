@@ -22,6 +22,12 @@
 #include "faust/gui/FUI.h"
 #include "faust/audio/channels.h"
 
+// -DCLONE_STATE : the response is computed by 'cloneState' or 'dsp_pool' copies
+// of the initialized DSP, which must be compiled with '-cs'
+#ifdef CLONE_STATE
+#include "faust/dsp/dsp-pool.h"
+#endif
+
 using std::max;
 using std::min;
 
@@ -125,8 +131,6 @@ int main(int argc, char* argv[])
     snprintf(rcfilename, 255, "%src", argv[0]);
     
     CheckControlUI controlui;
-    
-    DSP.buildUserInterface(&finterface);
  
     // Get control and then 'initRandom'
     DSP.buildUserInterface(&controlui);
@@ -166,6 +170,18 @@ int main(int argc, char* argv[])
     // modify the UI values according to the command - line options
     interface->process_command();
 
+    dsp* instance = &DSP;
+#ifdef CLONE_STATE
+    // the state of the initialized DSP, with the command line values, is copied
+    // in a new instance (-DCLONE_STATE=1) or in a reserved instance of a pool (-DCLONE_STATE=2)
+    dsp_pool pool(DSP.clone(), 44100, 1);
+    if (!pool.getPrototype()->copyState(&DSP)) {
+        cerr << "ERROR in copyState" << std::endl;
+    }
+    instance = (CLONE_STATE == 2) ? pool.acquire() : DSP.cloneState();
+#endif
+    instance->buildUserInterface(&finterface);
+
     int nins = DSP.getNumInputs();
     channels ichan(kFrames, nins);
 
@@ -197,7 +213,7 @@ int main(int argc, char* argv[])
                 finterface.setButtons(false);
             }
             int nFrames = min(kFrames, nbsamples);
-            DSP.compute(nFrames, ichan.buffers(), ochan.buffers());
+            instance->compute(nFrames, ichan.buffers(), ochan.buffers());
             run++;
             for (int i = 0; i < nFrames; i++) {
                 printf("%6d : ", linenum++);
@@ -73,6 +73,16 @@ for f in *.dsp; do
     filesCompare $D/$f.sch.ir ../expected-responses/$f.scal.ir && echo "OK $f scheduler -vs 100 mode" || echo "ERROR $f scheduler -vs 100 mode"
 done
 
+for f in *.dsp; do
+    CXXFLAGS="-O3 -pthread -std=c++11 -DCLONE_STATE=1" faust2impulse -double -cs $f > $D/$f.clone.ir
+    filesCompare $D/$f.clone.ir ../expected-responses/$f.scal.ir && echo "OK $f cloneState mode" || echo "ERROR $f cloneState mode"
+done
+
+for f in *.dsp; do
+    CXXFLAGS="-O3 -pthread -std=c++11 -DCLONE_STATE=2" faust2impulse -double -cs $f > $D/$f.clone.ir
+    filesCompare $D/$f.clone.ir ../expected-responses/$f.scal.ir && echo "OK $f dsp_pool mode" || echo "ERROR $f dsp_pool mode"
+done
+
 
 echo "========================================="
 echo "Test compilation in default mode (float)"
@@ -88,3 +98,32 @@ for f in *.dsp; do
 	filesCompare $D/$f.vec.ir ../expected-responses/$f.scal.ir 0.001 && echo "OK $f vector -lv 0 mode" || echo "ERROR $f vector -lv 0 mode"
 done
 
+
+echo "========================================="
+echo "Architecture checks"
+echo "========================================="
+
+ARCH=../../../architecture
+CHECKS=../checks
+
+g++ -O3 -std=c++11 -I$ARCH $CHECKS/sampleformat.cpp -o $D/sampleformat && $D/sampleformat && echo "OK sample formats" || echo "ERROR sample formats"
+g++ -O3 -std=c++11 -DSAMPLE_FORMAT_SCALAR -I$ARCH $CHECKS/sampleformat.cpp -o $D/sampleformat && $D/sampleformat && echo "OK sample formats scalar" || echo "ERROR sample formats scalar"
+
+make -C $ARCH/osclib > /dev/null && mkdir -p $D/include/faust/gui && cp $ARCH/osclib/faust/faust/OSCControler.h $D/include/faust/gui/
+g++ -O3 -std=c++11 -I$D/include -I$ARCH -I$ARCH/osclib/faust $CHECKS/oscbundle.cpp $ARCH/osclib/libOSCFaust.a -lpthread -o $D/oscbundle && $D/oscbundle > /dev/null && echo "OK OSC transmission" || echo "ERROR OSC transmission"
+
+g++ -O3 -std=c++11 -I$ARCH $CHECKS/descriptor.cpp -o $D/descriptor && $D/descriptor && echo "OK binary descriptor" || echo "ERROR binary descriptor"
+for f in *.dsp; do
+    faust -json -fdesc -O $D $f -o /dev/null
+    $D/descriptor $D/${f%.dsp}.dsp.json $D/${f%.dsp}.dsp.fdesc && echo "OK $f binary descriptor" || echo "ERROR $f binary descriptor"
+done
+
+g++ -O3 -std=c++11 -I$ARCH $CHECKS/presets.cpp -lpthread -o $D/presets && $D/presets && echo "OK presets" || echo "ERROR presets"
+
+g++ -O3 -std=c++11 -I$ARCH $CHECKS/swap.cpp -lpthread -o $D/swap && $D/swap && echo "OK DSP hot swap" || echo "ERROR DSP hot swap"
+
+g++ -O3 -std=c++11 -I$ARCH $CHECKS/resampler.cpp -o $D/resampler && $D/resampler && echo "OK resampler" || echo "ERROR resampler"
+g++ -O3 -std=c++11 -DRESAMPLER_SCALAR -I$ARCH $CHECKS/resampler.cpp -o $D/resampler && $D/resampler && echo "OK resampler scalar" || echo "ERROR resampler scalar"
+
+make -C ../../../compiler -f Makefile.unix libfaust > /dev/null
+g++ -O3 -std=c++11 -I$ARCH $CHECKS/libfaust.cpp ../../../compiler/libfaust.a -lpthread -o $D/libfaust && $D/libfaust *.dsp && echo "OK libfaust" || echo "ERROR libfaust"